@@ -0,0 +1,477 @@
+/* DO NOT EDIT THIS FILE - it is generated from src/main/schema/bridge.schema */
+
+/**
+* Writers for the fixed size records the bridge sends to Java. Expects the namespaces of the
+* written types to be in scope and TO_DEGREES and fixedScale to be defined by the includer.
+*/
+
+#ifndef _Included_client_bridge_records
+#define _Included_client_bridge_records
+
+#ifndef _Included_refID
+#define _Included_refID
+/**
+* Returns the ID of the object, or -1 if there is none.
+*/
+template<class T> inline int refID(T* p)
+{
+	return (p != NULL) ? p->getID() : -1;
+}
+#endif
+
+const int unitRecordSize = 73;
+
+/**
+* Writes a unit record of 73 values to buf at index and returns the index after it.
+*/
+inline int writeUnit(jint* buf, int index, Unit* unit)
+{
+	buf[index++] = unit->getID(); // id
+	buf[index++] = unit->getReplayID(); // replayId
+	buf[index++] = unit->getPlayer()->getID(); // playerId
+	buf[index++] = unit->getType().getID(); // typeId
+	buf[index++] = unit->getPosition().x(); // x
+	buf[index++] = unit->getPosition().y(); // y
+	buf[index++] = unit->getTilePosition().x(); // tileX
+	buf[index++] = unit->getTilePosition().y(); // tileY
+	buf[index++] = static_cast<int>(TO_DEGREES * unit->getAngle()); // angle
+	buf[index++] = static_cast<int>(fixedScale * unit->getVelocityX()); // velocityX
+	buf[index++] = static_cast<int>(fixedScale * unit->getVelocityY()); // velocityY
+	buf[index++] = unit->getHitPoints(); // hitPoints
+	buf[index++] = unit->getShields(); // shield
+	buf[index++] = unit->getEnergy(); // energy
+	buf[index++] = unit->getResources(); // resources
+	buf[index++] = unit->getResourceGroup(); // resourceGroup
+	buf[index++] = unit->getLastCommandFrame(); // lastCommandFrame
+	buf[index++] = unit->getLastCommand().getType().getID(); // lastCommandId
+	buf[index++] = (unit->getLastAttackingPlayer() != NULL && unit->getLastAttackingPlayer()->getType() != PlayerTypes::None) ? unit->getLastAttackingPlayer()->getID() : -1; // lastAttackingPlayerId
+	buf[index++] = unit->getInitialType().getID(); // initialTypeId
+	buf[index++] = unit->getInitialPosition().x(); // initialX
+	buf[index++] = unit->getInitialPosition().y(); // initialY
+	buf[index++] = unit->getInitialTilePosition().x(); // initialTileX
+	buf[index++] = unit->getInitialTilePosition().y(); // initialTileY
+	buf[index++] = unit->getInitialHitPoints(); // initialHitPoints
+	buf[index++] = unit->getInitialResources(); // initialResources
+	buf[index++] = unit->getKillCount(); // killCount
+	buf[index++] = unit->getAcidSporeCount(); // acidSporeCount
+	buf[index++] = unit->getInterceptorCount(); // interceptorCount
+	buf[index++] = unit->getScarabCount(); // scarabCount
+	buf[index++] = unit->getSpiderMineCount(); // spiderMineCount
+	buf[index++] = unit->getGroundWeaponCooldown(); // groundWeaponCooldown
+	buf[index++] = unit->getAirWeaponCooldown(); // airWeaponCooldown
+	buf[index++] = unit->getSpellCooldown(); // spellCooldown
+	buf[index++] = unit->getDefenseMatrixPoints(); // defenseMatrixPoints
+	buf[index++] = unit->getDefenseMatrixTimer(); // defenseMatrixTimer
+	buf[index++] = unit->getEnsnareTimer(); // ensnareTimer
+	buf[index++] = unit->getIrradiateTimer(); // irradiateTimer
+	buf[index++] = unit->getLockdownTimer(); // lockdownTimer
+	buf[index++] = unit->getMaelstromTimer(); // maelstromTimer
+	buf[index++] = unit->getOrderTimer(); // orderTimer
+	buf[index++] = unit->getPlagueTimer(); // plagueTimer
+	buf[index++] = unit->getRemoveTimer(); // removeTimer
+	buf[index++] = unit->getStasisTimer(); // stasisTimer
+	buf[index++] = unit->getStimTimer(); // stimTimer
+	buf[index++] = unit->getBuildType().getID(); // buildTypeId
+	buf[index++] = trainingQueueSize(unit); // trainingQueueSize
+	buf[index++] = unit->getTech().getID(); // researchingTechId
+	buf[index++] = unit->getUpgrade().getID(); // upgradingUpgradeId
+	buf[index++] = unit->getRemainingBuildTime(); // remainingBuildTimer
+	buf[index++] = unit->getRemainingTrainTime(); // remainingTrainTime
+	buf[index++] = unit->getRemainingResearchTime(); // remainingResearchTime
+	buf[index++] = unit->getRemainingUpgradeTime(); // remainingUpgradeTime
+	buf[index++] = refID(unit->getBuildUnit()); // buildUnitId
+	buf[index++] = refID(unit->getTarget()); // targetUnitId
+	buf[index++] = unit->getTargetPosition().x(); // targetX
+	buf[index++] = unit->getTargetPosition().y(); // targetY
+	buf[index++] = unit->getOrder().getID(); // orderId
+	buf[index++] = refID(unit->getOrderTarget()); // orderTargetId
+	buf[index++] = unit->getSecondaryOrder().getID(); // secondaryOrderId
+	buf[index++] = unit->getRallyPosition().x(); // rallyX
+	buf[index++] = unit->getRallyPosition().y(); // rallyY
+	buf[index++] = refID(unit->getRallyUnit()); // rallyUnitId
+	buf[index++] = refID(unit->getAddon()); // addOnId
+	buf[index++] = refID(unit->getNydusExit()); // nydusExitUnitId
+	buf[index++] = refID(unit->getTransport()); // transportId
+	buf[index++] = loadedUnitsOf(unit).size(); // loadedUnitsCount
+	buf[index++] = refID(unit->getCarrier()); // carrierUnitId
+	buf[index++] = refID(unit->getHatchery()); // hatcheryUnitId
+	buf[index++] = larvaOf(unit).size(); // larvaCount
+	buf[index++] = refID(unit->getPowerUp()); // powerUpUnitId
+	int bits = 0;
+	bits |= (unit->exists() ? 1 : 0); // exists
+	bits |= (unit->hasNuke() ? 1 : 0) << 1; // nukeReady
+	bits |= (unit->isAccelerating() ? 1 : 0) << 2; // accelerating
+	bits |= (unit->isAttacking() ? 1 : 0) << 3; // attacking
+	bits |= (unit->isAttackFrame() ? 1 : 0) << 4; // attackFrame
+	bits |= (unit->isBeingConstructed() ? 1 : 0) << 5; // beingConstructed
+	bits |= (unit->isBeingGathered() ? 1 : 0) << 6; // beingGathered
+	bits |= (unit->isBeingHealed() ? 1 : 0) << 7; // beingHealed
+	bits |= (unit->isBlind() ? 1 : 0) << 8; // blind
+	bits |= (unit->isBraking() ? 1 : 0) << 9; // braking
+	bits |= (unit->isBurrowed() ? 1 : 0) << 10; // burrowed
+	bits |= (unit->isCarryingGas() ? 1 : 0) << 11; // carryingGas
+	bits |= (unit->isCarryingMinerals() ? 1 : 0) << 12; // carryingMinerals
+	bits |= (unit->isCloaked() ? 1 : 0) << 13; // cloaked
+	bits |= (unit->isCompleted() ? 1 : 0) << 14; // completed
+	bits |= (unit->isConstructing() ? 1 : 0) << 15; // constructing
+	bits |= (unit->isDefenseMatrixed() ? 1 : 0) << 16; // defenseMatrixed
+	bits |= (unit->isDetected() ? 1 : 0) << 17; // detected
+	bits |= (unit->isEnsnared() ? 1 : 0) << 18; // ensnared
+	bits |= (unit->isFollowing() ? 1 : 0) << 19; // following
+	bits |= (unit->isGatheringGas() ? 1 : 0) << 20; // gatheringGas
+	bits |= (unit->isGatheringMinerals() ? 1 : 0) << 21; // gatheringMinerals
+	bits |= (unit->isHallucination() ? 1 : 0) << 22; // hallucination
+	bits |= (unit->isHoldingPosition() ? 1 : 0) << 23; // holdingPosition
+	bits |= (unit->isIdle() ? 1 : 0) << 24; // idle
+	bits |= (unit->isInterruptible() ? 1 : 0) << 25; // interruptable
+	bits |= (unit->isInvincible() ? 1 : 0) << 26; // invincible
+	bits |= (unit->isIrradiated() ? 1 : 0) << 27; // irradiated
+	bits |= (unit->isLifted() ? 1 : 0) << 28; // lifted
+	bits |= (unit->isLoaded() ? 1 : 0) << 29; // loaded
+	bits |= (unit->isLockedDown() ? 1 : 0) << 30; // lockedDown
+	buf[index++] = bits;
+	bits = 0;
+	bits |= (unit->isMaelstrommed() ? 1 : 0); // maelstrommed
+	bits |= (unit->isMorphing() ? 1 : 0) << 1; // morphing
+	bits |= (unit->isMoving() ? 1 : 0) << 2; // moving
+	bits |= (unit->isParasited() ? 1 : 0) << 3; // parasited
+	bits |= (unit->isPatrolling() ? 1 : 0) << 4; // patrolling
+	bits |= (unit->isPlagued() ? 1 : 0) << 5; // plagued
+	bits |= (unit->isRepairing() ? 1 : 0) << 6; // repairing
+	bits |= (unit->isSelected() ? 1 : 0) << 7; // selected
+	bits |= (unit->isSieged() ? 1 : 0) << 8; // sieged
+	bits |= (unit->isStartingAttack() ? 1 : 0) << 9; // startingAttack
+	bits |= (unit->isStasised() ? 1 : 0) << 10; // stasised
+	bits |= (unit->isStimmed() ? 1 : 0) << 11; // stimmed
+	bits |= (unit->isStuck() ? 1 : 0) << 12; // stuck
+	bits |= (unit->isTraining() ? 1 : 0) << 13; // training
+	bits |= (unit->isUnderAttack() ? 1 : 0) << 14; // underAttack
+	bits |= (unit->isUnderDarkSwarm() ? 1 : 0) << 15; // underDarkSwarm
+	bits |= (unit->isUnderDisruptionWeb() ? 1 : 0) << 16; // underDisruptionWeb
+	bits |= (unit->isUnderStorm() ? 1 : 0) << 17; // underStorm
+	bits |= (unit->isUnpowered() ? 1 : 0) << 18; // unpowered
+	bits |= (unit->isUpgrading() ? 1 : 0) << 19; // upgrading
+	bits |= (unit->isVisible() ? 1 : 0) << 20; // visible
+	buf[index++] = bits;
+	return index;
+}
+
+/**
+* Writes the same unit record as writeUnit, reading the fields it can straight
+* from the raw data instead of through the accessors.
+*/
+inline int writeUnitRaw(jint* buf, int index, Unit* unit, const UnitData& data)
+{
+	buf[index++] = unit->getID(); // id
+	buf[index++] = data.replayID; // replayId
+	buf[index++] = data.player; // playerId
+	buf[index++] = data.type; // typeId
+	buf[index++] = data.positionX; // x
+	buf[index++] = data.positionY; // y
+	buf[index++] = unit->getTilePosition().x(); // tileX
+	buf[index++] = unit->getTilePosition().y(); // tileY
+	buf[index++] = static_cast<int>(TO_DEGREES * data.angle); // angle
+	buf[index++] = static_cast<int>(fixedScale * data.velocityX); // velocityX
+	buf[index++] = static_cast<int>(fixedScale * data.velocityY); // velocityY
+	buf[index++] = data.hitPoints; // hitPoints
+	buf[index++] = data.shields; // shield
+	buf[index++] = data.energy; // energy
+	buf[index++] = data.resources; // resources
+	buf[index++] = data.resourceGroup; // resourceGroup
+	buf[index++] = unit->getLastCommandFrame(); // lastCommandFrame
+	buf[index++] = unit->getLastCommand().getType().getID(); // lastCommandId
+	buf[index++] = (unit->getLastAttackingPlayer() != NULL && unit->getLastAttackingPlayer()->getType() != PlayerTypes::None) ? unit->getLastAttackingPlayer()->getID() : -1; // lastAttackingPlayerId
+	buf[index++] = unit->getInitialType().getID(); // initialTypeId
+	buf[index++] = unit->getInitialPosition().x(); // initialX
+	buf[index++] = unit->getInitialPosition().y(); // initialY
+	buf[index++] = unit->getInitialTilePosition().x(); // initialTileX
+	buf[index++] = unit->getInitialTilePosition().y(); // initialTileY
+	buf[index++] = unit->getInitialHitPoints(); // initialHitPoints
+	buf[index++] = unit->getInitialResources(); // initialResources
+	buf[index++] = data.killCount; // killCount
+	buf[index++] = data.acidSporeCount; // acidSporeCount
+	buf[index++] = unit->getInterceptorCount(); // interceptorCount
+	buf[index++] = data.scarabCount; // scarabCount
+	buf[index++] = data.spiderMineCount; // spiderMineCount
+	buf[index++] = data.groundWeaponCooldown; // groundWeaponCooldown
+	buf[index++] = data.airWeaponCooldown; // airWeaponCooldown
+	buf[index++] = data.spellCooldown; // spellCooldown
+	buf[index++] = data.defenseMatrixPoints; // defenseMatrixPoints
+	buf[index++] = data.defenseMatrixTimer; // defenseMatrixTimer
+	buf[index++] = data.ensnareTimer; // ensnareTimer
+	buf[index++] = data.irradiateTimer; // irradiateTimer
+	buf[index++] = data.lockdownTimer; // lockdownTimer
+	buf[index++] = data.maelstromTimer; // maelstromTimer
+	buf[index++] = data.orderTimer; // orderTimer
+	buf[index++] = data.plagueTimer; // plagueTimer
+	buf[index++] = data.removeTimer; // removeTimer
+	buf[index++] = data.stasisTimer; // stasisTimer
+	buf[index++] = data.stimTimer; // stimTimer
+	buf[index++] = data.buildType; // buildTypeId
+	buf[index++] = data.trainingQueueCount; // trainingQueueSize
+	buf[index++] = data.tech; // researchingTechId
+	buf[index++] = data.upgrade; // upgradingUpgradeId
+	buf[index++] = data.remainingBuildTime; // remainingBuildTimer
+	buf[index++] = data.remainingTrainTime; // remainingTrainTime
+	buf[index++] = data.remainingResearchTime; // remainingResearchTime
+	buf[index++] = data.remainingUpgradeTime; // remainingUpgradeTime
+	buf[index++] = data.buildUnit; // buildUnitId
+	buf[index++] = data.target; // targetUnitId
+	buf[index++] = data.targetPositionX; // targetX
+	buf[index++] = data.targetPositionY; // targetY
+	buf[index++] = data.order; // orderId
+	buf[index++] = data.orderTarget; // orderTargetId
+	buf[index++] = data.secondaryOrder; // secondaryOrderId
+	buf[index++] = data.rallyPositionX; // rallyX
+	buf[index++] = data.rallyPositionY; // rallyY
+	buf[index++] = data.rallyUnit; // rallyUnitId
+	buf[index++] = data.addon; // addOnId
+	buf[index++] = data.nydusExit; // nydusExitUnitId
+	buf[index++] = data.transport; // transportId
+	buf[index++] = loadedUnitsOf(unit).size(); // loadedUnitsCount
+	buf[index++] = data.carrier; // carrierUnitId
+	buf[index++] = data.hatchery; // hatcheryUnitId
+	buf[index++] = larvaOf(unit).size(); // larvaCount
+	buf[index++] = data.powerUp; // powerUpUnitId
+	int bits = 0;
+	bits |= (data.exists ? 1 : 0); // exists
+	bits |= (data.hasNuke ? 1 : 0) << 1; // nukeReady
+	bits |= (data.isAccelerating ? 1 : 0) << 2; // accelerating
+	bits |= (data.isAttacking ? 1 : 0) << 3; // attacking
+	bits |= (data.isAttackFrame ? 1 : 0) << 4; // attackFrame
+	bits |= (unit->isBeingConstructed() ? 1 : 0) << 5; // beingConstructed
+	bits |= (data.isBeingGathered ? 1 : 0) << 6; // beingGathered
+	bits |= (unit->isBeingHealed() ? 1 : 0) << 7; // beingHealed
+	bits |= (data.isBlind ? 1 : 0) << 8; // blind
+	bits |= (data.isBraking ? 1 : 0) << 9; // braking
+	bits |= (data.isBurrowed ? 1 : 0) << 10; // burrowed
+	bits |= (data.carryResourceType == 1 ? 1 : 0) << 11; // carryingGas
+	bits |= (data.carryResourceType == 2 ? 1 : 0) << 12; // carryingMinerals
+	bits |= (data.isCloaked ? 1 : 0) << 13; // cloaked
+	bits |= (data.isCompleted ? 1 : 0) << 14; // completed
+	bits |= (data.isConstructing ? 1 : 0) << 15; // constructing
+	bits |= (data.defenseMatrixTimer > 0 ? 1 : 0) << 16; // defenseMatrixed
+	bits |= (data.isDetected ? 1 : 0) << 17; // detected
+	bits |= (data.ensnareTimer > 0 ? 1 : 0) << 18; // ensnared
+	bits |= (unit->isFollowing() ? 1 : 0) << 19; // following
+	bits |= (unit->isGatheringGas() ? 1 : 0) << 20; // gatheringGas
+	bits |= (unit->isGatheringMinerals() ? 1 : 0) << 21; // gatheringMinerals
+	bits |= (data.isHallucination ? 1 : 0) << 22; // hallucination
+	bits |= (unit->isHoldingPosition() ? 1 : 0) << 23; // holdingPosition
+	bits |= (data.isIdle ? 1 : 0) << 24; // idle
+	bits |= (data.isInterruptible ? 1 : 0) << 25; // interruptable
+	bits |= (data.isInvincible ? 1 : 0) << 26; // invincible
+	bits |= (data.irradiateTimer > 0 ? 1 : 0) << 27; // irradiated
+	bits |= (data.isLifted ? 1 : 0) << 28; // lifted
+	bits |= (unit->isLoaded() ? 1 : 0) << 29; // loaded
+	bits |= (data.lockdownTimer > 0 ? 1 : 0) << 30; // lockedDown
+	buf[index++] = bits;
+	bits = 0;
+	bits |= (data.maelstromTimer > 0 ? 1 : 0); // maelstrommed
+	bits |= (data.isMorphing ? 1 : 0) << 1; // morphing
+	bits |= (data.isMoving ? 1 : 0) << 2; // moving
+	bits |= (data.isParasited ? 1 : 0) << 3; // parasited
+	bits |= (unit->isPatrolling() ? 1 : 0) << 4; // patrolling
+	bits |= (data.plagueTimer > 0 ? 1 : 0) << 5; // plagued
+	bits |= (unit->isRepairing() ? 1 : 0) << 6; // repairing
+	bits |= (data.isSelected ? 1 : 0) << 7; // selected
+	bits |= (unit->isSieged() ? 1 : 0) << 8; // sieged
+	bits |= (data.isStartingAttack ? 1 : 0) << 9; // startingAttack
+	bits |= (data.stasisTimer > 0 ? 1 : 0) << 10; // stasised
+	bits |= (data.stimTimer > 0 ? 1 : 0) << 11; // stimmed
+	bits |= (data.isStuck ? 1 : 0) << 12; // stuck
+	bits |= (data.isTraining ? 1 : 0) << 13; // training
+	bits |= (data.recentlyAttacked ? 1 : 0) << 14; // underAttack
+	bits |= (data.isUnderDarkSwarm ? 1 : 0) << 15; // underDarkSwarm
+	bits |= (data.isUnderDWeb ? 1 : 0) << 16; // underDisruptionWeb
+	bits |= (data.isUnderStorm ? 1 : 0) << 17; // underStorm
+	bits |= (data.isUnpowered ? 1 : 0) << 18; // unpowered
+	bits |= (unit->isUpgrading() ? 1 : 0) << 19; // upgrading
+	bits |= (unit->isVisible() ? 1 : 0) << 20; // visible
+	buf[index++] = bits;
+	return index;
+}
+
+const int bulletRecordSize = 14;
+
+/**
+* Writes a bullet record of 14 values to buf at index and returns the index after it.
+*/
+inline int writeBullet(jint* buf, int index, Bullet* bullet)
+{
+	buf[index++] = bullet->getID(); // id
+	buf[index++] = refID(bullet->getPlayer()); // playerId
+	buf[index++] = bullet->getType().getID(); // typeId
+	buf[index++] = refID(bullet->getSource()); // sourceId
+	buf[index++] = bullet->getPosition().x(); // x
+	buf[index++] = bullet->getPosition().y(); // y
+	buf[index++] = static_cast<int>(TO_DEGREES * bullet->getAngle()); // angle
+	buf[index++] = static_cast<int>(fixedScale * bullet->getVelocityX()); // velocityX
+	buf[index++] = static_cast<int>(fixedScale * bullet->getVelocityY()); // velocityY
+	buf[index++] = refID(bullet->getTarget()); // targetId
+	buf[index++] = bullet->getTargetPosition().x(); // targetX
+	buf[index++] = bullet->getTargetPosition().y(); // targetY
+	buf[index++] = bullet->getRemoveTimer(); // removeTimer
+	buf[index++] = (bullet->isVisible()) ? 1 : 0; // visible
+	return index;
+}
+
+const int playerRecordSize = 11;
+
+/**
+* Writes a player record of 11 values to buf at index and returns the index after it.
+*/
+inline int writePlayer(jint* buf, int index, Player* player)
+{
+	buf[index++] = player->getID(); // id
+	buf[index++] = player->getRace().getID(); // raceId
+	buf[index++] = player->getType().getID(); // typeId
+	buf[index++] = player->getStartLocation().x(); // startLocationX
+	buf[index++] = player->getStartLocation().y(); // startLocationY
+	buf[index++] = (!Broodwar->isReplay() && player->getID() == Broodwar->self()->getID()) ? 1 : 0; // self
+	buf[index++] = (!Broodwar->isReplay() && player->isAlly(Broodwar->self())) ? 1 : 0; // ally
+	buf[index++] = (!Broodwar->isReplay() && player->isEnemy(Broodwar->self())) ? 1 : 0; // enemy
+	buf[index++] = (player->isNeutral()) ? 1 : 0; // neutral
+	buf[index++] = (player->isObserver()) ? 1 : 0; // observer
+	buf[index++] = player->getColor().getID(); // color
+	return index;
+}
+
+const int unitTypeRecordSize = 57;
+
+/**
+* Writes a unitType record of 57 values to buf at index and returns the index after it.
+*/
+inline int writeUnitType(jint* buf, int index, const UnitType& type)
+{
+	buf[index++] = type.getID(); // id
+	buf[index++] = type.getRace().getID(); // raceId
+	buf[index++] = type.whatBuilds().first.getID(); // whatBuildId
+	buf[index++] = type.requiredTech().getID(); // requiredTechId
+	buf[index++] = type.armorUpgrade().getID(); // armorUpgradeId
+	buf[index++] = type.maxHitPoints(); // maxHitPoints
+	buf[index++] = type.maxShields(); // maxShields
+	buf[index++] = type.maxEnergy(); // maxEnergy
+	buf[index++] = type.armor(); // armor
+	buf[index++] = type.mineralPrice(); // mineralPrice
+	buf[index++] = type.gasPrice(); // gasPrice
+	buf[index++] = type.buildTime(); // buildTime
+	buf[index++] = type.supplyRequired(); // supplyRequired
+	buf[index++] = type.supplyProvided(); // supplyProvided
+	buf[index++] = type.spaceRequired(); // spaceRequired
+	buf[index++] = type.spaceProvided(); // spaceProvided
+	buf[index++] = type.buildScore(); // buildScore
+	buf[index++] = type.destroyScore(); // destroyScore
+	buf[index++] = type.size().getID(); // sizeID
+	buf[index++] = type.tileWidth(); // tileWidth
+	buf[index++] = type.tileHeight(); // tileHeight
+	buf[index++] = type.dimensionLeft(); // dimensionLeft
+	buf[index++] = type.dimensionUp(); // dimensionUp
+	buf[index++] = type.dimensionRight(); // dimensionRight
+	buf[index++] = type.dimensionDown(); // dimensionDown
+	buf[index++] = type.seekRange(); // seekRange
+	buf[index++] = type.sightRange(); // sightRange
+	buf[index++] = type.groundWeapon().getID(); // groundWeaponID
+	buf[index++] = type.maxGroundHits(); // maxGroundHits
+	buf[index++] = type.airWeapon().getID(); // airWeaponID
+	buf[index++] = type.maxAirHits(); // maxAirHits
+	buf[index++] = static_cast<int>(fixedScale * type.topSpeed()); // topSpeed
+	buf[index++] = type.acceleration(); // acceleration
+	buf[index++] = type.haltDistance(); // haltDistance
+	buf[index++] = type.turnRadius(); // turnRadius
+	buf[index++] = (type.canProduce()) ? 1 : 0; // produceCapable
+	buf[index++] = (type.canAttack()) ? 1 : 0; // attackCapable
+	buf[index++] = (type.canMove()) ? 1 : 0; // canMove
+	buf[index++] = (type.isFlyer()) ? 1 : 0; // flyer
+	buf[index++] = (type.regeneratesHP()) ? 1 : 0; // regenerates
+	buf[index++] = (type.isSpellcaster()) ? 1 : 0; // spellcaster
+	buf[index++] = (type.isInvincible()) ? 1 : 0; // invincible
+	buf[index++] = (type.isOrganic()) ? 1 : 0; // organic
+	buf[index++] = (type.isMechanical()) ? 1 : 0; // mechanical
+	buf[index++] = (type.isRobotic()) ? 1 : 0; // robotic
+	buf[index++] = (type.isDetector()) ? 1 : 0; // detector
+	buf[index++] = (type.isResourceContainer()) ? 1 : 0; // resourceContainer
+	buf[index++] = (type.isRefinery()) ? 1 : 0; // refinery
+	buf[index++] = (type.isWorker()) ? 1 : 0; // worker
+	buf[index++] = (type.requiresPsi()) ? 1 : 0; // requiresPsi
+	buf[index++] = (type.requiresCreep()) ? 1 : 0; // requiresCreep
+	buf[index++] = (type.isBurrowable()) ? 1 : 0; // burrowable
+	buf[index++] = (type.isCloakable()) ? 1 : 0; // cloakable
+	buf[index++] = (type.isBuilding()) ? 1 : 0; // building
+	buf[index++] = (type.isAddon()) ? 1 : 0; // addon
+	buf[index++] = (type.isFlyingBuilding()) ? 1 : 0; // flyingBuilding
+	buf[index++] = (type.isSpell()) ? 1 : 0; // spell
+	return index;
+}
+
+const int terrainBaseRecordSize = 9;
+
+/**
+* Writes a terrainBase record of 9 values to buf at index and returns the index after it.
+*/
+inline int writeTerrainBase(jint* buf, int index, const TerrainBase& base)
+{
+	buf[index++] = base.x; // x
+	buf[index++] = base.y; // y
+	buf[index++] = base.tx; // tx
+	buf[index++] = base.ty; // ty
+	buf[index++] = base.minerals; // minerals
+	buf[index++] = base.gas; // gas
+	buf[index++] = (base.island) ? 1 : 0; // island
+	buf[index++] = (base.gas == 0) ? 1 : 0; // mineralOnly
+	buf[index++] = (base.startLocation) ? 1 : 0; // startLocation
+	return index;
+}
+
+const int terrainRegionRecordSize = 4;
+
+/**
+* Writes a terrainRegion record of 4 values to buf at index and returns the index after it.
+*/
+inline int writeTerrainRegion(jint* buf, int index, const TerrainRegion& region)
+{
+	buf[index++] = region.x; // x
+	buf[index++] = region.y; // y
+	buf[index++] = region.clearance; // clearance
+	buf[index++] = region.area; // area
+	return index;
+}
+
+const int terrainChokepointRecordSize = 5;
+
+/**
+* Writes a terrainChokepoint record of 5 values to buf at index and returns the index after it.
+*/
+inline int writeTerrainChokepoint(jint* buf, int index, const TerrainChokepoint& chokepoint)
+{
+	buf[index++] = chokepoint.regionA; // regionA
+	buf[index++] = chokepoint.regionB; // regionB
+	buf[index++] = chokepoint.x; // x
+	buf[index++] = chokepoint.y; // y
+	buf[index++] = chokepoint.width; // width
+	return index;
+}
+
+const int regionNodeRecordSize = 12;
+
+/**
+* Writes a regionNode record of 12 values to buf at index and returns the index after it.
+*/
+inline int writeRegionNode(jint* buf, int index, const RegionData& region)
+{
+	buf[index++] = region.id; // id
+	buf[index++] = region.islandID; // islandId
+	buf[index++] = region.center_x; // centerX
+	buf[index++] = region.center_y; // centerY
+	buf[index++] = region.priority; // priority
+	buf[index++] = region.leftMost; // left
+	buf[index++] = region.topMost; // top
+	buf[index++] = region.rightMost; // right
+	buf[index++] = region.bottomMost; // bottom
+	buf[index++] = (region.isWalkable) ? 1 : 0; // walkable
+	buf[index++] = (region.isHigherGround) ? 1 : 0; // higherGround
+	buf[index++] = region.neighborCount; // neighborCount
+	return index;
+}
+
+#endif
@@ -1,23 +1,55 @@
 #include <jni.h>
-#include <BWTA.h>
 #include <BWAPI.h>
 #include <BWAPI/Client.h>
 
 #define _USE_MATH_DEFINES
+#include <algorithm>
 #include <math.h>
+#include <new>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// SSE2 is available on every processor StarCraft runs on
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
 
 #include "com_harbinger_jbw_Broodwar.h"
 #include "com_harbinger_jbw_Unit.h"
+#include "terrain-analyzer.h"
 
 #define JNI_NULL 0
 
 using namespace BWAPI;
 
-// java callback vars
-JNIEnv *jEnv;
+// java callback vars, only used on the thread running the match
 jobject classref;
-void javaPrint(const char* msg);
-jmethodID printCallback;
+
+// leveled bridge log, categories and levels must match com.harbinger.jbw.BridgeLog
+enum LogCategory {
+	LogConnection,
+	LogMatch,
+	LogCommands,
+	LogMap,
+	LogCategoryCount
+};
+enum LogLevel {
+	LogDebug,
+	LogInfo,
+	LogWarning,
+	LogError,
+	LogOff
+};
+volatile LONG logLevels[LogCategoryCount] = { LogInfo, LogInfo, LogInfo, LogInfo };
+volatile LONG logFrame = -1;
+void logMessage(int category, int level, const char* format, ...);
+
+// only formats the message when its category is enabled at the level
+#define BRIDGE_LOG(category, level, ...) \
+	do { if ((level) >= logLevels[category]) logMessage(category, level, __VA_ARGS__); } while (0)
 
 // mapping of IDs to types
 std::map<int, UnitType> unitTypeMap;
@@ -32,46 +64,274 @@ std::map<int, ExplosionType> explosionTypeMap;
 std::map<int, UnitCommandType> unitCommandTypeMap;
 std::map<int, Order> orderTypeMap;
 
-// region IDs
-std::map<BWTA::Region*, int> regionMap;
+/**
+* Returns the type of an ID, or the None type for unknown IDs. Unlike operator[] this never inserts, so the maps
+* can be read from any thread once they are loaded.
+*/
+template <class T>
+T findType(const std::map<int, T>& types, int id)
+{
+	typename std::map<int, T>::const_iterator i = types.find(id);
+	return i != types.end() ? i->second : T();
+}
+
+// data buffers for c++ -> Java data, one per calling thread so queries can be made from any thread
+DWORD scratchSlot = TlsAlloc();
+jint* scratchBuffer(size_t size);
+void freeScratchBuffer(void);
 
-// data buffer for c++ -> Java data
-jint *intBuf;
-const int bufferSize = 5000000;
+// commands submitted by worker threads, issued by the thread running the match
+void issueSubmittedCommands(void);
+void discardSubmittedCommands(void);
 
 void reconnect(void);
 void loadTypeData(void);
 bool keyState[256];
 
+// events the agent listens to, one bit per BWAPI event type plus one for key presses
+int eventMask = ~0;
+const int keyPressedEventBit = 1 << 30;
+
+// last known state of enemy units that have been seen during the match
+struct EnemyRecord {
+	int playerID;
+	int typeID;
+	int x;
+	int y;
+	int hitPoints;
+	int shields;
+	int lastSeenFrame;
+	bool building;
+	bool visible;
+};
+std::map<int, EnemyRecord> enemyMemory;
+int enemyMemoryTimeout = 24 * 60; // frames a hidden mobile unit is remembered for
+void updateEnemyMemory(void);
+
+// unit state transitions between consecutive frames
+struct UnitState {
+	int frame;
+	int typeID;
+	int durability; // hit points and shields
+	int queueSize;
+	int trainingTypeID; // the type at the front of the training queue
+	int traineeID;      // the unit being trained, if the game has created it
+	bool idle;
+	bool attacking;
+	bool cloaked;
+	bool lifted;
+};
+std::map<int, UnitState> unitStates;
+// a training queue that shrank, finished once the unit it trained is completed
+struct PendingTraining {
+	int frame;
+	int trainerID;
+	int traineeID;
+	int typeID;
+	int playerID;
+	int queueSize;
+};
+std::vector<PendingTraining> pendingTrainings;
+std::vector<Unit*> completedUnits; // units completed this frame, by their UnitComplete events
+int unitTransitionMask = 0;
+void updateUnitTransitions(void);
+
+// minerals, geysers and other neutral units that cannot move present at the start of the match, which
+// getAllUnitsData leaves out while they stay neutral and of their initial type: Java receives their records once
+// and afterwards only the slots that changed, mostly resources and the gather flag
+struct StaticNeutral {
+	Unit* unit;
+	int typeID;
+	bool sent; // Java holds the record, the last one sent is kept in staticNeutralRecords
+};
+std::vector<StaticNeutral> staticNeutrals;
+std::vector<int> staticNeutralIndex; // by unit ID, -1 for other units
+std::vector<jint> staticNeutralRecords; // unitRecordSize ints per static neutral unit
+int staticNeutralPlayerID = -1;
+void buildStaticNeutrals(void);
+bool isStaticNeutral(Unit* unit, const UnitData& data);
+
+// unit queries compiled by the agent, keyed by handle; only added, removed and evaluated on the match thread
+std::map<int, std::vector<int> > unitQueries;
+int nextUnitQuery = 0;
+
+// geofences registered by the agent, keyed by handle, and the fences each unit is in, which are only tested
+// again when the unit moves
+struct Geofence {
+	int kind;
+	int params[4];
+	std::vector<int> filter; // unit query program the units must match
+};
+std::map<int, Geofence> geofences;
+int nextGeofence = 0;
+struct FencedUnit {
+	int frame;
+	int x;
+	int y;
+	int playerID;
+	int typeID;
+	std::vector<int> inside; // sorted fence handles
+	FencedUnit() : frame(-1) {}
+};
+std::map<int, FencedUnit> fencedUnits;
+std::vector<int> fenceCrossings; // (handle, unit ID, entered) triples
+void updateGeofences(void);
+void clearGeofences(void);
+
+// feature planes written into direct buffers of the agent, keyed by handle
+const int featureRememberedEnemies = 1 << 0;
+struct FeaturePlaneSet {
+	int cellSize; // in build tiles
+	bool rememberedEnemies; // also scatter the remembered enemy units that are out of sight
+	std::vector<int> kinds;
+	std::vector<std::vector<int> > filters; // unit query of each channel, empty for map channels
+	jobject buffer;
+	float* data;
+	jlong capacity;
+	// per match: the map channels that do not change and the inverse number of build tiles per cell
+	std::vector<float> staticPlanes;
+	std::vector<float> inverseTiles;
+	bool reportedTooSmall;
+};
+std::map<int, FeaturePlaneSet> featurePlaneSets;
+int nextFeaturePlaneSet = 0;
+
+// frame snapshots published into a memory-mapped ring file for read-only observers in other processes,
+// the layout is described by com.harbinger.jbw.SnapshotReader
+HANDLE snapshotFile = INVALID_HANDLE_VALUE;
+HANDLE snapshotMapping = NULL;
+jint* snapshotRing = NULL;
+int snapshotSlots = 0;
+int snapshotSlotSize = 0; // in ints, including the slot header
+jint snapshotGeneration = 0;
+void publishSnapshot(void);
+void closeSnapshotRing(void);
+
+// upgrade and research aware unit and weapon stats of each player, recomputed when either changes
+enum UnitStat {
+	StatTopSpeed,             // in hundredths of pixels per frame
+	StatSightRange,
+	StatGroundWeaponMaxRange,
+	StatAirWeaponMaxRange,
+	StatArmor,
+	StatMaxEnergy,
+	StatGroundWeaponCooldown,
+	UnitStatCount
+};
+enum WeaponStat {
+	StatWeaponMaxRange,
+	StatWeaponDamage,
+	WeaponStatCount
+};
+struct PlayerStats {
+	int version;
+	std::vector<int> signature;   // upgrade levels and researched techs the stats were computed for
+	std::vector<int> unitStats;   // UnitStatCount values per unit type ID
+	std::vector<int> weaponStats; // WeaponStatCount values per weapon type ID
+};
+std::map<int, PlayerStats> playerStats;
+void updatePlayerStats(void);
+
+// agent cadence, the agent is run at least every agentCadence frames and every frame while it stays
+// within the frame budget (milliseconds, 0 disables the adaptive mode)
+int agentCadence = 1;
+int agentFrameBudget = 0;
+int lastAgentFrame = -1;
+LONGLONG lastAgentDuration = 0; // in performance counter ticks, as GetTickCount only has 10 to 16 ms steps
+LONGLONG counterFrequency = 0;
+bool frameListenersEnabled = false;
+bool isAgentFrame(void);
+
+// events waiting to be delivered to the agent, coalesced over the frames the agent was not run
+struct QueuedEvent {
+	int type;
+	int p1;
+	int p2;
+	const char* text; // in the frame arena, NULL if the event has no text
+};
+std::vector<QueuedEvent> pendingEvents;
+const int keyPressedEvent = -1;
+const int unitTransitionEvent = 256; // plus the transition kind, with the unit ID and value as parameters
+void queueEvents(void);
+
+// heap allocations of the thread running the match, the steady state frame path should not make any
+DWORD matchThreadID = 0;
+LONG heapAllocations = 0;
+LONG lastFrameAllocations = 0;
+
+// bump allocator for temporaries that live until the agent has handled the frames they were made in
+struct FrameArena {
+	std::vector<char> block;
+	std::vector<char*> overflow; // allocations that did not fit, the block grows to hold them next frame
+	size_t used;
+	size_t peak;
+};
+FrameArena frameArena;
+void* frameAllocate(size_t size);
+void resetFrameArena(void);
+
 // conversion ratios
 double TO_DEGREES = 180.0 / M_PI;
 double fixedScale = 100.0;
 
+// units connected to a unit, read in place: Unit::getLoadedUnits, getInterceptors and getLarva return copies
+const std::set<Unit*> noUnits;
+
+inline const std::set<Unit*>& loadedUnitsOf(Unit* unit)
+{
+	return static_cast<UnitImpl*>(unit)->loadedUnits;
+}
+
+inline const std::set<Unit*>& interceptorsOf(Unit* unit)
+{
+	return unit->getType() == UnitTypes::Protoss_Carrier ? static_cast<UnitImpl*>(unit)->connectedUnits : noUnits;
+}
+
+inline const std::set<Unit*>& larvaOf(Unit* unit)
+{
+	return unit->getType().producesLarva() ? static_cast<UnitImpl*>(unit)->connectedUnits : noUnits;
+}
+
+// Unit::getTrainingQueue builds a list
+inline int trainingQueueSize(Unit* unit)
+{
+	return static_cast<UnitImpl*>(unit)->self->trainingQueueCount;
+}
+
+// the raw data of a unit in the shared memory of the client, which most accessors just return a field of
+inline const UnitData& unitData(Unit* unit)
+{
+	return *static_cast<UnitImpl*>(unit)->self;
+}
+
+// fixed size record writers, generated from src/main/schema/bridge.schema
+#include "client-bridge-records.h"
+
 /**
 * Entry point from Java
 */
 JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeConnect(JNIEnv* env, jobject jObj, jobject classRef)
 {
 	// get the java callback functions
-	jEnv = env;
 	classref = classRef;
 	jclass jc = env->GetObjectClass(classRef);
-	printCallback = env->GetMethodID(jc, "javaPrint", "(Ljava/lang/String;)V");
 
-	javaPrint("BWAPI Client launched!");
+	BRIDGE_LOG(LogConnection, LogInfo, "BWAPI Client launched!");
 	jmethodID connectedCallback = env->GetMethodID(jc, "connected", "()V");
 	jmethodID gameStartCallback = env->GetMethodID(jc, "gameStarted", "()V");
 	jmethodID gameUpdateCallback = env->GetMethodID(jc, "gameUpdate", "()V");
 	jmethodID gameEndCallback = env->GetMethodID(jc, "gameEnded", "()V");
 	jmethodID eventCallback = env->GetMethodID(jc, "eventOccurred", "(IIILjava/lang/String;)V");
 	jmethodID keyPressCallback = env->GetMethodID(jc, "keyPressed", "(I)V");
+	jmethodID frameTickCallback = env->GetMethodID(jc, "frameTick", "(I)V");
+	jmethodID unitTransitionCallback = env->GetMethodID(jc, "unitTransition", "(III)V");
 
-	// allocate room for return data structure
-	intBuf = new jint[bufferSize];
+	// only the allocations of this thread are counted
+	matchThreadID = GetCurrentThreadId();
 
 	// connet to BWAPI
 	BWAPI::BWAPI_init();
-	javaPrint("Connecting...");
+	BRIDGE_LOG(LogConnection, LogInfo, "Connecting...");
 	reconnect();
 	loadTypeData();
 	env->CallObjectMethod(classref, connectedCallback);
@@ -80,7 +340,7 @@ JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeConnect(JNIEnv* env
 	while (true) {
 		// wait for a game to start
 		if (Broodwar != NULL) {
-			javaPrint("Waiting to enter match...");
+			BRIDGE_LOG(LogConnection, LogInfo, "Waiting to enter match...");
 			while (!Broodwar->isInGame()) {
 				BWAPI::BWAPIClient.update();
 				if (Broodwar == NULL) {
@@ -88,119 +348,228 @@ JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeConnect(JNIEnv* env
 				}
 			}
 		}
-		javaPrint("Starting match!");
+		BRIDGE_LOG(LogMatch, LogInfo, "Starting match!");
+		enemyMemory.clear();
+		unitStates.clear();
+		pendingTrainings.clear();
+		playerStats.clear();
+		clearGeofences();
+		discardSubmittedCommands();
+		for (std::map<int, FeaturePlaneSet>::iterator i = featurePlaneSets.begin(); i != featurePlaneSets.end(); ++i) {
+			i->second.staticPlanes.clear();
+			i->second.reportedTooSmall = false;
+		}
+		buildStaticNeutrals();
 		env->CallObjectMethod(classref, gameStartCallback);
 
 		// in game
+		lastAgentFrame = -1;
+		pendingEvents.clear();
+		resetFrameArena();
 		while (Broodwar->isInGame()) {
-			// update client data before event callbacks
-			env->CallObjectMethod(classref, gameUpdateCallback);
-
-			// process events
-			// BWAPI will always issue a MatchStart event as the very first event of a match
-			// BWAPI will always issue a MatchFrame event as the very last event of a frame (second-last at MatchEnd)
-			// BWAPI will always issue a MatchEnd event as the very last event of a match
-			for (std::list<Event>::iterator e = Broodwar->getEvents().begin(); e != Broodwar->getEvents().end(); ++e) {
-				switch (e->getType()) {
-				case EventType::MatchStart:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), 0, 0, JNI_NULL);
-					break;
-				case EventType::MatchEnd:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->isWinner() ? 1 : 0, 0, JNI_NULL);
-					break;
-				case EventType::MatchFrame:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), 0, 0, JNI_NULL);
-					break;
-				case EventType::MenuFrame:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), 0, 0, JNI_NULL);
-					break;
-				case EventType::SendText: {
-					jstring string = env->NewStringUTF(e->getText().c_str());
-					env->CallObjectMethod(classref, eventCallback, e->getType(), 0, 0, string);
-					env->DeleteLocalRef(string);
-					}
-					break;
-				case EventType::ReceiveText: {
-					jstring string = env->NewStringUTF(e->getText().c_str());
-					env->CallObjectMethod(classref, eventCallback, e->getType(), 0, 0, string);
-					env->DeleteLocalRef(string);
-					}
-					break;
-				case EventType::PlayerLeft:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getPlayer()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::NukeDetect:
-					if (e->getPosition() != Positions::Unknown) {
-						env->CallObjectMethod(classref, eventCallback, e->getType(), e->getPosition().x(), e->getPosition().y(), JNI_NULL);
+			logFrame = Broodwar->getFrameCount();
+			const LONG frameStartAllocations = heapAllocations;
+
+			// update native state every frame, even when the agent is not run
+			updateEnemyMemory();
+			updateUnitTransitions();
+			updateGeofences();
+			updatePlayerStats();
+			queueEvents();
+			publishSnapshot();
+
+			if (isAgentFrame()) {
+				LARGE_INTEGER agentStart;
+				QueryPerformanceCounter(&agentStart);
+
+				// update client data before event callbacks
+				env->CallObjectMethod(classref, gameUpdateCallback);
+
+				// deliver the events of this frame and of any frames skipped since the agent last ran
+				for (std::vector<QueuedEvent>::iterator e = pendingEvents.begin(); e != pendingEvents.end(); ++e) {
+					if (e->type == keyPressedEvent) {
+						env->CallObjectMethod(classref, keyPressCallback, e->p1);
+					} else if (e->type >= unitTransitionEvent) {
+						env->CallObjectMethod(classref, unitTransitionCallback, e->type - unitTransitionEvent, e->p1, e->p2);
+					} else if (e->text != NULL) {
+						jstring string = env->NewStringUTF(e->text);
+						env->CallObjectMethod(classref, eventCallback, e->type, e->p1, e->p2, string);
+						env->DeleteLocalRef(string);
 					} else {
-						env->CallObjectMethod(classref, eventCallback, e->getType(), -1, -1, JNI_NULL);
-					}
-					break;
-				case EventType::UnitDiscover:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::UnitEvade:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::UnitShow:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::UnitHide:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::UnitCreate:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::UnitDestroy:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::UnitMorph:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::UnitRenegade:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::SaveGame: {
-					jstring string = env->NewStringUTF(e->getText().c_str());
-					env->CallObjectMethod(classref, eventCallback, e->getType(), 0, 0, string);
-					env->DeleteLocalRef(string);
+						env->CallObjectMethod(classref, eventCallback, e->type, e->p1, e->p2, JNI_NULL);
 					}
-					break;
-				case EventType::UnitComplete:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getUnit()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::PlayerDropped:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), e->getPlayer()->getID(), 0, JNI_NULL);
-					break;
-				case EventType::None:
-					env->CallObjectMethod(classref, eventCallback, e->getType(), 0, 0, JNI_NULL);
-					break;
 				}
+				pendingEvents.clear();
+				resetFrameArena();
+
+				lastAgentFrame = Broodwar->getFrameCount();
+				LARGE_INTEGER agentEnd;
+				QueryPerformanceCounter(&agentEnd);
+				lastAgentDuration = agentEnd.QuadPart - agentStart.QuadPart;
 			}
 
-			// check for key presses
-			for (int keyCode = 0; keyCode <= 0xff; ++keyCode) {	
-				if (Broodwar->getKeyState(keyCode)) {	
-					if (!keyState[keyCode]) {
-						env->CallObjectMethod(classref, keyPressCallback, keyCode);
-					}
-					keyState[keyCode] = true;
-				} else {
-					keyState[keyCode] = false;
-				}
+			// lightweight hooks run every frame
+			if (frameListenersEnabled) {
+				env->CallObjectMethod(classref, frameTickCallback, Broodwar->getFrameCount());
 			}
 
+			issueSubmittedCommands();
+
 			// wait for the next frame
+			lastFrameAllocations = heapAllocations - frameStartAllocations;
 			BWAPI::BWAPIClient.update();
 			if (!BWAPI::BWAPIClient.isConnected()) {
-				javaPrint("Reconnecting...\n");
+				BRIDGE_LOG(LogConnection, LogWarning, "Reconnecting...");
 				reconnect();
 			}
 		}
 
 		// game completed
-		javaPrint("Match ended");
+		BRIDGE_LOG(LogMatch, LogInfo, "Match ended");
+		logFrame = -1;
 		env->CallObjectMethod(classref, gameEndCallback);
+
+		// commands queued after the last frame would be issued to the units of the next match
+		discardSubmittedCommands();
+	}
+}
+
+bool isAgentFrame(void)
+{
+	if (agentCadence <= 1 || lastAgentFrame < 0) {
+		return true;
+	}
+	if (Broodwar->getFrameCount() - lastAgentFrame >= agentCadence) {
+		return true;
+	}
+	if (agentFrameBudget > 0 && lastAgentDuration * 1000 <= agentFrameBudget * counterFrequency) {
+		return true;
+	}
+
+	// the end of the match is always delivered
+	for (std::vector<QueuedEvent>::iterator e = pendingEvents.begin(); e != pendingEvents.end(); ++e) {
+		if (e->type == EventType::MatchEnd) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// removes a pending event of the given type for a unit, returns true if there was one
+bool cancelPendingEvent(int type, int unitID)
+{
+	for (std::vector<QueuedEvent>::iterator e = pendingEvents.begin(); e != pendingEvents.end(); ++e) {
+		if (e->type == type && e->p1 == unitID) {
+			pendingEvents.erase(e);
+			return true;
+		}
+	}
+	return false;
+}
+
+void queueEvent(int type, int p1, int p2, const std::string* text)
+{
+	// events that undo a pending event cancel out
+	switch (type) {
+	case EventType::MatchFrame:
+		// a single match frame is delivered for all the frames since the agent last ran
+		cancelPendingEvent(EventType::MatchFrame, 0);
+		break;
+	case EventType::UnitShow:
+		if (cancelPendingEvent(EventType::UnitHide, p1)) {
+			return;
+		}
+		break;
+	case EventType::UnitHide:
+		if (cancelPendingEvent(EventType::UnitShow, p1)) {
+			return;
+		}
+		break;
+	case EventType::UnitDiscover:
+		if (cancelPendingEvent(EventType::UnitEvade, p1)) {
+			return;
+		}
+		break;
+	case EventType::UnitEvade:
+		if (cancelPendingEvent(EventType::UnitDiscover, p1)) {
+			return;
+		}
+		break;
+	}
+
+	QueuedEvent event;
+	event.type = type;
+	event.p1 = p1;
+	event.p2 = p2;
+	event.text = NULL;
+	if (text != NULL) {
+		char* copy = static_cast<char*>(frameAllocate(text->size() + 1));
+		memcpy(copy, text->c_str(), text->size() + 1);
+		event.text = copy;
+	}
+	pendingEvents.push_back(event);
+}
+
+/**
+* Encodes the events and key presses of the current frame into the pending events.
+*/
+void queueEvents(void)
+{
+	// BWAPI will always issue a MatchStart event as the very first event of a match
+	// BWAPI will always issue a MatchFrame event as the very last event of a frame (second-last at MatchEnd)
+	// BWAPI will always issue a MatchEnd event as the very last event of a match
+	for (std::list<Event>::iterator e = Broodwar->getEvents().begin(); e != Broodwar->getEvents().end(); ++e) {
+		// skip the encoding and upcall for events the agent does not listen to
+		if ((eventMask & (1 << e->getType())) == 0) {
+			continue;
+		}
+		switch (e->getType()) {
+		case EventType::MatchEnd:
+			queueEvent(e->getType(), e->isWinner() ? 1 : 0, 0, NULL);
+			break;
+		case EventType::SendText:
+		case EventType::ReceiveText:
+		case EventType::SaveGame:
+			queueEvent(e->getType(), 0, 0, &e->getText());
+			break;
+		case EventType::PlayerLeft:
+		case EventType::PlayerDropped:
+			queueEvent(e->getType(), e->getPlayer()->getID(), 0, NULL);
+			break;
+		case EventType::NukeDetect:
+			if (e->getPosition() != Positions::Unknown) {
+				queueEvent(e->getType(), e->getPosition().x(), e->getPosition().y(), NULL);
+			} else {
+				queueEvent(e->getType(), -1, -1, NULL);
+			}
+			break;
+		case EventType::UnitDiscover:
+		case EventType::UnitEvade:
+		case EventType::UnitShow:
+		case EventType::UnitHide:
+		case EventType::UnitCreate:
+		case EventType::UnitDestroy:
+		case EventType::UnitMorph:
+		case EventType::UnitRenegade:
+		case EventType::UnitComplete:
+			queueEvent(e->getType(), e->getUnit()->getID(), 0, NULL);
+			break;
+		default:
+			queueEvent(e->getType(), 0, 0, NULL);
+			break;
+		}
+	}
+
+	// check for key presses
+	for (int keyCode = 0; keyCode <= 0xff && (eventMask & keyPressedEventBit); ++keyCode) {
+		if (Broodwar->getKeyState(keyCode)) {
+			if (!keyState[keyCode]) {
+				queueEvent(keyPressedEvent, keyCode, 0, NULL);
+			}
+			keyState[keyCode] = true;
+		} else {
+			keyState[keyCode] = false;
+		}
 	}
 }
 
@@ -211,66 +580,330 @@ void reconnect(void)
 	}
 }
 
-void javaPrint(const char* msg) 
+/*****************************************************************************************************************/
+// Scratch buffers
+/*****************************************************************************************************************/
+
+/**
+* Returns the data buffer of the calling thread with room for at least size values. The buffer keeps the size of
+* the largest result it held, so once it is large enough queries do not touch the heap. It is freed when the
+* thread ends.
+*/
+jint* scratchBuffer(size_t size)
+{
+	std::vector<jint>* buffer = static_cast<std::vector<jint>*>(TlsGetValue(scratchSlot));
+	if (buffer == NULL) {
+		buffer = new std::vector<jint>();
+		TlsSetValue(scratchSlot, buffer);
+	}
+	if (buffer->size() < std::max(size, static_cast<size_t>(1))) {
+		buffer->resize(std::max(size, buffer->size() * 2));
+	}
+	return &(*buffer)[0];
+}
+
+void freeScratchBuffer(void)
+{
+	delete static_cast<std::vector<jint>*>(TlsGetValue(scratchSlot));
+	TlsSetValue(scratchSlot, NULL);
+}
+
+/**
+* Frees the data buffer of each thread that ends, so pools that replace their workers do not use up the address
+* space of the process.
+*/
+BOOL WINAPI DllMain(HINSTANCE instance, DWORD reason, LPVOID reserved)
+{
+	if (reason == DLL_THREAD_DETACH || reason == DLL_PROCESS_DETACH) {
+		freeScratchBuffer();
+	}
+	return TRUE;
+}
+
+/*****************************************************************************************************************/
+// Frame arena
+/*****************************************************************************************************************/
+
+// count the heap allocations made through new on the match thread, including those of the BWAPI client library
+void* operator new(size_t size)
+{
+	if (GetCurrentThreadId() == matchThreadID) {
+		heapAllocations++;
+	}
+	void* p = malloc(size > 0 ? size : 1);
+	if (p == NULL) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+	free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+	free(p);
+}
+
+/**
+* Returns room for size bytes, aligned for any type, that stays valid until the arena is reset once the agent has
+* handled the pending events. The arena grows to the peak of the previous frames, so once it is large enough this
+* does not touch the heap. The arena is not locked, so only the thread running the match may use it.
+*/
+void* frameAllocate(size_t size)
+{
+	size = (size + 7) & ~static_cast<size_t>(7);
+	if (frameArena.used + size <= frameArena.block.size() && !frameArena.block.empty()) {
+		void* p = &frameArena.block[frameArena.used];
+		frameArena.used += size;
+		return p;
+	}
+	frameArena.used += size;
+	char* p = new char[size];
+	frameArena.overflow.push_back(p);
+	return p;
+}
+
+void resetFrameArena(void)
+{
+	if (frameArena.used > frameArena.peak) {
+		frameArena.peak = frameArena.used;
+	}
+	if (!frameArena.overflow.empty()) {
+		for (size_t i = 0; i < frameArena.overflow.size(); i++) {
+			delete[] frameArena.overflow[i];
+		}
+		frameArena.overflow.clear();
+		frameArena.block.resize(frameArena.peak);
+	}
+	frameArena.used = 0;
+}
+
+/**
+* Returns the number of heap allocations the match thread made during the last frame, from the end of the previous
+* update of the BWAPI client to the start of the next, including those made by native calls while Java handled
+* the frame. Once warmed up, a frame still allocates a table entry for each unit first seen: the unit transition
+* state, the enemy memory for enemy units and the fence membership of units inside a fence.
+*/
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_getFrameAllocationCount(JNIEnv* env, jobject jObj)
+{
+	return lastFrameAllocations;
+}
+
+/*****************************************************************************************************************/
+// Bounded rings
+/*****************************************************************************************************************/
+
+/**
+* The rings passing messages from any thread to a single consumer without locking or allocating. Each cell has a
+* sequence telling producers and the consumer whose turn it is, as in Dmitry Vyukov's bounded queue, but counted
+* in laps of the ring so that a zeroed ring is ready to use: the cell at position p is free when its sequence is
+* the start of the lap, p & ~(Size - 1), and holds a message when it is one more. Size must be a power of two.
+*
+* Returns the next free cell for the producer to fill and publish, or NULL if the ring is full.
+*/
+template<class Cell, int Size> Cell* claimRingCell(Cell (&ring)[Size], volatile LONG& writePosition)
+{
+	LONG position = writePosition;
+	while (true) {
+		Cell* cell = &ring[position & (Size - 1)];
+		const LONG difference = cell->sequence - (position & ~(Size - 1));
+		if (difference == 0) {
+			const LONG previous = InterlockedCompareExchange(&writePosition, position + 1, position);
+			if (previous == position) {
+				return cell;
+			}
+			position = previous;
+		} else if (difference < 0) {
+			return NULL;
+		} else {
+			position = writePosition;
+		}
+	}
+}
+
+template<class Cell> void publishRingCell(Cell* cell)
+{
+	MemoryBarrier();
+	cell->sequence = cell->sequence + 1;
+}
+
+/**
+* Returns the cell holding the next message for the consumer, or NULL if there is none.
+*/
+template<class Cell, int Size> Cell* peekRingCell(Cell (&ring)[Size], LONG readPosition)
+{
+	Cell* cell = &ring[readPosition & (Size - 1)];
+	if (cell->sequence != (readPosition & ~(Size - 1)) + 1) {
+		return NULL;
+	}
+	MemoryBarrier();
+	return cell;
+}
+
+template<class Cell, int Size> void releaseRingCell(Cell (&ring)[Size], LONG& readPosition)
+{
+	Cell* cell = &ring[readPosition & (Size - 1)];
+	MemoryBarrier();
+	cell->sequence = cell->sequence - 1 + Size;
+	readPosition++;
+}
+
+/*****************************************************************************************************************/
+// Bridge log
+/*****************************************************************************************************************/
+
+/**
+* A message in the log ring.
+*/
+struct LogCell {
+	volatile LONG sequence;
+	jint frame;
+	jbyte category;
+	jbyte level;
+	char text[118];
+};
+const int logRingSize = 1024; // power of two
+LogCell logRing[logRingSize];
+volatile LONG logWritePosition = 0;
+LONG logReadPosition = 0;
+volatile LONG logDropped = 0;
+std::vector<jbyte> logDrainBuffer;
+
+void appendLogRecord(const LogCell& cell)
+{
+	const size_t length = strlen(cell.text);
+	const jbyte header[] = {
+		static_cast<jbyte>(cell.frame), static_cast<jbyte>(cell.frame >> 8),
+		static_cast<jbyte>(cell.frame >> 16), static_cast<jbyte>(cell.frame >> 24),
+		cell.category, cell.level, static_cast<jbyte>(length), static_cast<jbyte>(length >> 8)
+	};
+	logDrainBuffer.insert(logDrainBuffer.end(), header, header + sizeof(header));
+	logDrainBuffer.insert(logDrainBuffer.end(), cell.text, cell.text + length);
+}
+
+/**
+* Formats a message straight into a free cell of the ring without locking or allocating, from any thread. The
+* message is dropped, and counted, if Java has not drained the ring in time.
+*/
+void logMessage(int category, int level, const char* format, ...)
+{
+	LogCell* cell = claimRingCell(logRing, logWritePosition);
+	if (cell == NULL) {
+		InterlockedIncrement(&logDropped);
+		return;
+	}
+
+	cell->frame = logFrame;
+	cell->category = static_cast<jbyte>(category);
+	cell->level = static_cast<jbyte>(level);
+	va_list arguments;
+	va_start(arguments, format);
+	const int length = _vsnprintf(cell->text, sizeof(cell->text) - 1, format, arguments);
+	va_end(arguments);
+	cell->text[(length < 0 || length >= static_cast<int>(sizeof(cell->text) - 1)) ? sizeof(cell->text) - 1 : length] = '\0';
+	publishRingCell(cell);
+}
+
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeSetLogLevel(JNIEnv* env, jobject jObj, jint category, jint level)
 {
-	jEnv->CallObjectMethod(classref, printCallback, jEnv->NewStringUTF(msg));
+	if (category >= 0 && category < LogCategoryCount) {
+		InterlockedExchange(&logLevels[category], level);
+	}
+}
+
+/**
+* Takes the messages out of the ring, as records of the frame (4 bytes, little-endian), category, level, text
+* length (2 bytes) and text. Returns null if there are none. Must not be called from two threads at once.
+*/
+JNIEXPORT jbyteArray JNICALL Java_com_harbinger_jbw_Broodwar_drainLog(JNIEnv* env, jobject jObj)
+{
+	logDrainBuffer.clear();
+	const LONG dropped = InterlockedExchange(&logDropped, 0);
+	if (dropped > 0) {
+		LogCell notice;
+		notice.frame = logFrame;
+		notice.category = LogConnection;
+		notice.level = LogWarning;
+		_snprintf(notice.text, sizeof(notice.text) - 1, "%ld log messages were dropped", dropped);
+		notice.text[sizeof(notice.text) - 1] = '\0';
+		appendLogRecord(notice);
+	}
+	LogCell* cell;
+	while ((cell = peekRingCell(logRing, logReadPosition)) != NULL) {
+		appendLogRecord(*cell);
+		releaseRingCell(logRing, logReadPosition);
+	}
+	if (logDrainBuffer.empty()) {
+		return NULL;
+	}
+	jbyteArray result = env->NewByteArray(logDrainBuffer.size());
+	env->SetByteArrayRegion(result, 0, logDrainBuffer.size(), &logDrainBuffer[0]);
+	return result;
 }
 
 // build type mappings
 void loadTypeData(void) 
 {
-	std::set<UnitType> types = UnitTypes::allUnitTypes();
-	for (std::set<UnitType>::iterator i = types.begin(); i != types.end(); ++i) {
+	const std::set<UnitType>& types = UnitTypes::allUnitTypes();
+	for (std::set<UnitType>::const_iterator i = types.begin(); i != types.end(); ++i) {
 		unitTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<Race> raceTypes = Races::allRaces();
-	for (std::set<Race>::iterator i = raceTypes.begin(); i != raceTypes.end(); ++i) {
+	const std::set<Race>& raceTypes = Races::allRaces();
+	for (std::set<Race>::const_iterator i = raceTypes.begin(); i != raceTypes.end(); ++i) {
 		raceTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<TechType> techTypes = TechTypes::allTechTypes();
-	for (std::set<TechType>::iterator i = techTypes.begin(); i != techTypes.end(); ++i) {
+	const std::set<TechType>& techTypes = TechTypes::allTechTypes();
+	for (std::set<TechType>::const_iterator i = techTypes.begin(); i != techTypes.end(); ++i) {
 		techTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<UpgradeType> upgradeTypes = UpgradeTypes::allUpgradeTypes();
-	for (std::set<UpgradeType>::iterator i = upgradeTypes.begin(); i != upgradeTypes.end(); ++i) {
+	const std::set<UpgradeType>& upgradeTypes = UpgradeTypes::allUpgradeTypes();
+	for (std::set<UpgradeType>::const_iterator i = upgradeTypes.begin(); i != upgradeTypes.end(); ++i) {
 		upgradeTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<WeaponType> weaponTypes = WeaponTypes::allWeaponTypes();
-	for (std::set<WeaponType>::iterator i = weaponTypes.begin(); i != weaponTypes.end(); ++i) {
+	const std::set<WeaponType>& weaponTypes = WeaponTypes::allWeaponTypes();
+	for (std::set<WeaponType>::const_iterator i = weaponTypes.begin(); i != weaponTypes.end(); ++i) {
 		weaponTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<UnitSizeType> unitSizeTypes = UnitSizeTypes::allUnitSizeTypes();
-	for (std::set<UnitSizeType>::iterator i = unitSizeTypes.begin(); i != unitSizeTypes.end(); ++i) {
+	const std::set<UnitSizeType>& unitSizeTypes = UnitSizeTypes::allUnitSizeTypes();
+	for (std::set<UnitSizeType>::const_iterator i = unitSizeTypes.begin(); i != unitSizeTypes.end(); ++i) {
 		unitSizeTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<BulletType> bulletTypes = BulletTypes::allBulletTypes();
-	for (std::set<BulletType>::iterator i = bulletTypes.begin(); i != bulletTypes.end(); ++i) {
+	const std::set<BulletType>& bulletTypes = BulletTypes::allBulletTypes();
+	for (std::set<BulletType>::const_iterator i = bulletTypes.begin(); i != bulletTypes.end(); ++i) {
 		bulletTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<DamageType> damageTypes = DamageTypes::allDamageTypes();
-	for (std::set<DamageType>::iterator i = damageTypes.begin(); i != damageTypes.end(); ++i) {
+	const std::set<DamageType>& damageTypes = DamageTypes::allDamageTypes();
+	for (std::set<DamageType>::const_iterator i = damageTypes.begin(); i != damageTypes.end(); ++i) {
 		damageTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<ExplosionType> explosionTypes = ExplosionTypes::allExplosionTypes();
-	for (std::set<ExplosionType>::iterator i = explosionTypes.begin(); i != explosionTypes.end(); ++i) {
+	const std::set<ExplosionType>& explosionTypes = ExplosionTypes::allExplosionTypes();
+	for (std::set<ExplosionType>::const_iterator i = explosionTypes.begin(); i != explosionTypes.end(); ++i) {
 		explosionTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<UnitCommandType> unitCommandTypes = UnitCommandTypes::allUnitCommandTypes();
-	for (std::set<UnitCommandType>::iterator i = unitCommandTypes.begin(); i != unitCommandTypes.end(); ++i) {
+	const std::set<UnitCommandType>& unitCommandTypes = UnitCommandTypes::allUnitCommandTypes();
+	for (std::set<UnitCommandType>::const_iterator i = unitCommandTypes.begin(); i != unitCommandTypes.end(); ++i) {
 		unitCommandTypeMap[i->getID()] = (*i);
 	}
 
-	std::set<Order> orders = Orders::allOrders();
-	for (std::set<Order>::iterator i = orders.begin(); i != orders.end(); ++i) {
+	const std::set<Order>& orders = Orders::allOrders();
+	for (std::set<Order>::const_iterator i = orders.begin(); i != orders.end(); ++i) {
 		orderTypeMap[i->getID()] = (*i);
 	}
 }
@@ -304,6 +937,27 @@ JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_leaveGame(JNIEnv* env, jo
 	Broodwar->leaveGame();
 }
 
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setEventMask(JNIEnv* env, jobject jObj, jint mask)
+{
+	eventMask = mask;
+}
+
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeSetAgentCadence(JNIEnv* env, jobject jObj, jint frames, jint frameBudget)
+{
+	agentCadence = frames;
+	agentFrameBudget = frameBudget;
+	if (counterFrequency == 0) {
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		counterFrequency = frequency.QuadPart;
+	}
+}
+
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setFrameListenersEnabled(JNIEnv* env, jobject jObj, jboolean enabled)
+{
+	frameListenersEnabled = (enabled == JNI_TRUE);
+}
+
 /*****************************************************************************************************************/
 // Game state queries
 /*****************************************************************************************************************/
@@ -322,26 +976,11 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getPlayersData(JNIEn
 {
 	int index = 0;
 
-	std::set<Player*> players = Broodwar->getPlayers();
+	const std::set<Player*>& players = Broodwar->getPlayers();
+	jint* intBuf = scratchBuffer(players.size() * playerRecordSize);
 	
-	for (std::set<Player*>::iterator i = players.begin(); i != players.end(); ++i) {
-		intBuf[index++] = (*i)->getID();
-		intBuf[index++] = (*i)->getRace().getID();
-		intBuf[index++] = (*i)->getType().getID();
-		intBuf[index++] = (*i)->getStartLocation().x();
-		intBuf[index++] = (*i)->getStartLocation().y();
-		if (Broodwar->isReplay()) {
-			intBuf[index++] = 0; // there is no self in replays
-			intBuf[index++] = 0; // as there is no self in replays, there are also no allies
-			intBuf[index++] = 0; // as there is no self in replays, there are also no enemies
-		} else {
-			intBuf[index++] = ((*i)->getID() == Broodwar->self()->getID()) ? 1 : 0;	// is self
-			intBuf[index++] = (*i)->isAlly(Broodwar->self()) ? 1 : 0; // is ally
-			intBuf[index++] = (*i)->isEnemy(Broodwar->self()) ? 1 : 0; // is enemy
-		}
-		intBuf[index++] = (*i)->isNeutral() ? 1 : 0;
-		intBuf[index++] = (*i)->isObserver() ? 1 : 0; // Always true? BWAPI bug?
-		intBuf[index++] = (*i)->getColor().getID();
+	for (std::set<Player*>::const_iterator i = players.begin(); i != players.end(); ++i) {
+		index = writePlayer(intBuf, index, *i);
 	}
 
 	jintArray result = env->NewIntArray(index);
@@ -351,6 +990,7 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getPlayersData(JNIEn
 
 JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getPlayerUpdate(JNIEnv* env, jobject jObj, jint playerID)
 {
+	jint* intBuf = scratchBuffer(10 + 1 + 5 * BWAPI_UNIT_TYPE_MAX_COUNT);
 	int index = 0;
 	Player* p = Broodwar->getPlayer(playerID);
 	intBuf[index++] = p->minerals();
@@ -364,6 +1004,21 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getPlayerUpdate(JNIE
 	intBuf[index++] = p->getBuildingScore();
 	intBuf[index++] = p->getRazingScore();
 
+	// per unit type counts, copied in bulk straight from the shared player data
+	const PlayerData& data = BWAPI::BWAPIClient.data->players[playerID];
+	const int typeCount = BWAPI_UNIT_TYPE_MAX_COUNT;
+	intBuf[index++] = typeCount;
+	memcpy(&intBuf[index], data.allUnitCount, typeCount * sizeof(jint));
+	index += typeCount;
+	memcpy(&intBuf[index], data.visibleUnitCount, typeCount * sizeof(jint));
+	index += typeCount;
+	memcpy(&intBuf[index], data.completedUnitCount, typeCount * sizeof(jint));
+	index += typeCount;
+	memcpy(&intBuf[index], data.deadUnitCount, typeCount * sizeof(jint));
+	index += typeCount;
+	memcpy(&intBuf[index], data.killedUnitCount, typeCount * sizeof(jint));
+	index += typeCount;
+
 	jintArray result =env->NewIntArray(index);
 	env->SetIntArrayRegion(result, 0, index, intBuf);
 	return result;
@@ -383,8 +1038,9 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getResearchStatus(JN
 	int index = 0;
 	Player* p = Broodwar->getPlayer(playerID);
 
-	std::set<TechType> techTypes = TechTypes::allTechTypes();
-	for (std::set<TechType>::iterator i = techTypes.begin(); i != techTypes.end(); ++i) {
+	const std::set<TechType>& techTypes = TechTypes::allTechTypes();
+	jint* intBuf = scratchBuffer(techTypes.size() * 3);
+	for (std::set<TechType>::const_iterator i = techTypes.begin(); i != techTypes.end(); ++i) {
 		intBuf[index++] = i->getID();
 		intBuf[index++] = p->hasResearched((*i)) ? 1 : 0;
 		intBuf[index++] = p->isResearching((*i)) ? 1 : 0;
@@ -400,8 +1056,9 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUpgradeStatus(JNI
 	int index = 0;
 	Player* p = Broodwar->getPlayer(playerID);
 
-	std::set<UpgradeType> upTypes = UpgradeTypes::allUpgradeTypes();
-	for (std::set<UpgradeType>::iterator i = upTypes.begin(); i != upTypes.end(); ++i) {
+	const std::set<UpgradeType>& upTypes = UpgradeTypes::allUpgradeTypes();
+	jint* intBuf = scratchBuffer(upTypes.size() * 3);
+	for (std::set<UpgradeType>::const_iterator i = upTypes.begin(); i != upTypes.end(); ++i) {
 		intBuf[index++] = i->getID();
 		intBuf[index++] = p->getUpgradeLevel((*i));
 		intBuf[index++] = p->isUpgrading((*i)) ? 1 : 0;
@@ -416,65 +1073,10 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitTypes(JNIEnv*
 {
 	int index = 0;
 
-	std::set<UnitType> types = UnitTypes::allUnitTypes();
-	for (std::set<UnitType>::iterator i = types.begin(); i != types.end(); ++i) {
-		intBuf[index++] = i->getID();
-		intBuf[index++] = i->getRace().getID();
-		intBuf[index++] = i->whatBuilds().first.getID();
-		intBuf[index++] = i->requiredTech().getID();
-		intBuf[index++] = i->armorUpgrade().getID();
-		intBuf[index++] = i->maxHitPoints();
-		intBuf[index++] = i->maxShields();
-		intBuf[index++] = i->maxEnergy();
-		intBuf[index++] = i->armor();
-		intBuf[index++] = i->mineralPrice();
-		intBuf[index++] = i->gasPrice();
-		intBuf[index++] = i->buildTime();
-		intBuf[index++] = i->supplyRequired();
-		intBuf[index++] = i->supplyProvided();
-		intBuf[index++] = i->spaceRequired();
-		intBuf[index++] = i->spaceProvided();
-		intBuf[index++] = i->buildScore();
-		intBuf[index++] = i->destroyScore();
-		intBuf[index++] = i->size().getID();
-		intBuf[index++] = i->tileWidth();
-		intBuf[index++] = i->tileHeight();
-		intBuf[index++] = i->dimensionLeft();
-		intBuf[index++] = i->dimensionUp();
-		intBuf[index++] = i->dimensionRight();
-		intBuf[index++] = i->dimensionDown();
-		intBuf[index++] = i->seekRange();
-		intBuf[index++] = i->sightRange();
-		intBuf[index++] = i->groundWeapon().getID();
-		intBuf[index++] = i->maxGroundHits();
-		intBuf[index++] = i->airWeapon().getID();
-		intBuf[index++] = i->maxAirHits();
-		intBuf[index++] = static_cast<int>(i->topSpeed() * fixedScale);
-		intBuf[index++] = i->acceleration();
-		intBuf[index++] = i->haltDistance();
-		intBuf[index++] = i->turnRadius();
-		intBuf[index++] = i->canProduce() ? 1 : 0;
-		intBuf[index++] = i->canAttack() ? 1 : 0;
-		intBuf[index++] = i->canMove() ? 1 : 0;
-		intBuf[index++] = i->isFlyer() ? 1 : 0;
-		intBuf[index++] = i->regeneratesHP() ? 1 : 0;
-		intBuf[index++] = i->isSpellcaster() ? 1 : 0;
-		intBuf[index++] = i->isInvincible() ? 1 : 0;
-		intBuf[index++] = i->isOrganic() ? 1 : 0;
-		intBuf[index++] = i->isMechanical() ? 1 : 0;
-		intBuf[index++] = i->isRobotic() ? 1 : 0;
-		intBuf[index++] = i->isDetector() ? 1 : 0;
-		intBuf[index++] = i->isResourceContainer() ? 1 : 0;
-		intBuf[index++] = i->isRefinery() ? 1 : 0;
-		intBuf[index++] = i->isWorker() ? 1 : 0;
-		intBuf[index++] = i->requiresPsi() ? 1 : 0;
-		intBuf[index++] = i->requiresCreep() ? 1 : 0;
-		intBuf[index++] = i->isBurrowable() ? 1 : 0;
-		intBuf[index++] = i->isCloakable() ? 1 : 0;
-		intBuf[index++] = i->isBuilding() ? 1 : 0;
-		intBuf[index++] = i->isAddon() ? 1 : 0;
-		intBuf[index++] = i->isFlyingBuilding() ? 1 : 0;
-		intBuf[index++] = i->isSpell() ? 1 : 0;
+	const std::set<UnitType>& types = UnitTypes::allUnitTypes();
+	jint* intBuf = scratchBuffer(types.size() * unitTypeRecordSize);
+	for (std::set<UnitType>::const_iterator i = types.begin(); i != types.end(); ++i) {
+		index = writeUnitType(intBuf, index, *i);
 
 		// cloakingTech
 		// abilities
@@ -496,13 +1098,14 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitTypes(JNIEnv*
 
 JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getUnitTypeName(JNIEnv* env, jobject jObj, jint unitTypeID)
 {
-	return env->NewStringUTF(unitTypeMap[unitTypeID].getName().c_str());
+	return env->NewStringUTF(findType(unitTypeMap, unitTypeID).getName().c_str());
 }
 
 JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getRequiredUnits(JNIEnv* env, jobject jObj, jint unitTypeID)
 {
 	int index = 0;
-	std::map<UnitType, int> requiredUnits = unitTypeMap[unitTypeID].requiredUnits();
+	std::map<UnitType, int> requiredUnits = findType(unitTypeMap, unitTypeID).requiredUnits();
+	jint* intBuf = scratchBuffer(requiredUnits.size() * 2);
 	for (std::map<UnitType, int>::iterator i = requiredUnits.begin(); i != requiredUnits.end(); ++i) {
 		intBuf[index++] = i->first.getID();
 		intBuf[index++] = i->second;
@@ -517,8 +1120,9 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getRaceTypes(JNIEnv*
 {
 	int index = 0;
 
-	std::set<Race> types = Races::allRaces();
-	for (std::set<Race>::iterator i = types.begin(); i != types.end(); ++i)
+	const std::set<Race>& types = Races::allRaces();
+	jint* intBuf = scratchBuffer(types.size() * 6);
+	for (std::set<Race>::const_iterator i = types.begin(); i != types.end(); ++i)
 	{
 		intBuf[index++] = i->getID();
 		intBuf[index++] = i->getWorker().getID();
@@ -535,15 +1139,16 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getRaceTypes(JNIEnv*
 
 JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getRaceTypeName(JNIEnv* env, jobject jObj, jint typeID)
 {
-	return env->NewStringUTF(raceTypeMap[typeID].getName().c_str());
+	return env->NewStringUTF(findType(raceTypeMap, typeID).getName().c_str());
 }
 
 JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getTechTypes(JNIEnv* env, jobject jObj)
 {
 	int index = 0;
 
-	std::set<TechType> techTypes = TechTypes::allTechTypes();
-	for (std::set<TechType>::iterator i = techTypes.begin(); i != techTypes.end(); ++i) {
+	const std::set<TechType>& techTypes = TechTypes::allTechTypes();
+	jint* intBuf = scratchBuffer(techTypes.size() * 10);
+	for (std::set<TechType>::const_iterator i = techTypes.begin(); i != techTypes.end(); ++i) {
 		intBuf[index++] = i->getID();
 		intBuf[index++] = i->getRace().getID();
 		intBuf[index++] = i->mineralPrice();
@@ -565,15 +1170,16 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getTechTypes(JNIEnv*
 
 JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getTechTypeName(JNIEnv* env, jobject jObj, jint techID)
 {
-	return env->NewStringUTF(techTypeMap[techID].getName().c_str());
+	return env->NewStringUTF(findType(techTypeMap, techID).getName().c_str());
 }
 
 JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUpgradeTypes(JNIEnv* env, jobject jObj)
 {
 	int index = 0;
 
-	std::set<UpgradeType> upgradeTypes = UpgradeTypes::allUpgradeTypes();
-	for (std::set<UpgradeType>::iterator i = upgradeTypes.begin(); i != upgradeTypes.end(); ++i) {
+	const std::set<UpgradeType>& upgradeTypes = UpgradeTypes::allUpgradeTypes();
+	jint* intBuf = scratchBuffer(upgradeTypes.size() * 10);
+	for (std::set<UpgradeType>::const_iterator i = upgradeTypes.begin(); i != upgradeTypes.end(); ++i) {
 		intBuf[index++] = i->getID();
 		intBuf[index++] = i->getRace().getID();
 		intBuf[index++] = i->mineralPrice();
@@ -593,15 +1199,16 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUpgradeTypes(JNIE
 
 JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getUpgradeTypeName(JNIEnv* env, jobject jObj, jint upgradeID)
 {
-	return env->NewStringUTF(upgradeTypeMap[upgradeID].getName().c_str());
+	return env->NewStringUTF(findType(upgradeTypeMap, upgradeID).getName().c_str());
 }
 
 JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getWeaponTypes(JNIEnv* env, jobject jObj)
 {
 	int index = 0;
 
-	std::set<WeaponType> weaponTypes = WeaponTypes::allWeaponTypes();
-	for (std::set<WeaponType>::iterator i = weaponTypes.begin(); i != weaponTypes.end(); ++i) {
+	const std::set<WeaponType>& weaponTypes = WeaponTypes::allWeaponTypes();
+	jint* intBuf = scratchBuffer(weaponTypes.size() * 24);
+	for (std::set<WeaponType>::const_iterator i = weaponTypes.begin(); i != weaponTypes.end(); ++i) {
 		intBuf[index++] = i->getID();
 		intBuf[index++] = i->getTech().getID();
 		intBuf[index++] = i->whatUses().getID();
@@ -635,328 +1242,1805 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getWeaponTypes(JNIEn
 
 JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getWeaponTypeName(JNIEnv* env, jobject jObj, jint weaponID)
 {
-	return env->NewStringUTF(weaponTypeMap[weaponID].getName().c_str());
+	return env->NewStringUTF(findType(weaponTypeMap, weaponID).getName().c_str());
 }
 
 JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitSizeTypes(JNIEnv* env, jobject jObj)
 {
 	int index = 0;
 
-	std::set<UnitSizeType> unitSizeTypes = UnitSizeTypes::allUnitSizeTypes();
-	for (std::set<UnitSizeType>::iterator i = unitSizeTypes.begin(); i != unitSizeTypes.end(); ++i) {
+	const std::set<UnitSizeType>& unitSizeTypes = UnitSizeTypes::allUnitSizeTypes();
+	jint* intBuf = scratchBuffer(unitSizeTypes.size());
+	for (std::set<UnitSizeType>::const_iterator i = unitSizeTypes.begin(); i != unitSizeTypes.end(); ++i) {
+		intBuf[index++] = i->getID();
+	}
+
+	jintArray result =env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getUnitSizeTypeName(JNIEnv* env, jobject jObj, jint sizeID)
+{
+	return env->NewStringUTF(findType(unitSizeTypeMap, sizeID).getName().c_str());
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getBulletTypes(JNIEnv* env, jobject jObj)
+{
+	int index = 0;
+
+	const std::set<BulletType>& bulletTypes = BulletTypes::allBulletTypes();
+	jint* intBuf = scratchBuffer(bulletTypes.size());
+	for (std::set<BulletType>::const_iterator i = bulletTypes.begin(); i != bulletTypes.end(); ++i) {
+		intBuf[index++] = i->getID();
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getBulletTypeName(JNIEnv* env, jobject jObj, jint bulletID)
+{
+	return env->NewStringUTF(findType(bulletTypeMap, bulletID).getName().c_str());
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getDamageTypes(JNIEnv* env, jobject jObj)
+{
+	int index = 0;
+
+	const std::set<DamageType>& damageTypes = DamageTypes::allDamageTypes();
+	jint* intBuf = scratchBuffer(damageTypes.size());
+	for (std::set<DamageType>::const_iterator i = damageTypes.begin(); i != damageTypes.end(); ++i) {
+		intBuf[index++] = i->getID();
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getDamageTypeName(JNIEnv* env, jobject jObj, jint damageID)
+{
+	return env->NewStringUTF(findType(damageTypeMap, damageID).getName().c_str());
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getExplosionTypes(JNIEnv* env, jobject jObj)
+{
+	int index = 0;
+
+	const std::set<ExplosionType>& explosionTypes = ExplosionTypes::allExplosionTypes();
+	jint* intBuf = scratchBuffer(explosionTypes.size());
+	for (std::set<ExplosionType>::const_iterator i = explosionTypes.begin(); i != explosionTypes.end(); ++i) {
 		intBuf[index++] = i->getID();
 	}
-
-	jintArray result =env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getExplosionTypeName(JNIEnv* env, jobject jObj, jint explosionID)
+{
+	return env->NewStringUTF(findType(explosionTypeMap, explosionID).getName().c_str());
+}
+
+JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getUnitCommandTypeName(JNIEnv* env, jobject jObj, jint unitCommandID)
+{
+	return env->NewStringUTF(findType(unitCommandTypeMap, unitCommandID).getName().c_str());
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitCommandTypes(JNIEnv* env, jobject jObj)
+{
+	int index = 0;
+
+	const std::set<UnitCommandType>& unitCommandTypes = UnitCommandTypes::allUnitCommandTypes();
+	jint* intBuf = scratchBuffer(unitCommandTypes.size());
+	for (std::set<UnitCommandType>::const_iterator i = unitCommandTypes.begin(); i != unitCommandTypes.end(); ++i) {
+		intBuf[index++] = i->getID();
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getOrderTypeName(JNIEnv* env, jobject jObj, jint unitCommandID)
+{
+	return env->NewStringUTF(findType(orderTypeMap, unitCommandID).getName().c_str());
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getOrderTypes(JNIEnv* env, jobject jObj)
+{
+	int index = 0;
+
+	const std::set<Order>& orders = Orders::allOrders();
+	jint* intBuf = scratchBuffer(orders.size());
+	for (std::set<Order>::const_iterator i = orders.begin(); i != orders.end(); ++i) {
+		intBuf[index++] = i->getID();
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+/**
+* Returns the list of active units in the game, except for the static neutral units sent by
+* getStaticNeutralUpdate.
+*
+* Each unit takes up unitRecordSize integer values, laid out as described in bridge.schema.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getAllUnitsData(JNIEnv* env, jobject jObj)
+{
+	int index = 0;
+
+	const std::set<Unit*>& units = Broodwar->getAllUnits();
+	jint* intBuf = scratchBuffer(units.size() * unitRecordSize);
+	for (std::set<Unit*>::const_iterator i = units.begin(); i != units.end(); ++i) {
+		const UnitData& data = unitData(*i);
+		if (!isStaticNeutral(*i, data)) {
+			index = writeUnitRaw(intBuf, index, *i, data);
+		}
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+/**
+* Writes every unit through both the accessors and the raw data and returns (unit ID, slot, accessor value,
+* raw value) for each slot in which the records differ, to check the raw expressions of bridge.schema.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_compareUnitRecords(JNIEnv* env, jobject jObj)
+{
+	int index = 0;
+
+	jint accessorRecord[unitRecordSize];
+	jint rawRecord[unitRecordSize];
+	const std::set<Unit*>& units = Broodwar->getAllUnits();
+	jint* intBuf = scratchBuffer(units.size() * unitRecordSize * 4);
+	for (std::set<Unit*>::const_iterator i = units.begin(); i != units.end(); ++i) {
+		writeUnit(accessorRecord, 0, *i);
+		writeUnitRaw(rawRecord, 0, *i, unitData(*i));
+		for (int slot = 0; slot < unitRecordSize; slot++) {
+			if (accessorRecord[slot] != rawRecord[slot]) {
+				intBuf[index++] = (*i)->getID();
+				intBuf[index++] = slot;
+				intBuf[index++] = accessorRecord[slot];
+				intBuf[index++] = rawRecord[slot];
+			}
+		}
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+/**
+* Returns the record of a single unit, or an empty array if it is not accessible, for refreshing the few units
+* an agent reads on a frame it is not run without reading all of them.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitData(JNIEnv* env, jobject jObj, jint unitID)
+{
+	jint record[unitRecordSize];
+	int index = 0;
+
+	Unit* unit = Broodwar->getUnit(unitID);
+	if (unit != NULL && unit->exists()) {
+		index = writeUnitRaw(record, 0, unit, unitData(unit));
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, record);
+	return result;
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getLoadedUnits(JNIEnv* env, jobject, jint unitID)
+{
+	jint* intBuf = scratchBuffer(Broodwar->getAllUnits().size());
+	int index = 0;
+
+	Unit* unit = Broodwar->getUnit(unitID);
+	if (unit != NULL) {
+		const std::set<Unit*>& loaded = loadedUnitsOf(unit);
+		for (std::set<Unit*>::const_iterator it = loaded.begin(); it != loaded.end(); it++){
+			intBuf[index++] = (*it)->getID();
+		}
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getInterceptors(JNIEnv* env, jobject, jint unitID)
+{
+	jint* intBuf = scratchBuffer(Broodwar->getAllUnits().size());
+	int index = 0;
+
+	Unit* unit = Broodwar->getUnit(unitID);
+	if (unit != NULL) {
+		const std::set<Unit*>& loaded = interceptorsOf(unit);
+		for (std::set<Unit*>::const_iterator it = loaded.begin(); it != loaded.end(); it++){
+			intBuf[index++] = (*it)->getID();
+		}
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getLarva(JNIEnv* env, jobject, jint unitID)
+{
+	jint* intBuf = scratchBuffer(Broodwar->getAllUnits().size());
+	int index = 0;
+
+	Unit* unit = Broodwar->getUnit(unitID);
+	if (unit != NULL) {
+		const std::set<Unit*>& loaded = larvaOf(unit);
+		for (std::set<Unit*>::const_iterator it = loaded.begin(); it != loaded.end(); it++){
+			intBuf[index++] = (*it)->getID();
+		}
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_isVisibleToPlayer(JNIEnv* env, jobject jObj, jint unitID, jint playerID)
+{
+	Unit* u = Broodwar->getUnit(unitID);
+	Player* p = Broodwar->getPlayer(playerID);
+	if (u != NULL && p != NULL)
+	{
+		return u->isVisible(p);
+	}
+	return false;
+}
+
+/**
+* Fills the given buffer with the active bullets in the game and returns the number of bullets written.
+*
+* Each bullet takes up bulletRecordSize integer values, laid out as described in bridge.schema.
+*/
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_getBulletsData(JNIEnv* env, jobject jObj, jintArray buffer)
+{
+	int index = 0;
+	int count = 0;
+	int capacity = env->GetArrayLength(buffer);
+	jint* intBuf = scratchBuffer(capacity);
+
+	std::set<Bullet*>& bullets = Broodwar->getBullets();
+	for (std::set<Bullet*>::iterator i = bullets.begin(); i != bullets.end() && index + bulletRecordSize <= capacity; ++i) {
+		index = writeBullet(intBuf, index, *i);
+		++count;
+	}
+
+	env->SetIntArrayRegion(buffer, 0, index, intBuf);
+	return count;
+}
+
+/*****************************************************************************************************************/
+// Enemy memory
+/*****************************************************************************************************************/
+
+void rememberEnemyUnit(Unit* unit, int frame)
+{
+	EnemyRecord& record = enemyMemory[unit->getID()];
+	record.playerID = unit->getPlayer()->getID();
+	record.typeID = unit->getType().getID();
+	record.x = unit->getPosition().x();
+	record.y = unit->getPosition().y();
+	record.hitPoints = unit->getHitPoints();
+	record.shields = unit->getShields();
+	record.lastSeenFrame = frame;
+	record.building = unit->getType().isBuilding();
+	record.visible = true;
+}
+
+/**
+* Updates the last known state of enemy units from the events and visible units of the current frame.
+*
+* Buildings are forgotten once their last known tile is visible without them, mobile units are forgotten
+* after they have been out of sight for longer than the memory timeout.
+*/
+void updateEnemyMemory(void)
+{
+	// there is no self to have enemies in replays
+	if (Broodwar->isReplay()) {
+		return;
+	}
+
+	int frame = Broodwar->getFrameCount();
+	for (std::list<Event>::iterator e = Broodwar->getEvents().begin(); e != Broodwar->getEvents().end(); ++e) {
+		switch (e->getType()) {
+		case EventType::UnitShow:
+			if (Broodwar->self()->isEnemy(e->getUnit()->getPlayer())) {
+				rememberEnemyUnit(e->getUnit(), frame);
+			}
+			break;
+		case EventType::UnitHide: {
+			std::map<int, EnemyRecord>::iterator it = enemyMemory.find(e->getUnit()->getID());
+			if (it != enemyMemory.end()) {
+				it->second.visible = false;
+			}
+			}
+			break;
+		case EventType::UnitDestroy:
+		case EventType::UnitRenegade:
+			enemyMemory.erase(e->getUnit()->getID());
+			break;
+		default:
+			break;
+		}
+	}
+
+	// refresh everything that is still in sight
+	std::set<Player*>& enemies = Broodwar->enemies();
+	for (std::set<Player*>::iterator p = enemies.begin(); p != enemies.end(); ++p) {
+		const std::set<Unit*>& units = (*p)->getUnits();
+		for (std::set<Unit*>::const_iterator u = units.begin(); u != units.end(); ++u) {
+			if ((*u)->isVisible()) {
+				rememberEnemyUnit(*u, frame);
+			}
+		}
+	}
+
+	std::map<int, EnemyRecord>::iterator it = enemyMemory.begin();
+	while (it != enemyMemory.end()) {
+		EnemyRecord& record = it->second;
+		if (record.lastSeenFrame != frame) {
+			record.visible = false;
+		}
+
+		bool forget = false;
+		if (!record.visible) {
+			if (record.building) {
+				forget = Broodwar->isVisible(record.x / TILE_SIZE, record.y / TILE_SIZE);
+			} else {
+				forget = enemyMemoryTimeout >= 0 && frame - record.lastSeenFrame > enemyMemoryTimeout;
+			}
+		}
+
+		if (forget) {
+			enemyMemory.erase(it++);
+		} else {
+			++it;
+		}
+	}
+}
+
+/**
+* Returns the last known state of the remembered enemy units.
+*
+* Each unit takes up a fixed number of integer values. Currently: 10
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getEnemyMemoryData(JNIEnv* env, jobject jObj)
+{
+	jint* intBuf = scratchBuffer(enemyMemory.size() * 10);
+	int index = 0;
+
+	for (std::map<int, EnemyRecord>::iterator it = enemyMemory.begin(); it != enemyMemory.end(); ++it) {
+		intBuf[index++] = it->first;
+		intBuf[index++] = it->second.playerID;
+		intBuf[index++] = it->second.typeID;
+		intBuf[index++] = it->second.x;
+		intBuf[index++] = it->second.y;
+		intBuf[index++] = it->second.hitPoints;
+		intBuf[index++] = it->second.shields;
+		intBuf[index++] = it->second.lastSeenFrame;
+		intBuf[index++] = it->second.building ? 1 : 0;
+		intBuf[index++] = it->second.visible ? 1 : 0;
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setEnemyMemoryTimeout(JNIEnv* env, jobject jObj, jint frames)
+{
+	enemyMemoryTimeout = frames;
+}
+
+/*****************************************************************************************************************/
+// Unit transitions
+/*****************************************************************************************************************/
+
+// transition kinds, must match the ids of com.harbinger.jbw.UnitTransition
+enum UnitTransitionKind {
+	BecameIdle = 0,
+	TrainingStarted = 1,
+	TrainingFinished = 2,
+	Damaged = 3,
+	AttackStarted = 4,
+	Cloaked = 5,
+	Decloaked = 6,
+	Lifted = 7,
+	Landed = 8
+};
+
+/**
+* Queues a transition with the events, so the agent receives it after the events of earlier frames and before the
+* BWAPI events of the frame it was detected in.
+*/
+void addUnitTransition(int kind, int unitID, int value)
+{
+	if (unitTransitionMask & (1 << kind)) {
+		queueEvent(unitTransitionEvent + kind, unitID, value, NULL);
+	}
+}
+
+// frames the unit a training queue produced may take to be completed after the queue shrank
+const int trainingCompletionFrames = 8;
+
+/**
+* Whether a unit completed this frame is the one a shrunk training queue produced: the unit the trainer was
+* building, or for queues without one, such as interceptors and scarabs, a unit of the queued type and player.
+*/
+bool isTrainedUnit(const PendingTraining& training, Unit* unit)
+{
+	if (training.traineeID >= 0) {
+		return unit->getID() == training.traineeID;
+	}
+	const UnitData& data = unitData(unit);
+	return data.type == training.typeID && data.player == training.playerID;
+}
+
+/**
+* Records TrainingFinished for the shrunk training queues whose unit has been completed, and drops those that were
+* canceled: their unit was destroyed or not completed in time.
+*/
+void resolvePendingTrainings(int frame)
+{
+	std::vector<PendingTraining>::iterator training = pendingTrainings.begin();
+	while (training != pendingTrainings.end()) {
+		bool finished = false;
+		for (std::vector<Unit*>::iterator u = completedUnits.begin(); u != completedUnits.end() && !finished; ++u) {
+			finished = isTrainedUnit(*training, *u);
+		}
+		// the unit in training may have been completed before the queue shrank
+		if (!finished && training->traineeID >= 0) {
+			Unit* trainee = Broodwar->getUnit(training->traineeID);
+			finished = trainee != NULL && trainee->exists() && trainee->isCompleted()
+				&& unitData(trainee).type == training->typeID;
+		}
+		if (finished) {
+			addUnitTransition(TrainingFinished, training->trainerID, training->queueSize);
+			training = pendingTrainings.erase(training);
+		} else if (frame - training->frame >= trainingCompletionFrames) {
+			training = pendingTrainings.erase(training);
+		} else {
+			++training;
+		}
+	}
+}
+
+/**
+* Compares the accessible units against their state in the previous frame and records the transitions
+* the agent has subscribed to.
+*
+* Units seen for the first time only have their state recorded. Units that are no longer accessible are
+* forgotten, so they start fresh when they reappear.
+*/
+void updateUnitTransitions(void)
+{
+	if (unitTransitionMask == 0) {
+		unitStates.clear();
+		pendingTrainings.clear();
+		return;
+	}
+
+	int frame = Broodwar->getFrameCount();
+	completedUnits.clear();
+	for (std::list<Event>::iterator e = Broodwar->getEvents().begin(); e != Broodwar->getEvents().end(); ++e) {
+		if (e->getType() == EventType::UnitComplete && e->getUnit() != NULL) {
+			completedUnits.push_back(e->getUnit());
+		}
+	}
+
+	std::set<Unit*>& units = Broodwar->getAllUnits();
+	for (std::set<Unit*>::iterator i = units.begin(); i != units.end(); ++i) {
+		Unit* unit = *i;
+		int unitID = unit->getID();
+		const UnitData& data = unitData(unit);
+
+		UnitState current;
+		current.frame = frame;
+		current.typeID = data.type;
+		current.durability = data.hitPoints + data.shields;
+		current.queueSize = data.trainingQueueCount;
+		current.trainingTypeID = data.trainingQueueCount > 0 ? data.trainingQueue[0] : -1;
+		current.traineeID = data.trainingQueueCount > 0 ? data.buildUnit : -1;
+		current.idle = unit->isIdle();
+		current.attacking = unit->isAttacking();
+		current.cloaked = unit->isCloaked();
+		current.lifted = unit->isLifted();
+
+		std::map<int, UnitState>::iterator it = unitStates.find(unitID);
+		if (it != unitStates.end()) {
+			const UnitState& previous = it->second;
+			if (current.idle && !previous.idle) {
+				addUnitTransition(BecameIdle, unitID, 0);
+			}
+			if (current.queueSize > previous.queueSize) {
+				addUnitTransition(TrainingStarted, unitID, current.queueSize);
+			} else if (current.queueSize < previous.queueSize && previous.trainingTypeID >= 0) {
+				// the queue also shrinks when training is canceled, so wait for the trained unit to be completed
+				PendingTraining training;
+				training.frame = frame;
+				training.trainerID = unitID;
+				training.traineeID = previous.traineeID;
+				training.typeID = previous.trainingTypeID;
+				training.playerID = data.player;
+				training.queueSize = current.queueSize;
+				pendingTrainings.push_back(training);
+			}
+			// morphs, sieging and merging change the maximum hit points and shields, they are not damage
+			if (current.typeID == previous.typeID && current.durability < previous.durability) {
+				addUnitTransition(Damaged, unitID, previous.durability - current.durability);
+			}
+			if (current.attacking && !previous.attacking) {
+				addUnitTransition(AttackStarted, unitID, 0);
+			}
+			if (current.cloaked != previous.cloaked) {
+				addUnitTransition(current.cloaked ? Cloaked : Decloaked, unitID, 0);
+			}
+			if (current.lifted != previous.lifted) {
+				addUnitTransition(current.lifted ? Lifted : Landed, unitID, 0);
+			}
+			it->second = current;
+		} else {
+			unitStates[unitID] = current;
+		}
+	}
+	resolvePendingTrainings(frame);
+
+	// forget units that are no longer accessible
+	std::map<int, UnitState>::iterator it = unitStates.begin();
+	while (it != unitStates.end()) {
+		if (it->second.frame != frame) {
+			unitStates.erase(it++);
+		} else {
+			++it;
+		}
+	}
+}
+
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setUnitTransitionMask(JNIEnv* env, jobject jObj, jint mask)
+{
+	unitTransitionMask = mask;
+}
+
+/*****************************************************************************************************************/
+// Static neutral units
+/*****************************************************************************************************************/
+
+/**
+* Collects the static neutral units of the match that has just started. Critters are left out, they move about.
+*/
+void buildStaticNeutrals(void)
+{
+	staticNeutrals.clear();
+	staticNeutralIndex.clear();
+	staticNeutralPlayerID = Broodwar->neutral()->getID();
+
+	// the static neutral units include the minerals and geysers, they are collected first to keep them together
+	const std::set<Unit*>* sources[] = {
+		&Broodwar->getStaticMinerals(), &Broodwar->getStaticGeysers(), &Broodwar->getStaticNeutralUnits()
+	};
+	for (int s = 0; s < 3; s++) {
+		for (std::set<Unit*>::const_iterator i = sources[s]->begin(); i != sources[s]->end(); ++i) {
+			Unit* unit = *i;
+			int unitID = unit->getID();
+			if (unitID < 0 || unit->getInitialType().canMove()) {
+				continue;
+			}
+			if (unitID >= (int)staticNeutralIndex.size()) {
+				staticNeutralIndex.resize(unitID + 1, -1);
+			}
+			if (staticNeutralIndex[unitID] < 0) {
+				StaticNeutral entry;
+				entry.unit = unit;
+				entry.typeID = unit->getInitialType().getID();
+				entry.sent = false;
+				staticNeutralIndex[unitID] = staticNeutrals.size();
+				staticNeutrals.push_back(entry);
+			}
+		}
+	}
+	staticNeutralRecords.assign(staticNeutrals.size() * unitRecordSize, 0);
+	BRIDGE_LOG(LogMatch, LogDebug, "%d static neutral units", (int)staticNeutrals.size());
+}
+
+/**
+* Returns true if the unit is a static neutral unit that is still neutral and of its initial type. A geyser
+* turned into a refinery is sent with the other units again.
+*/
+bool isStaticNeutral(Unit* unit, const UnitData& data)
+{
+	int unitID = unit->getID();
+	if (unitID < 0 || unitID >= (int)staticNeutralIndex.size() || staticNeutralIndex[unitID] < 0) {
+		return false;
+	}
+	return data.player == staticNeutralPlayerID && data.type == staticNeutrals[staticNeutralIndex[unitID]].typeID;
+}
+
+/**
+* Returns the changes of the static neutral units since the last call, laid out as
+*
+*   leftCount (unit ID)* changeCount (unit ID, slot, value)* record*
+*
+* Units that became inaccessible or left the partition come first, Java drops their records. The changed slots of
+* the records Java holds follow, grouped by unit, then the full records of units Java does not hold yet. The
+* first call of a match therefore sends every accessible static neutral unit.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getStaticNeutralUpdate(JNIEnv* env, jobject jObj)
+{
+	jint* intBuf = scratchBuffer(2 + staticNeutrals.size() * (1 + 4 * unitRecordSize));
+	int index = 1;
+
+	for (unsigned int n = 0; n < staticNeutrals.size(); n++) {
+		StaticNeutral& entry = staticNeutrals[n];
+		const UnitData& data = unitData(entry.unit);
+		if (entry.sent && !(data.exists && isStaticNeutral(entry.unit, data))) {
+			intBuf[index++] = entry.unit->getID();
+			entry.sent = false;
+		}
+	}
+	intBuf[0] = index - 1;
+
+	int changeCount = index++;
+	jint record[unitRecordSize];
+	for (unsigned int n = 0; n < staticNeutrals.size(); n++) {
+		StaticNeutral& entry = staticNeutrals[n];
+		if (!entry.sent) {
+			continue;
+		}
+		writeUnitRaw(record, 0, entry.unit, unitData(entry.unit));
+		jint* held = &staticNeutralRecords[n * unitRecordSize];
+		for (int slot = 0; slot < unitRecordSize; slot++) {
+			if (record[slot] != held[slot]) {
+				intBuf[index++] = record[0];
+				intBuf[index++] = slot;
+				intBuf[index++] = record[slot];
+				held[slot] = record[slot];
+			}
+		}
+	}
+	intBuf[changeCount] = (index - changeCount - 1) / 3;
+
+	for (unsigned int n = 0; n < staticNeutrals.size(); n++) {
+		StaticNeutral& entry = staticNeutrals[n];
+		const UnitData& data = unitData(entry.unit);
+		if (!entry.sent && data.exists && isStaticNeutral(entry.unit, data)) {
+			jint* held = &staticNeutralRecords[n * unitRecordSize];
+			writeUnitRaw(held, 0, entry.unit, data);
+			memcpy(&intBuf[index], held, unitRecordSize * sizeof(jint));
+			index += unitRecordSize;
+			entry.sent = true;
+		}
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+/*****************************************************************************************************************/
+// Effective stats
+/*****************************************************************************************************************/
+
+void computePlayerStats(Player* player, PlayerStats& stats)
+{
+	stats.unitStats.assign(BWAPI_UNIT_TYPE_MAX_COUNT * UnitStatCount, 0);
+	for (std::map<int, UnitType>::iterator i = unitTypeMap.begin(); i != unitTypeMap.end(); ++i) {
+		if (i->first < 0 || i->first >= BWAPI_UNIT_TYPE_MAX_COUNT) {
+			continue;
+		}
+		int* values = &stats.unitStats[i->first * UnitStatCount];
+		values[StatTopSpeed] = static_cast<int>(fixedScale * player->topSpeed(i->second));
+		values[StatSightRange] = player->sightRange(i->second);
+		values[StatGroundWeaponMaxRange] = player->groundWeaponMaxRange(i->second);
+		values[StatAirWeaponMaxRange] = player->airWeaponMaxRange(i->second);
+		values[StatArmor] = player->armor(i->second);
+		values[StatMaxEnergy] = player->maxEnergy(i->second);
+		values[StatGroundWeaponCooldown] = player->groundWeaponDamageCooldown(i->second);
+	}
+
+	int weaponCount = weaponTypeMap.empty() ? 0 : weaponTypeMap.rbegin()->first + 1;
+	stats.weaponStats.assign(weaponCount * WeaponStatCount, 0);
+	for (std::map<int, WeaponType>::iterator i = weaponTypeMap.begin(); i != weaponTypeMap.end(); ++i) {
+		if (i->first < 0) {
+			continue;
+		}
+		int* values = &stats.weaponStats[i->first * WeaponStatCount];
+		values[StatWeaponMaxRange] = player->weaponMaxRange(i->second);
+		values[StatWeaponDamage] = i->second.damageAmount()
+			+ i->second.damageBonus() * player->getUpgradeLevel(i->second.upgradeType());
+	}
+}
+
+/**
+* Recomputes the stats of the players whose upgrade levels or researched techs changed since the last frame.
+*/
+void updatePlayerStats(void)
+{
+	static std::vector<int> signature;
+	std::set<Player*>& players = Broodwar->getPlayers();
+	for (std::set<Player*>::iterator p = players.begin(); p != players.end(); ++p) {
+		signature.clear();
+		for (std::map<int, UpgradeType>::iterator i = upgradeTypeMap.begin(); i != upgradeTypeMap.end(); ++i) {
+			signature.push_back((*p)->getUpgradeLevel(i->second));
+		}
+		for (std::map<int, TechType>::iterator i = techTypeMap.begin(); i != techTypeMap.end(); ++i) {
+			signature.push_back((*p)->hasResearched(i->second) ? 1 : 0);
+		}
+
+		std::map<int, PlayerStats>::iterator entry = playerStats.find((*p)->getID());
+		if (entry == playerStats.end()) {
+			entry = playerStats.insert(std::make_pair((*p)->getID(), PlayerStats())).first;
+			entry->second.version = 0;
+		} else if (entry->second.signature == signature) {
+			continue;
+		} else {
+			entry->second.version++;
+		}
+		entry->second.signature = signature;
+		computePlayerStats(*p, entry->second);
+	}
+}
+
+/**
+* Returns (player ID, stats version) pairs. The version changes whenever the stats of the player are recomputed.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getPlayerStatsVersions(JNIEnv* env, jobject jObj)
+{
+	jint* intBuf = scratchBuffer(playerStats.size() * 2);
+	int index = 0;
+	for (std::map<int, PlayerStats>::iterator i = playerStats.begin(); i != playerStats.end(); ++i) {
+		intBuf[index++] = i->first;
+		intBuf[index++] = i->second.version;
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+/**
+* Returns the unit type count followed by the unit stats table, then the weapon type count followed by the
+* weapon stats table of the player.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getPlayerStats(JNIEnv* env, jobject jObj, jint playerID)
+{
+	int index = 0;
+	std::map<int, PlayerStats>::iterator entry = playerStats.find(playerID);
+	jint* intBuf = scratchBuffer(entry != playerStats.end()
+		? 2 + entry->second.unitStats.size() + entry->second.weaponStats.size() : 0);
+	if (entry != playerStats.end()) {
+		const PlayerStats& stats = entry->second;
+		intBuf[index++] = stats.unitStats.size() / UnitStatCount;
+		if (!stats.unitStats.empty()) {
+			memcpy(&intBuf[index], &stats.unitStats[0], stats.unitStats.size() * sizeof(jint));
+			index += stats.unitStats.size();
+		}
+		intBuf[index++] = stats.weaponStats.size() / WeaponStatCount;
+		if (!stats.weaponStats.empty()) {
+			memcpy(&intBuf[index], &stats.weaponStats[0], stats.weaponStats.size() * sizeof(jint));
+			index += stats.weaponStats.size();
+		}
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+/*****************************************************************************************************************/
+// Snapshot ring
+/*****************************************************************************************************************/
+
+// layout of the ring file in ints, must match com.harbinger.jbw.SnapshotReader
+const jint snapshotMagic = 0x4A425753; // "JBWS"
+const jint snapshotVersion = 1;
+const int snapshotHeaderSize = 16;
+const int snapshotLatestIndex = 6;
+const int snapshotSlotHeaderSize = 8;
+const int snapshotPlayerSize = 11;
+
+// largest ring mapped, a bigger view rarely fits the 2 GB address space of this 32 bit process
+const long long snapshotMaxBytes = 0x40000000;
+
+/**
+* Writes the players and units of the current frame into the next slot of the ring. The slot sequence is odd
+* while the slot is written, so a reader that sees the same even sequence before and after copying a slot has
+* a consistent frame. Units that do not fit the slot are left out.
+*/
+void publishSnapshot(void)
+{
+	if (snapshotRing == NULL) {
+		return;
+	}
+	const jint generation = ++snapshotGeneration;
+	jint* slot = snapshotRing + snapshotHeaderSize + ((generation - 1) % snapshotSlots) * snapshotSlotSize;
+	volatile jint* sequence = slot;
+	*sequence = *sequence + 1;
+	MemoryBarrier();
+
+	int index = snapshotSlotHeaderSize;
+	int playerCount = 0;
+	std::set<Player*>& players = Broodwar->getPlayers();
+	for (std::set<Player*>::const_iterator i = players.begin(); i != players.end(); ++i) {
+		if (index + snapshotPlayerSize > snapshotSlotSize) {
+			break;
+		}
+		Player* p = *i;
+		slot[index++] = p->getID();
+		slot[index++] = p->minerals();
+		slot[index++] = p->gas();
+		slot[index++] = p->supplyUsed();
+		slot[index++] = p->supplyTotal();
+		slot[index++] = p->gatheredMinerals();
+		slot[index++] = p->gatheredGas();
+		slot[index++] = p->getUnitScore();
+		slot[index++] = p->getKillScore();
+		slot[index++] = p->getBuildingScore();
+		slot[index++] = p->getRazingScore();
+		playerCount++;
+	}
+	int unitCount = 0;
+	std::set<Unit*>& units = Broodwar->getAllUnits();
+	for (std::set<Unit*>::const_iterator i = units.begin(); i != units.end(); ++i) {
+		if (index + unitRecordSize > snapshotSlotSize) {
+			break;
+		}
+		index = writeUnitRaw(slot, index, *i, unitData(*i));
+		unitCount++;
+	}
+	slot[1] = generation;
+	slot[2] = Broodwar->getFrameCount();
+	slot[3] = playerCount;
+	slot[4] = unitCount;
+	slot[5] = static_cast<jint>(units.size());
+
+	MemoryBarrier();
+	*sequence = *sequence + 1;
+	MemoryBarrier();
+	*reinterpret_cast<volatile jint*>(snapshotRing + snapshotLatestIndex) = generation;
+}
+
+void closeSnapshotRing(void)
+{
+	if (snapshotRing != NULL) {
+		UnmapViewOfFile(snapshotRing);
+		snapshotRing = NULL;
+	}
+	if (snapshotMapping != NULL) {
+		CloseHandle(snapshotMapping);
+		snapshotMapping = NULL;
+	}
+	if (snapshotFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(snapshotFile);
+		snapshotFile = INVALID_HANDLE_VALUE;
+	}
+}
+
+/**
+* Creates the ring file and maps it, replacing any previous ring. Returns false if the file could not be created.
+*/
+JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_nativeOpenSnapshotRing(JNIEnv* env, jobject jObj, jstring path, jint slots, jint maxUnits)
+{
+	closeSnapshotRing();
+	if (slots < 1 || maxUnits < 0) {
+		return JNI_FALSE;
+	}
+	const long long slotSize = snapshotSlotHeaderSize + 12 * snapshotPlayerSize
+		+ static_cast<long long>(maxUnits) * unitRecordSize;
+	const long long bytes = (snapshotHeaderSize + slots * slotSize) * static_cast<long long>(sizeof(jint));
+	if (bytes > snapshotMaxBytes) {
+		return JNI_FALSE;
+	}
+	const DWORD size = static_cast<DWORD>(bytes);
+
+	const jchar* chars = env->GetStringChars(path, NULL);
+	std::wstring fileName(reinterpret_cast<const wchar_t*>(chars), env->GetStringLength(path));
+	env->ReleaseStringChars(path, chars);
+	snapshotFile = CreateFileW(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (snapshotFile != INVALID_HANDLE_VALUE) {
+		snapshotMapping = CreateFileMappingW(snapshotFile, NULL, PAGE_READWRITE, 0, size, NULL);
+	}
+	if (snapshotMapping != NULL) {
+		snapshotRing = static_cast<jint*>(MapViewOfFile(snapshotMapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+	}
+	if (snapshotRing == NULL) {
+		closeSnapshotRing();
+		return JNI_FALSE;
+	}
+
+	// a new file is zero filled, so every slot starts with an even sequence and no frame is published yet
+	snapshotSlots = slots;
+	snapshotSlotSize = static_cast<int>(slotSize);
+	snapshotGeneration = 0;
+	snapshotRing[0] = snapshotMagic;
+	snapshotRing[1] = snapshotVersion;
+	snapshotRing[2] = slots;
+	snapshotRing[3] = snapshotSlotSize;
+	snapshotRing[4] = unitRecordSize;
+	snapshotRing[5] = snapshotPlayerSize;
+	snapshotRing[snapshotLatestIndex] = 0;
+	return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeCloseSnapshotRing(JNIEnv* env, jobject jObj)
+{
+	closeSnapshotRing();
+}
+
+/*****************************************************************************************************************/
+// Unit queries
+/*****************************************************************************************************************/
+
+/**
+* Instructions of the unit query programs compiled by UnitQuery. An instruction is an opcode, optionally
+* combined with queryNegate, followed by its operands. A unit matches a query if all its instructions hold.
+*/
+enum UnitQueryOp {
+	QueryPlayer,         // player ID
+	QuerySelf,
+	QueryAlly,
+	QueryEnemy,
+	QueryNeutral,
+	QueryType,           // unit type ID
+	QueryFlying,
+	QueryBuilding,
+	QueryWorker,
+	QueryVisible,
+	QueryCompleted,
+	QueryIdle,
+	QueryCloaked,
+	QueryUnderAttack,
+	QueryWithin,         // x, y and radius in pixels
+	QueryHitPointsBelow, // percentage of the maximum hit points
+	QueryTypeIn,         // 256 bit mask of unit type IDs
+	QueryOpCount
+};
+const int queryNegate = 1 << 16;
+const int queryOperands[QueryOpCount] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 3, 1, 8 };
+
+bool isValidUnitQuery(const std::vector<int>& code)
+{
+	size_t pc = 0;
+	while (pc < code.size()) {
+		const int op = code[pc] & ~queryNegate;
+		if (op < 0 || op >= QueryOpCount) {
+			return false;
+		}
+		pc += 1 + queryOperands[op];
+	}
+	return pc == code.size();
+}
+
+bool matchesUnitQuery(const std::vector<int>& code, Unit* unit, Player* self)
+{
+	size_t pc = 0;
+	while (pc < code.size()) {
+		const int op = code[pc] & ~queryNegate;
+		const bool negate = (code[pc] & queryNegate) != 0;
+		const int* operands = &code[0] + pc + 1;
+		bool result = false;
+		switch (op) {
+			case QueryPlayer:
+				result = unit->getPlayer()->getID() == operands[0];
+				break;
+			case QuerySelf:
+				result = self != NULL && unit->getPlayer() == self;
+				break;
+			case QueryAlly:
+				result = self != NULL && unit->getPlayer() != self && self->isAlly(unit->getPlayer());
+				break;
+			case QueryEnemy:
+				result = self != NULL && self->isEnemy(unit->getPlayer());
+				break;
+			case QueryNeutral:
+				result = unit->getPlayer()->isNeutral();
+				break;
+			case QueryType:
+				result = unit->getType().getID() == operands[0];
+				break;
+			case QueryFlying:
+				result = unit->getType().isFlyer() || unit->isLifted();
+				break;
+			case QueryBuilding:
+				result = unit->getType().isBuilding();
+				break;
+			case QueryWorker:
+				result = unit->getType().isWorker();
+				break;
+			case QueryVisible:
+				result = unit->isVisible();
+				break;
+			case QueryCompleted:
+				result = unit->isCompleted();
+				break;
+			case QueryIdle:
+				result = unit->isIdle();
+				break;
+			case QueryCloaked:
+				result = unit->isCloaked();
+				break;
+			case QueryUnderAttack:
+				result = unit->isUnderAttack();
+				break;
+			case QueryWithin: {
+				const long long dx = unit->getPosition().x() - operands[0];
+				const long long dy = unit->getPosition().y() - operands[1];
+				const long long radius = operands[2];
+				result = dx * dx + dy * dy <= radius * radius;
+				break;
+			}
+			case QueryHitPointsBelow: {
+				const int maxHitPoints = unit->getType().maxHitPoints();
+				result = maxHitPoints > 0 && unit->getHitPoints() * 100 < operands[0] * maxHitPoints;
+				break;
+			}
+			case QueryTypeIn: {
+				const int typeID = unit->getType().getID();
+				result = typeID >= 0 && typeID < 256 && (operands[typeID >> 5] & (1 << (typeID & 31))) != 0;
+				break;
+			}
+		}
+		if (result == negate) {
+			return false;
+		}
+		pc += 1 + queryOperands[op];
+	}
+	return true;
+}
+
+/**
+* Evaluates a unit query on the last known state of a remembered enemy unit. A remembered unit is out of sight, so
+* it is neither visible, idle, cloaked nor under attack, and it counts as completed; lifted buildings are not flying.
+*/
+bool matchesRememberedUnit(const std::vector<int>& code, const EnemyRecord& record, Player* self)
+{
+	Player* player = Broodwar->getPlayer(record.playerID);
+	const UnitType type(record.typeID);
+	size_t pc = 0;
+	while (pc < code.size()) {
+		const int op = code[pc] & ~queryNegate;
+		const bool negate = (code[pc] & queryNegate) != 0;
+		const int* operands = &code[0] + pc + 1;
+		bool result = false;
+		switch (op) {
+			case QueryPlayer:
+				result = record.playerID == operands[0];
+				break;
+			case QuerySelf:
+				result = self != NULL && player == self;
+				break;
+			case QueryAlly:
+				result = self != NULL && player != NULL && player != self && self->isAlly(player);
+				break;
+			case QueryEnemy:
+				result = self != NULL && player != NULL && self->isEnemy(player);
+				break;
+			case QueryNeutral:
+				result = player != NULL && player->isNeutral();
+				break;
+			case QueryType:
+				result = record.typeID == operands[0];
+				break;
+			case QueryFlying:
+				result = type.isFlyer();
+				break;
+			case QueryBuilding:
+				result = record.building;
+				break;
+			case QueryWorker:
+				result = type.isWorker();
+				break;
+			case QueryCompleted:
+				result = true;
+				break;
+			case QueryWithin: {
+				const long long dx = record.x - operands[0];
+				const long long dy = record.y - operands[1];
+				const long long radius = operands[2];
+				result = dx * dx + dy * dy <= radius * radius;
+				break;
+			}
+			case QueryHitPointsBelow: {
+				const int maxHitPoints = type.maxHitPoints();
+				result = maxHitPoints > 0 && record.hitPoints * 100 < operands[0] * maxHitPoints;
+				break;
+			}
+			case QueryTypeIn:
+				result = record.typeID >= 0 && record.typeID < 256 && (operands[record.typeID >> 5] & (1 << (record.typeID & 31))) != 0;
+				break;
+			default:
+				break;
+		}
+		if (result == negate) {
+			return false;
+		}
+		pc += 1 + queryOperands[op];
+	}
+	return true;
+}
+
+/**
+* Compiles a unit query and returns its handle, or -1 if the program is malformed.
+*/
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_nativeAddUnitQuery(JNIEnv* env, jobject jObj, jintArray code)
+{
+	std::vector<int> program(env->GetArrayLength(code));
+	if (!program.empty()) {
+		env->GetIntArrayRegion(code, 0, program.size(), reinterpret_cast<jint*>(&program[0]));
+	}
+	if (!isValidUnitQuery(program)) {
+		return -1;
+	}
+	const int handle = nextUnitQuery++;
+	unitQueries[handle].swap(program);
+	return handle;
+}
+
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeRemoveUnitQuery(JNIEnv* env, jobject jObj, jint handle)
+{
+	unitQueries.erase(handle);
+}
+
+/**
+* Evaluates all unit queries in a single pass over the units.
+*
+* Returns (handle, match count, matching unit IDs...) for each query.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitQueryResults(JNIEnv* env, jobject jObj)
+{
+	// room for the handle, the match count and every unit of each query
+	std::set<Unit*>& units = Broodwar->getAllUnits();
+	const size_t stride = units.size() + 2;
+	jint* results = scratchBuffer(unitQueries.size() * stride);
+
+	size_t q = 0;
+	for (std::map<int, std::vector<int> >::iterator query = unitQueries.begin(); query != unitQueries.end(); ++query, ++q) {
+		results[q * stride] = query->first;
+		results[q * stride + 1] = 0;
+	}
+
+	Player* self = Broodwar->isReplay() ? NULL : Broodwar->self();
+	for (std::set<Unit*>::iterator i = units.begin(); i != units.end(); ++i) {
+		q = 0;
+		for (std::map<int, std::vector<int> >::iterator query = unitQueries.begin(); query != unitQueries.end(); ++query, ++q) {
+			if (matchesUnitQuery(query->second, *i, self)) {
+				jint* count = &results[q * stride + 1];
+				results[q * stride + 2 + (*count)++] = (*i)->getID();
+			}
+		}
+	}
+
+	// move the results of each query up against those of the previous one
+	int index = 0;
+	for (q = 0; q < unitQueries.size(); q++) {
+		const int length = 2 + results[q * stride + 1];
+		memmove(&results[index], &results[q * stride], length * sizeof(jint));
+		index += length;
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, results);
+	return result;
+}
+
+/*****************************************************************************************************************/
+// Geofences
+/*****************************************************************************************************************/
+
+// fence kinds and their parameters, must match com.harbinger.jbw.Geofence
+enum GeofenceKind {
+	FenceRegion,    // region index of the terrain analysis
+	FenceRectangle, // left, top, right and bottom in pixels, right and bottom exclusive
+	FenceCircle,    // x, y and radius in pixels
+	FenceKindCount
+};
+const int fenceParams = 4;
+
+// the build tiles of a cell of the spatial index of the rectangles and circles
+const int fenceCellTiles = 8;
+
+// region of the terrain analysis of each build tile, set by the agent from its map
+std::vector<int> tileRegions;
+
+// spatial index of the fences: by region for region fences, by cell for the others
+std::vector<std::vector<int> > regionFences;
+std::vector<std::vector<int> > cellFences;
+int fenceCellColumns = 0;
+
+// reused between units so the frame path does not allocate
+std::vector<int> fenceCandidates;
+std::vector<int> fenceInside;
+
+inline int tileRegionAt(int x, int y)
+{
+	const int tx = x / 32;
+	const int ty = y / 32;
+	if (x < 0 || y < 0 || tx >= Broodwar->mapWidth() || ty >= Broodwar->mapHeight()
+			|| tileRegions.size() != (size_t)(Broodwar->mapWidth() * Broodwar->mapHeight())) {
+		return -1;
+	}
+	return tileRegions[tx + Broodwar->mapWidth() * ty];
+}
+
+bool fenceContains(const Geofence& fence, int x, int y, int region)
+{
+	switch (fence.kind) {
+		case FenceRegion:
+			return region >= 0 && region == fence.params[0];
+		case FenceRectangle:
+			return x >= fence.params[0] && y >= fence.params[1] && x < fence.params[2] && y < fence.params[3];
+		case FenceCircle: {
+			const long long dx = x - fence.params[0];
+			const long long dy = y - fence.params[1];
+			const long long radius = fence.params[2];
+			return dx * dx + dy * dy <= radius * radius;
+		}
+	}
+	return false;
+}
+
+/**
+* Rebuilds the spatial index after fences were added or removed or the regions changed.
+*/
+void indexGeofences(void)
+{
+	regionFences.clear();
+	cellFences.clear();
+	fenceCellColumns = (Broodwar->mapWidth() + fenceCellTiles - 1) / fenceCellTiles;
+	const int rows = (Broodwar->mapHeight() + fenceCellTiles - 1) / fenceCellTiles;
+	cellFences.resize(fenceCellColumns * rows);
+
+	const int cellPixels = fenceCellTiles * 32;
+	for (std::map<int, Geofence>::const_iterator i = geofences.begin(); i != geofences.end(); ++i) {
+		const Geofence& fence = i->second;
+		if (fence.kind == FenceRegion) {
+			if (fence.params[0] >= (int)regionFences.size()) {
+				regionFences.resize(fence.params[0] + 1);
+			}
+			regionFences[fence.params[0]].push_back(i->first);
+			continue;
+		}
+
+		// the cells the bounding box of the fence overlaps
+		int left = fence.params[0];
+		int top = fence.params[1];
+		int right = fence.params[2] - 1;
+		int bottom = fence.params[3] - 1;
+		if (fence.kind == FenceCircle) {
+			left = fence.params[0] - fence.params[2];
+			top = fence.params[1] - fence.params[2];
+			right = fence.params[0] + fence.params[2];
+			bottom = fence.params[1] + fence.params[2];
+		}
+		const int firstColumn = std::max(0, left / cellPixels);
+		const int lastColumn = std::min(fenceCellColumns - 1, right / cellPixels);
+		const int firstRow = std::max(0, top / cellPixels);
+		const int lastRow = std::min(rows - 1, bottom / cellPixels);
+		for (int row = firstRow; row <= lastRow; row++) {
+			for (int column = firstColumn; column <= lastColumn; column++) {
+				cellFences[column + fenceCellColumns * row].push_back(i->first);
+			}
+		}
+	}
+}
+
+void clearGeofences(void)
+{
+	geofences.clear();
+	fencedUnits.clear();
+	fenceCrossings.clear();
+	tileRegions.clear();
+	regionFences.clear();
+	cellFences.clear();
+}
+
+void addFenceCandidates(const std::vector<int>& fences)
+{
+	fenceCandidates.insert(fenceCandidates.end(), fences.begin(), fences.end());
+}
+
+/**
+* Records the fences the accessible units entered or left since the last frame.
+*
+* Only units that moved, appeared or changed owner or type are tested again, and only against the fences of
+* their region and their cell of the spatial index and the fences they were in. A unit that appears inside a
+* fence enters it, and a unit that dies or is no longer accessible leaves the fences it was in.
+*/
+void updateGeofences(void)
+{
+	if (geofences.empty()) {
+		fencedUnits.clear();
+		fenceCrossings.clear();
+		return;
+	}
+
+	const int frame = Broodwar->getFrameCount();
+	Player* self = Broodwar->isReplay() ? NULL : Broodwar->self();
+	const int cellPixels = fenceCellTiles * 32;
+	const std::set<Unit*>& units = Broodwar->getAllUnits();
+	for (std::set<Unit*>::const_iterator i = units.begin(); i != units.end(); ++i) {
+		Unit* unit = *i;
+		const UnitData& data = unitData(unit);
+		FencedUnit& state = fencedUnits[unit->getID()];
+		const bool moved = state.frame < 0 || data.positionX != state.x || data.positionY != state.y
+			|| data.player != state.playerID || data.type != state.typeID;
+		state.frame = frame;
+		if (!moved) {
+			continue;
+		}
+		state.x = data.positionX;
+		state.y = data.positionY;
+		state.playerID = data.player;
+		state.typeID = data.type;
+
+		// the fences the unit could be in
+		const int region = tileRegionAt(state.x, state.y);
+		fenceCandidates.clear();
+		addFenceCandidates(state.inside);
+		if (region >= 0 && region < (int)regionFences.size()) {
+			addFenceCandidates(regionFences[region]);
+		}
+		const int column = state.x / cellPixels;
+		const int cell = column + fenceCellColumns * (state.y / cellPixels);
+		if (state.x >= 0 && state.y >= 0 && column < fenceCellColumns && cell < (int)cellFences.size()) {
+			addFenceCandidates(cellFences[cell]);
+		}
+		std::sort(fenceCandidates.begin(), fenceCandidates.end());
+		fenceCandidates.erase(std::unique(fenceCandidates.begin(), fenceCandidates.end()), fenceCandidates.end());
+
+		fenceInside.clear();
+		for (std::vector<int>::const_iterator c = fenceCandidates.begin(); c != fenceCandidates.end(); ++c) {
+			std::map<int, Geofence>::const_iterator fence = geofences.find(*c);
+			if (fence != geofences.end() && fenceContains(fence->second, state.x, state.y, region)
+					&& matchesUnitQuery(fence->second.filter, unit, self)) {
+				fenceInside.push_back(*c);
+			}
+		}
+
+		// both lists are sorted, so the crossings are their differences
+		std::vector<int>::const_iterator was = state.inside.begin();
+		std::vector<int>::const_iterator is = fenceInside.begin();
+		while (was != state.inside.end() || is != fenceInside.end()) {
+			if (is == fenceInside.end() || (was != state.inside.end() && *was < *is)) {
+				fenceCrossings.push_back(*was++);
+				fenceCrossings.push_back(unit->getID());
+				fenceCrossings.push_back(0);
+			} else if (was == state.inside.end() || *is < *was) {
+				fenceCrossings.push_back(*is++);
+				fenceCrossings.push_back(unit->getID());
+				fenceCrossings.push_back(1);
+			} else {
+				++was;
+				++is;
+			}
+		}
+		state.inside.swap(fenceInside);
+	}
+
+	// units that are no longer accessible leave their fences, so every enter is followed by a leave
+	std::map<int, FencedUnit>::iterator it = fencedUnits.begin();
+	while (it != fencedUnits.end()) {
+		if (it->second.frame != frame) {
+			const std::vector<int>& inside = it->second.inside;
+			for (std::vector<int>::const_iterator fence = inside.begin(); fence != inside.end(); ++fence) {
+				fenceCrossings.push_back(*fence);
+				fenceCrossings.push_back(it->first);
+				fenceCrossings.push_back(0);
+			}
+			fencedUnits.erase(it++);
+		} else {
+			++it;
+		}
+	}
 }
 
-JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getUnitSizeTypeName(JNIEnv* env, jobject jObj, jint sizeID)
+/**
+* Sets the region of the terrain analysis of each build tile, row by row, which region fences are tested with.
+*/
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setTileRegions(JNIEnv* env, jobject jObj, jintArray regions)
 {
-	return env->NewStringUTF(unitSizeTypeMap[sizeID].getName().c_str());
+	tileRegions.resize(env->GetArrayLength(regions));
+	if (!tileRegions.empty()) {
+		env->GetIntArrayRegion(regions, 0, tileRegions.size(), reinterpret_cast<jint*>(&tileRegions[0]));
+	}
+	// test the units again, keeping the fences they are in so they leave them if they are no longer inside
+	for (std::map<int, FencedUnit>::iterator i = fencedUnits.begin(); i != fencedUnits.end(); ++i) {
+		i->second.frame = -1;
+	}
 }
 
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getBulletTypes(JNIEnv* env, jobject jObj)
+/**
+* Adds a geofence described as its kind, fenceParams parameters and a unit query program, and returns its handle,
+* or -1 if the description is malformed.
+*/
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_nativeAddGeofence(JNIEnv* env, jobject jObj, jintArray description)
 {
-	int index = 0;
-
-	std::set<BulletType> bulletTypes = BulletTypes::allBulletTypes();
-	for (std::set<BulletType>::iterator i = bulletTypes.begin(); i != bulletTypes.end(); ++i) {
-		intBuf[index++] = i->getID();
+	std::vector<int> code(env->GetArrayLength(description));
+	if (!code.empty()) {
+		env->GetIntArrayRegion(description, 0, code.size(), reinterpret_cast<jint*>(&code[0]));
+	}
+	if (code.size() < 1 + fenceParams || code[0] < 0 || code[0] >= FenceKindCount
+			|| (code[0] == FenceRegion && code[1] < 0)) {
+		return -1;
+	}
+	Geofence fence;
+	fence.kind = code[0];
+	for (int i = 0; i < fenceParams; i++) {
+		fence.params[i] = code[1 + i];
+	}
+	fence.filter.assign(code.begin() + 1 + fenceParams, code.end());
+	if (!isValidUnitQuery(fence.filter)) {
+		return -1;
 	}
 
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
+	const int handle = nextGeofence++;
+	geofences[handle] = fence;
+	indexGeofences();
+	// units are tested against the new fence when they next move, or now
+	for (std::map<int, FencedUnit>::iterator i = fencedUnits.begin(); i != fencedUnits.end(); ++i) {
+		i->second.frame = -1;
+	}
+	return handle;
 }
 
-JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getBulletTypeName(JNIEnv* env, jobject jObj, jint bulletID)
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeRemoveGeofence(JNIEnv* env, jobject jObj, jint handle)
 {
-	return env->NewStringUTF(bulletTypeMap[bulletID].getName().c_str());
+	if (geofences.erase(handle) == 0) {
+		return;
+	}
+	indexGeofences();
+	for (std::map<int, FencedUnit>::iterator i = fencedUnits.begin(); i != fencedUnits.end(); ++i) {
+		std::vector<int>& inside = i->second.inside;
+		inside.erase(std::remove(inside.begin(), inside.end(), handle), inside.end());
+	}
 }
 
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getDamageTypes(JNIEnv* env, jobject jObj)
+/**
+* Returns the fence crossings since the last call as (handle, unit ID, entered) triples, entered being 1 when
+* the unit entered the fence and 0 when it left.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getGeofenceCrossings(JNIEnv* env, jobject jObj)
 {
-	int index = 0;
-
-	std::set<DamageType> damageTypes = DamageTypes::allDamageTypes();
-	for (std::set<DamageType>::iterator i = damageTypes.begin(); i != damageTypes.end(); ++i) {
-		intBuf[index++] = i->getID();
+	int size = fenceCrossings.size();
+	jintArray result = env->NewIntArray(size);
+	if (size > 0) {
+		env->SetIntArrayRegion(result, 0, size, reinterpret_cast<const jint*>(&fenceCrossings[0]));
 	}
-
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
+	fenceCrossings.clear();
 	return result;
 }
 
-JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getDamageTypeName(JNIEnv* env, jobject jObj, jint damageID)
-{
-	return env->NewStringUTF(damageTypeMap[damageID].getName().c_str());
-}
-
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getExplosionTypes(JNIEnv* env, jobject jObj)
-{
-	int index = 0;
-
-	std::set<ExplosionType> explosionTypes = ExplosionTypes::allExplosionTypes();
-	for (std::set<ExplosionType>::iterator i = explosionTypes.begin(); i != explosionTypes.end(); ++i) {
-		intBuf[index++] = i->getID();
-	}
+/*****************************************************************************************************************/
+// Feature planes
+/*****************************************************************************************************************/
 
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
-}
+/**
+* Channels of the feature planes compiled by FeaturePlanes. Unit channels are followed by the unit query
+* selecting the units they count.
+*/
+enum FeatureChannel {
+	FeatureUnitCount,
+	FeatureHitPoints,
+	FeatureGroundThreat,
+	FeatureAirThreat,
+	FeatureVisible,
+	FeatureCreep,
+	FeatureWalkable,
+	FeatureHeight,
+	FeatureChannelCount
+};
 
-JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getExplosionTypeName(JNIEnv* env, jobject jObj, jint explosionID)
+inline bool isUnitFeature(int kind)
 {
-	return env->NewStringUTF(explosionTypeMap[explosionID].getName().c_str());
+	return kind <= FeatureAirThreat;
 }
 
-JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getUnitCommandTypeName(JNIEnv* env, jobject jObj, jint unitCommandID)
+inline int floorDiv(int a, int b)
 {
-	return env->NewStringUTF(unitCommandTypeMap[unitCommandID].getName().c_str());
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
 }
 
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitCommandTypes(JNIEnv* env, jobject jObj)
+/**
+* Adds value to row[begin] through row[end].
+*/
+void addSpan(float* row, int begin, int end, float value)
 {
-	int index = 0;
-
-	std::set<UnitCommandType> unitCommandTypes = UnitCommandTypes::allUnitCommandTypes();
-	for (std::set<UnitCommandType>::iterator i = unitCommandTypes.begin(); i != unitCommandTypes.end(); ++i) {
-		intBuf[index++] = i->getID();
+	int i = begin;
+#ifdef USE_SSE2
+	const __m128 v = _mm_set1_ps(value);
+	for (; i + 3 <= end; i += 4) {
+		_mm_storeu_ps(row + i, _mm_add_ps(_mm_loadu_ps(row + i), v));
+	}
+#endif
+	for (; i <= end; i++) {
+		row[i] += value;
 	}
-
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
 }
 
-JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getOrderTypeName(JNIEnv* env, jobject jObj, jint unitCommandID)
+/**
+* Multiplies each value of plane by the value of factors at the same index.
+*/
+void multiplyPlane(float* plane, const float* factors, int count)
 {
-	return env->NewStringUTF(orderTypeMap[unitCommandID].getName().c_str());
+	int i = 0;
+#ifdef USE_SSE2
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(plane + i, _mm_mul_ps(_mm_loadu_ps(plane + i), _mm_loadu_ps(factors + i)));
+	}
+#endif
+	for (; i < count; i++) {
+		plane[i] *= factors[i];
+	}
 }
 
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getOrderTypes(JNIEnv* env, jobject jObj)
-{
-	int index = 0;
+/**
+* Adds value to the cells whose centers are within range pixels of (x, y), widened by half a cell so that
+* small ranges still cover the cell of the unit.
+*/
+void addDisc(float* plane, int width, int height, int cellPixels, int x, int y, int range, float value)
+{
+	const int half = cellPixels / 2;
+	const int reach = range + half;
+	const int firstRow = std::max(0, -floorDiv(-(y - reach - half), cellPixels));
+	const int lastRow = std::min(height - 1, floorDiv(y + reach - half, cellPixels));
+	for (int row = firstRow; row <= lastRow; row++) {
+		const long long dy = row * cellPixels + half - y;
+		const long long remaining = static_cast<long long>(reach) * reach - dy * dy;
+		if (remaining < 0) {
+			continue;
+		}
+		const int dx = static_cast<int>(sqrt(static_cast<double>(remaining)));
+		const int first = std::max(0, -floorDiv(-(x - dx - half), cellPixels));
+		const int last = std::min(width - 1, floorDiv(x + dx - half, cellPixels));
+		if (first <= last) {
+			addSpan(plane + row * width, first, last, value);
+		}
+	}
+}
 
-	std::set<Order> orders = Orders::allOrders();
-	for (std::set<Order>::iterator i = orders.begin(); i != orders.end(); ++i) {
-		intBuf[index++] = i->getID();
+/**
+* Computes the channels of a feature plane set that only depend on the map.
+*/
+void buildStaticPlanes(FeaturePlaneSet& set, int width, int height)
+{
+	const int cells = width * height;
+	set.staticPlanes.assign(cells * set.kinds.size(), 0.0f);
+	set.inverseTiles.assign(cells, 0.0f);
+	for (int ty = 0; ty < Broodwar->mapHeight(); ty++) {
+		for (int tx = 0; tx < Broodwar->mapWidth(); tx++) {
+			set.inverseTiles[(ty / set.cellSize) * width + tx / set.cellSize] += 1.0f;
+		}
+	}
+	for (int i = 0; i < cells; i++) {
+		set.inverseTiles[i] = 1.0f / set.inverseTiles[i];
 	}
 
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
+	for (size_t c = 0; c < set.kinds.size(); c++) {
+		float* plane = &set.staticPlanes[c * cells];
+		if (set.kinds[c] == FeatureWalkable) {
+			for (int wy = 0; wy < Broodwar->mapHeight() * 4; wy++) {
+				for (int wx = 0; wx < Broodwar->mapWidth() * 4; wx++) {
+					if (Broodwar->isWalkable(wx, wy)) {
+						// a walk tile is a sixteenth of a build tile
+						plane[(wy / 4 / set.cellSize) * width + wx / 4 / set.cellSize] += 1.0f / 16;
+					}
+				}
+			}
+			multiplyPlane(plane, &set.inverseTiles[0], cells);
+		}
+		else if (set.kinds[c] == FeatureHeight) {
+			for (int ty = 0; ty < Broodwar->mapHeight(); ty++) {
+				for (int tx = 0; tx < Broodwar->mapWidth(); tx++) {
+					plane[(ty / set.cellSize) * width + tx / set.cellSize] += static_cast<float>(Broodwar->getGroundHeight(tx, ty));
+				}
+			}
+			multiplyPlane(plane, &set.inverseTiles[0], cells);
+		}
+	}
 }
 
 /**
-* Returns the list of active units in the game.
-*
-* Each unit takes up a fixed number of integer values. Currently: 123
+* Adds a unit of the given type, owner stats, position and hit points plus shields to a unit channel.
 */
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getAllUnitsData(JNIEnv* env, jobject jObj)
+void scatterUnit(float* plane, int kind, int width, int height, int cellPixels, UnitType type, const PlayerStats* stats,
+	int x, int y, int hitPoints)
 {
-	int index = 0;
-
-	std::set<Unit*> units = Broodwar->getAllUnits();
-	for (std::set<Unit*>::iterator i = units.begin(); i != units.end(); ++i) {
-		intBuf[index++] = (*i)->getID();
-		intBuf[index++] = (*i)->getReplayID();
-		intBuf[index++] = (*i)->getPlayer()->getID();
-		intBuf[index++] = (*i)->getType().getID();
-		intBuf[index++] = (*i)->getPosition().x();
-		intBuf[index++] = (*i)->getPosition().y();
-		intBuf[index++] = (*i)->getTilePosition().x();
-		intBuf[index++] = (*i)->getTilePosition().y();
-		intBuf[index++] = static_cast<int>(TO_DEGREES * (*i)->getAngle());
-		intBuf[index++] = static_cast<int>(fixedScale * (*i)->getVelocityX());
-		intBuf[index++] = static_cast<int>(fixedScale * (*i)->getVelocityY());
-		intBuf[index++] = (*i)->getHitPoints();
-		intBuf[index++] = (*i)->getShields();
-		intBuf[index++] = (*i)->getEnergy();
-		intBuf[index++] = (*i)->getResources();
-		intBuf[index++] = (*i)->getResourceGroup();
-		intBuf[index++] = (*i)->getLastCommandFrame();
-		intBuf[index++] = (*i)->getLastCommand().getType().getID();
-		// getLastAttackingPlayer doesn't work as documented, have to check for "None" player
-		intBuf[index++] = ((*i)->getLastAttackingPlayer() != NULL
-			&& (*i)->getLastAttackingPlayer()->getType() != PlayerTypes::None)
-			? (*i)->getLastAttackingPlayer()->getID() : -1;
-		intBuf[index++] = (*i)->getInitialType().getID();
-		intBuf[index++] = (*i)->getInitialPosition().x();
-		intBuf[index++] = (*i)->getInitialPosition().y();
-		intBuf[index++] = (*i)->getInitialTilePosition().x();
-		intBuf[index++] = (*i)->getInitialTilePosition().y();
-		intBuf[index++] = (*i)->getInitialHitPoints();
-		intBuf[index++] = (*i)->getInitialResources();
-		intBuf[index++] = (*i)->getKillCount();
-		intBuf[index++] = (*i)->getAcidSporeCount();
-		intBuf[index++] = (*i)->getInterceptorCount();
-		intBuf[index++] = (*i)->getScarabCount();
-		intBuf[index++] = (*i)->getSpiderMineCount();
-		intBuf[index++] = (*i)->getGroundWeaponCooldown();
-		intBuf[index++] = (*i)->getAirWeaponCooldown();
-		intBuf[index++] = (*i)->getSpellCooldown();
-		intBuf[index++] = (*i)->getDefenseMatrixPoints();
-		intBuf[index++] = (*i)->getDefenseMatrixTimer();
-		intBuf[index++] = (*i)->getEnsnareTimer();
-		intBuf[index++] = (*i)->getIrradiateTimer();
-		intBuf[index++] = (*i)->getLockdownTimer();
-		intBuf[index++] = (*i)->getMaelstromTimer();
-		intBuf[index++] = (*i)->getOrderTimer();
-		intBuf[index++] = (*i)->getPlagueTimer();
-		intBuf[index++] = (*i)->getRemoveTimer();
-		intBuf[index++] = (*i)->getStasisTimer();
-		intBuf[index++] = (*i)->getStimTimer();
-		intBuf[index++] = (*i)->getBuildType().getID();
-		intBuf[index++] = (*i)->getTrainingQueue().size();
-		intBuf[index++] = (*i)->getTech().getID();
-		intBuf[index++] = (*i)->getUpgrade().getID();
-		intBuf[index++] = (*i)->getRemainingBuildTime();
-		intBuf[index++] = (*i)->getRemainingTrainTime();
-		intBuf[index++] = (*i)->getRemainingResearchTime();
-		intBuf[index++] = (*i)->getRemainingUpgradeTime();
-		intBuf[index++] = ((*i)->getBuildUnit() != NULL) ? (*i)->getBuildUnit()->getID() : -1;
-		intBuf[index++] = ((*i)->getTarget() != NULL) ? (*i)->getTarget()->getID() : -1;
-		intBuf[index++] = (*i)->getTargetPosition().x();
-		intBuf[index++] = (*i)->getTargetPosition().y();
-		intBuf[index++] = (*i)->getOrder().getID();
-		intBuf[index++] = ((*i)->getOrderTarget() != NULL) ? (*i)->getOrderTarget()->getID() : -1;
-		intBuf[index++] = (*i)->getSecondaryOrder().getID();
-		intBuf[index++] = (*i)->getRallyPosition().x();
-		intBuf[index++] = (*i)->getRallyPosition().y();
-		intBuf[index++] = ((*i)->getRallyUnit() != NULL) ? (*i)->getRallyUnit()->getID() : -1;
-		intBuf[index++] = ((*i)->getAddon() != NULL) ? (*i)->getAddon()->getID() : -1;
-		intBuf[index++] = ((*i)->getNydusExit() != NULL) ? (*i)->getNydusExit()->getID() : -1;
-		intBuf[index++] = ((*i)->getTransport() != NULL) ? (*i)->getTransport()->getID() : -1;
-		intBuf[index++] = (*i)->getLoadedUnits().size(); // see separate getLoadedUnits method
-		intBuf[index++] = ((*i)->getCarrier() != NULL) ? (*i)->getCarrier()->getID() : -1;
-		// see getInterceptorCount and separate getInterceptors method
-		intBuf[index++] = ((*i)->getHatchery() != NULL) ? (*i)->getHatchery()->getID() : -1;
-		intBuf[index++] = (*i)->getLarva().size(); // see separate getLarva method
-		intBuf[index++] = ((*i)->getPowerUp() != NULL) ? (*i)->getPowerUp()->getID() : -1;
-		intBuf[index++] = (*i)->exists() ? 1 : 0;
-		intBuf[index++] = (*i)->hasNuke() ? 1 : 0;
-		intBuf[index++] = (*i)->isAccelerating() ? 1 : 0;
-		intBuf[index++] = (*i)->isAttacking() ? 1 : 0;
-		intBuf[index++] = (*i)->isAttackFrame() ? 1 : 0;
-		intBuf[index++] = (*i)->isBeingConstructed() ? 1 : 0;
-		intBuf[index++] = (*i)->isBeingGathered() ? 1 : 0;
-		intBuf[index++] = (*i)->isBeingHealed() ? 1 : 0;
-		intBuf[index++] = (*i)->isBlind() ? 1 : 0;
-		intBuf[index++] = (*i)->isBraking() ? 1 : 0;
-		intBuf[index++] = (*i)->isBurrowed() ? 1 : 0;
-		intBuf[index++] = (*i)->isCarryingGas() ? 1 : 0;
-		intBuf[index++] = (*i)->isCarryingMinerals() ? 1 : 0;
-		intBuf[index++] = (*i)->isCloaked() ? 1 : 0;
-		intBuf[index++] = (*i)->isCompleted() ? 1 : 0;
-		intBuf[index++] = (*i)->isConstructing() ? 1 : 0;
-		intBuf[index++] = (*i)->isDefenseMatrixed() ? 1 : 0;
-		intBuf[index++] = (*i)->isDetected() ? 1 : 0;
-		intBuf[index++] = (*i)->isEnsnared() ? 1 : 0;
-		intBuf[index++] = (*i)->isFollowing() ? 1 : 0;
-		intBuf[index++] = (*i)->isGatheringGas() ? 1 : 0;
-		intBuf[index++] = (*i)->isGatheringMinerals() ? 1 : 0;
-		intBuf[index++] = (*i)->isHallucination() ? 1 : 0;
-		intBuf[index++] = (*i)->isHoldingPosition() ? 1 : 0;
-		intBuf[index++] = (*i)->isIdle() ? 1 : 0;
-		intBuf[index++] = (*i)->isInterruptible() ? 1 : 0;
-		intBuf[index++] = (*i)->isInvincible() ? 1 : 0;
-		intBuf[index++] = (*i)->isIrradiated() ? 1 : 0;
-		intBuf[index++] = (*i)->isLifted() ? 1 : 0;
-		intBuf[index++] = (*i)->isLoaded() ? 1 : 0;
-		intBuf[index++] = (*i)->isLockedDown() ? 1 : 0;
-		intBuf[index++] = (*i)->isMaelstrommed() ? 1 : 0;
-		intBuf[index++] = (*i)->isMorphing() ? 1 : 0;
-		intBuf[index++] = (*i)->isMoving() ? 1 : 0;
-		intBuf[index++] = (*i)->isParasited() ? 1 : 0;
-		intBuf[index++] = (*i)->isPatrolling() ? 1 : 0;
-		intBuf[index++] = (*i)->isPlagued() ? 1 : 0;
-		intBuf[index++] = (*i)->isRepairing() ? 1 : 0;
-		intBuf[index++] = (*i)->isSelected() ? 1 : 0;
-		intBuf[index++] = (*i)->isSieged() ? 1 : 0;
-		intBuf[index++] = (*i)->isStartingAttack() ? 1 : 0;
-		intBuf[index++] = (*i)->isStasised() ? 1 : 0;
-		intBuf[index++] = (*i)->isStimmed() ? 1 : 0;
-		intBuf[index++] = (*i)->isStuck() ? 1 : 0;
-		intBuf[index++] = (*i)->isTraining() ? 1 : 0;
-		intBuf[index++] = (*i)->isUnderAttack() ? 1 : 0;
-		intBuf[index++] = (*i)->isUnderDarkSwarm() ? 1 : 0;
-		intBuf[index++] = (*i)->isUnderDisruptionWeb() ? 1 : 0;
-		intBuf[index++] = (*i)->isUnderStorm() ? 1 : 0;
-		intBuf[index++] = (*i)->isUnpowered() ? 1 : 0;
-		intBuf[index++] = (*i)->isUpgrading() ? 1 : 0;
-		intBuf[index++] = (*i)->isVisible() ? 1 : 0;
+	if (kind == FeatureUnitCount || kind == FeatureHitPoints) {
+		const int cell = std::min(height - 1, std::max(0, y / cellPixels)) * width + std::min(width - 1, std::max(0, x / cellPixels));
+		plane[cell] += (kind == FeatureUnitCount) ? 1.0f : static_cast<float>(hitPoints);
+		return;
 	}
-
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
+	const WeaponType weapon = (kind == FeatureGroundThreat) ? type.groundWeapon() : type.airWeapon();
+	const int weaponID = weapon.getID();
+	if (weapon == WeaponTypes::None || weapon == WeaponTypes::Unknown || stats == NULL
+			|| weaponID < 0 || (weaponID + 1) * WeaponStatCount > (int)stats->weaponStats.size()) {
+		return;
+	}
+	const int* weaponStats = &stats->weaponStats[weaponID * WeaponStatCount];
+	const float damage = static_cast<float>(weaponStats[StatWeaponDamage] * weapon.damageFactor());
+	addDisc(plane, width, height, cellPixels, x, y, weaponStats[StatWeaponMaxRange], damage);
 }
 
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getLoadedUnits(JNIEnv* env, jobject, jint unitID)
+const PlayerStats* findPlayerStats(int playerID)
 {
-	int index = 0;
+	std::map<int, PlayerStats>::const_iterator entry = playerStats.find(playerID);
+	return (entry != playerStats.end()) ? &entry->second : NULL;
+}
 
-	Unit* unit = Broodwar->getUnit(unitID);
-	if (unit != NULL) {
-		std::set<Unit*> loaded = unit->getLoadedUnits();
-		for (std::set<Unit*>::const_iterator it = loaded.begin(); it != loaded.end(); it++){
-			intBuf[index++] = (*it)->getID();
+/**
+* Writes the channels of a feature plane set into its buffer. Skips sets whose buffer is too small for the map,
+* which is logged once per match. Remembered enemy units are scattered at their last known position with their last
+* known hit points, unless they are still accessible, for example with complete map information.
+*/
+void buildFeaturePlanes(FeaturePlaneSet& set, Player* self)
+{
+	const int width = (Broodwar->mapWidth() + set.cellSize - 1) / set.cellSize;
+	const int height = (Broodwar->mapHeight() + set.cellSize - 1) / set.cellSize;
+	const int cells = width * height;
+	const int cellPixels = set.cellSize * TILE_SIZE;
+	if (static_cast<jlong>(cells) * set.kinds.size() > set.capacity) {
+		if (!set.reportedTooSmall) {
+			BRIDGE_LOG(LogMap, LogWarning, "Feature plane buffer holds %ld floats, %dx%d cells of %u channels need %ld",
+				static_cast<long>(set.capacity), width, height, set.kinds.size(),
+				static_cast<long>(cells * set.kinds.size()));
+			set.reportedTooSmall = true;
+		}
+		return;
+	}
+	if (set.staticPlanes.size() != cells * set.kinds.size()) {
+		buildStaticPlanes(set, width, height);
+	}
+	memcpy(set.data, &set.staticPlanes[0], cells * set.kinds.size() * sizeof(float));
+
+	bool unitChannels = false;
+	for (size_t c = 0; c < set.kinds.size(); c++) {
+		float* plane = set.data + c * cells;
+		switch (set.kinds[c]) {
+			case FeatureVisible:
+			case FeatureCreep: {
+				const bool visible = set.kinds[c] == FeatureVisible;
+				for (int ty = 0; ty < Broodwar->mapHeight(); ty++) {
+					float* row = plane + (ty / set.cellSize) * width;
+					for (int tx = 0; tx < Broodwar->mapWidth(); tx++) {
+						if (visible ? Broodwar->isVisible(tx, ty) : Broodwar->hasCreep(tx, ty)) {
+							row[tx / set.cellSize] += 1.0f;
+						}
+					}
+				}
+				multiplyPlane(plane, &set.inverseTiles[0], cells);
+				break;
+			}
+			default:
+				unitChannels |= isUnitFeature(set.kinds[c]);
+				break;
 		}
 	}
+	if (!unitChannels) {
+		return;
+	}
 
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
-}
+	// scatter the units into the unit channels in a single pass, with the upgrade aware weapon stats of their owners
+	Player* statsPlayer = NULL;
+	const PlayerStats* stats = NULL;
+	std::set<Unit*>& units = Broodwar->getAllUnits();
+	for (std::set<Unit*>::const_iterator i = units.begin(); i != units.end(); ++i) {
+		Unit* unit = *i;
+		if (unit->getPlayer() != statsPlayer) {
+			statsPlayer = unit->getPlayer();
+			stats = findPlayerStats(statsPlayer->getID());
+		}
+		for (size_t c = 0; c < set.kinds.size(); c++) {
+			const int kind = set.kinds[c];
+			if (isUnitFeature(kind) && matchesUnitQuery(set.filters[c], unit, self)) {
+				scatterUnit(set.data + c * cells, kind, width, height, cellPixels, unit->getType(), stats,
+					unit->getPosition().x(), unit->getPosition().y(), unit->getHitPoints() + unit->getShields());
+			}
+		}
+	}
 
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getInterceptors(JNIEnv* env, jobject, jint unitID)
-{
-	int index = 0;
+	if (!set.rememberedEnemies) {
+		return;
+	}
+	for (std::map<int, EnemyRecord>::const_iterator i = enemyMemory.begin(); i != enemyMemory.end(); ++i) {
+		const EnemyRecord& record = i->second;
+		Unit* unit = Broodwar->getUnit(i->first);
+		if (record.visible || (unit != NULL && unit->exists())) {
+			continue;
+		}
+		stats = findPlayerStats(record.playerID);
+		for (size_t c = 0; c < set.kinds.size(); c++) {
+			const int kind = set.kinds[c];
+			if (isUnitFeature(kind) && matchesRememberedUnit(set.filters[c], record, self)) {
+				scatterUnit(set.data + c * cells, kind, width, height, cellPixels, UnitType(record.typeID), stats,
+					record.x, record.y, record.hitPoints + record.shields);
+			}
+		}
+	}
+}
 
-	Unit* unit = Broodwar->getUnit(unitID);
-	if (unit != NULL) {
-		std::set<Unit*> loaded = unit->getInterceptors();
-		for (std::set<Unit*>::const_iterator it = loaded.begin(); it != loaded.end(); it++){
-			intBuf[index++] = (*it)->getID();
+/**
+* Compiles a feature plane set writing into a direct float buffer and returns its handle, or -1 if the
+* description is malformed or the buffer is not direct.
+*/
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_nativeAddFeaturePlanes(JNIEnv* env, jobject jObj, jintArray description, jobject buffer)
+{
+	std::vector<int> code(env->GetArrayLength(description));
+	if (code.size() < 3) {
+		return -1;
+	}
+	env->GetIntArrayRegion(description, 0, code.size(), reinterpret_cast<jint*>(&code[0]));
+
+	FeaturePlaneSet set;
+	set.cellSize = code[0];
+	set.rememberedEnemies = (code[1] & featureRememberedEnemies) != 0;
+	set.data = static_cast<float*>(env->GetDirectBufferAddress(buffer));
+	set.capacity = env->GetDirectBufferCapacity(buffer);
+	set.reportedTooSmall = false;
+	if (set.cellSize < 1 || code[2] < 1 || set.data == NULL || set.capacity < 0) {
+		return -1;
+	}
+	size_t pc = 3;
+	for (int c = 0; c < code[2]; c++) {
+		if (pc + 2 > code.size() || code[pc] < 0 || code[pc] >= FeatureChannelCount) {
+			return -1;
+		}
+		const int kind = code[pc];
+		const size_t length = code[pc + 1];
+		if (pc + 2 + length > code.size()) {
+			return -1;
 		}
+		std::vector<int> filter(code.begin() + pc + 2, code.begin() + pc + 2 + length);
+		if (!isValidUnitQuery(filter)) {
+			return -1;
+		}
+		set.kinds.push_back(kind);
+		set.filters.push_back(filter);
+		pc += 2 + length;
+	}
+	if (pc != code.size()) {
+		return -1;
 	}
 
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
+	set.buffer = env->NewGlobalRef(buffer);
+	const int handle = nextFeaturePlaneSet++;
+	featurePlaneSets[handle] = set;
+	return handle;
 }
 
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getLarva(JNIEnv* env, jobject, jint unitID)
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeRemoveFeaturePlanes(JNIEnv* env, jobject jObj, jint handle)
 {
-	int index = 0;
-
-	Unit* unit = Broodwar->getUnit(unitID);
-	if (unit != NULL) {
-		std::set<Unit*> loaded = unit->getLarva();
-		for (std::set<Unit*>::const_iterator it = loaded.begin(); it != loaded.end(); it++){
-			intBuf[index++] = (*it)->getID();
-		}
+	std::map<int, FeaturePlaneSet>::iterator set = featurePlaneSets.find(handle);
+	if (set != featurePlaneSets.end()) {
+		env->DeleteGlobalRef(set->second.buffer);
+		featurePlaneSets.erase(set);
 	}
-
-	jintArray result = env->NewIntArray(index);
-	env->SetIntArrayRegion(result, 0, index, intBuf);
-	return result;
 }
 
-JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_isVisibleToPlayer(JNIEnv* env, jobject jObj, jint unitID, jint playerID)
+/**
+* Writes all feature plane sets into their buffers.
+*/
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_buildFeaturePlanes(JNIEnv* env, jobject jObj)
 {
-	Unit* u = Broodwar->getUnit(unitID);
-	Player* p = Broodwar->getPlayer(playerID);
-	if (u != NULL && p != NULL)
-	{
-		return u->isVisible(p);
+	Player* self = Broodwar->isReplay() ? NULL : Broodwar->self();
+	for (std::map<int, FeaturePlaneSet>::iterator set = featurePlaneSets.begin(); set != featurePlaneSets.end(); ++set) {
+		buildFeaturePlanes(set->second, self);
 	}
-	return false;
 }
 
 /*****************************************************************************************************************/
@@ -978,6 +3062,11 @@ JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getMapFileName(JNIEnv*
 	return env->NewStringUTF(Broodwar->mapFileName().c_str());
 }
 
+JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getMapHash(JNIEnv* env, jobject jObj)
+{
+	return env->NewStringUTF(Broodwar->mapHash().c_str());
+}
+
 JNIEXPORT jbyteArray JNICALL Java_com_harbinger_jbw_Broodwar_getMapName(JNIEnv* env, jobject jObj)
 {
 	// NewStringUTF causes issues with unusual characters like Korean symbols
@@ -992,6 +3081,7 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getMapDepth(JNIEnv*
 	int index = 0;
 	int width = Broodwar->mapWidth();
 	int height = Broodwar->mapHeight();
+	jint* intBuf = scratchBuffer(width * height);
 
 	for (int ty = 0; ty < height; ++ty) {
 		for (int tx = 0; tx < width; ++tx) {
@@ -1010,6 +3100,7 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getWalkableData(JNIE
 	int index = 0;	
 	int width = 4 * Broodwar->mapWidth();
 	int height = 4 * Broodwar->mapHeight();
+	jint* intBuf = scratchBuffer(width * height);
 
 	for (int ty = 0; ty < height; ++ty) {
 		for (int tx = 0; tx < width; ++tx) {
@@ -1027,6 +3118,7 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getBuildableData(JNI
 	int index = 0;
 	int width = Broodwar->mapWidth();
 	int height = Broodwar->mapHeight();
+	jint* intBuf = scratchBuffer(width * height);
 
 	for (int ty = 0; ty < height; ++ty) {
 		for (int tx = 0; tx < width; ++tx) {
@@ -1039,35 +3131,148 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getBuildableData(JNI
 	return result;
 }
 
-JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_analyzeTerrain(JNIEnv* env, jobject jObj)
+// result of the native terrain analysis of the current map
+TerrainAnalysis terrainAnalysis;
+
+/**
+* Runs the native terrain analysis on the static terrain and resources of the map and returns the base
+* locations it found.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_analyzeTerrain(JNIEnv* env, jobject jObj)
+{
+	TerrainInput input;
+	input.width = Broodwar->mapWidth();
+	input.height = Broodwar->mapHeight();
+	input.walkable.resize(input.width * 4 * input.height * 4);
+	for (int y = 0; y < input.height * 4; y++) {
+		for (int x = 0; x < input.width * 4; x++) {
+			input.walkable[x + input.width * 4 * y] = Broodwar->isWalkable(x, y) ? 1 : 0;
+		}
+	}
+	input.buildable.resize(input.width * input.height);
+	for (int y = 0; y < input.height; y++) {
+		for (int x = 0; x < input.width; x++) {
+			input.buildable[x + input.width * y] = Broodwar->isBuildable(x, y) ? 1 : 0;
+		}
+	}
+
+	std::set<Unit*>* resources[2] = { &Broodwar->getStaticMinerals(), &Broodwar->getStaticGeysers() };
+	for (int i = 0; i < 2; i++) {
+		for (std::set<Unit*>::const_iterator j = resources[i]->begin(); j != resources[i]->end(); ++j) {
+			TerrainResource resource;
+			resource.tx = (*j)->getInitialTilePosition().x();
+			resource.ty = (*j)->getInitialTilePosition().y();
+			resource.width = (*j)->getInitialType().tileWidth();
+			resource.height = (*j)->getInitialType().tileHeight();
+			resource.amount = (*j)->getInitialResources();
+			resource.geyser = i == 1;
+			input.resources.push_back(resource);
+		}
+	}
+	const std::set<TilePosition>& starts = Broodwar->getStartLocations();
+	for (std::set<TilePosition>::const_iterator i = starts.begin(); i != starts.end(); ++i) {
+		input.startLocations.push_back(i->x());
+		input.startLocations.push_back(i->y());
+	}
+
+	DWORD start = GetTickCount();
+	analyzeTerrain(input, terrainAnalysis);
+	BRIDGE_LOG(LogMap, LogInfo, "Terrain analyzed in %lu ms: %u regions, %u chokepoints, %u bases",
+		GetTickCount() - start, terrainAnalysis.regions.size(), terrainAnalysis.chokepoints.size(),
+		terrainAnalysis.bases.size());
+
+	jint* intBuf = scratchBuffer(terrainAnalysis.bases.size() * terrainBaseRecordSize);
+	int index = 0;
+	for (unsigned int i = 0; i < terrainAnalysis.bases.size(); i++) {
+		index = writeTerrainBase(intBuf, index, terrainAnalysis.bases[i]);
+	}
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
+}
+
+/**
+* Returns the regions and chokepoints found by the last terrain analysis and the region of each build tile, row
+* by row, or an empty array if the current map has not been analyzed:
+*
+*   regionCount terrainRegion* chokepointCount terrainChokepoint* tileRegion*
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getTerrainRegions(JNIEnv* env, jobject jObj)
 {
-	regionMap.clear();
-	BWTA::readMap();
-	BWTA::analyze();
+	jint* intBuf = scratchBuffer(2 + terrainAnalysis.regions.size() * terrainRegionRecordSize
+		+ terrainAnalysis.chokepoints.size() * terrainChokepointRecordSize + Broodwar->mapWidth() * Broodwar->mapHeight());
+	int index = 0;
 
-	// assign IDs to regions
-	int regionID = 1;
-	std::set<BWTA::Region*> regions = BWTA::getRegions();
-	for (std::set<BWTA::Region*>::iterator i = regions.begin(); i != regions.end(); ++i) {
-		regionMap[(*i)] = regionID++;
+	const int tiles = Broodwar->mapWidth() * Broodwar->mapHeight();
+	if ((int)terrainAnalysis.tileRegionMap.size() == tiles) {
+		intBuf[index++] = terrainAnalysis.regions.size();
+		for (unsigned int i = 0; i < terrainAnalysis.regions.size(); i++) {
+			index = writeTerrainRegion(intBuf, index, terrainAnalysis.regions[i]);
+		}
+		intBuf[index++] = terrainAnalysis.chokepoints.size();
+		for (unsigned int i = 0; i < terrainAnalysis.chokepoints.size(); i++) {
+			index = writeTerrainChokepoint(intBuf, index, terrainAnalysis.chokepoints[i]);
+		}
+		memcpy(&intBuf[index], &terrainAnalysis.tileRegionMap[0], tiles * sizeof(jint));
+		index += tiles;
 	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, intBuf);
+	return result;
 }
 
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getBaseLocations(JNIEnv* env, jobject jObj)
+// build tiles divided between two regions carry this flag and the index of their split tile entry
+const int splitTileFlag = 0x2000;
+// sizes of the tables of GameData
+const int maxRegions = 5000;
+const int maxSplitTiles = 5000;
+
+/**
+* Returns the region graph BWAPI divides the map into for path finding, read in bulk from the shared memory
+* of the client:
+*
+*   regionCount (regionNode neighbourID*)* tileRegion* splitCount (mask region1 region2)*
+*
+* tileRegion is the region ID of each build tile, row by row, or splitTileFlag and the index of its split tile
+* entry. Bit (wx + 4 * wy) of the mask tells which of the two regions walk tile (wx, wy) of the build tile is in.
+*/
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getRegionGraphData(JNIEnv* env, jobject jObj)
 {
+	const GameData* data = BWAPI::BWAPIClient.data;
+	const int regionCount = std::min(data->regionCount, maxRegions);
+	int neighborCount = 0;
+	for (int r = 0; r < regionCount; r++) {
+		neighborCount += data->regions[r].neighborCount;
+	}
+	jint* intBuf = scratchBuffer(2 + regionCount * regionNodeRecordSize + neighborCount + 3 * maxSplitTiles
+		+ Broodwar->mapWidth() * Broodwar->mapHeight());
 	int index = 0;
 
-	std::set<BWTA::BaseLocation*> baseLocation = BWTA::getBaseLocations();
-	for (std::set<BWTA::BaseLocation*>::iterator i = baseLocation.begin(); i != baseLocation.end(); ++i) {
-		intBuf[index++] = (*i)->getPosition().x();
-		intBuf[index++] = (*i)->getPosition().y();
-		intBuf[index++] = (*i)->getTilePosition().x();
-		intBuf[index++] = (*i)->getTilePosition().y();
-		intBuf[index++] = (*i)->minerals();
-		intBuf[index++] = (*i)->gas();
-		intBuf[index++] = (*i)->isIsland() ? 1 : 0;
-		intBuf[index++] = (*i)->isMineralOnly() ? 1 : 0;
-		intBuf[index++] = (*i)->isStartLocation() ? 1 : 0;
+	intBuf[index++] = regionCount;
+	for (int r = 0; r < regionCount; r++) {
+		const RegionData& region = data->regions[r];
+		index = writeRegionNode(intBuf, index, region);
+		for (int n = 0; n < region.neighborCount; n++) {
+			intBuf[index++] = region.neighbors[n];
+		}
+	}
+
+	int splitCount = 0;
+	for (int ty = 0; ty < Broodwar->mapHeight(); ty++) {
+		for (int tx = 0; tx < Broodwar->mapWidth(); tx++) {
+			const int id = data->mapTileRegionId[tx][ty];
+			if (id & splitTileFlag) {
+				splitCount = std::max(splitCount, std::min((id & ~splitTileFlag) + 1, maxSplitTiles));
+			}
+			intBuf[index++] = id;
+		}
+	}
+	intBuf[index++] = splitCount;
+	for (int s = 0; s < splitCount; s++) {
+		intBuf[index++] = data->mapSplitTilesMiniTileMask[s];
+		intBuf[index++] = data->mapSplitTilesRegion1[s];
+		intBuf[index++] = data->mapSplitTilesRegion2[s];
 	}
 
 	jintArray result = env->NewIntArray(index);
@@ -1075,11 +3280,20 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getBaseLocations(JNI
 	return result;
 }
 
+/**
+* Returns the address of the game, which terrain-bridge needs to run the BWTA terrain analysis.
+*/
+JNIEXPORT jlong JNICALL Java_com_harbinger_jbw_Broodwar_getGameHandle(JNIEnv* env, jobject jObj)
+{
+	return static_cast<jlong>(reinterpret_cast<intptr_t>(Broodwar));
+}
+
 JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitIdsOnTile(JNIEnv * env, jobject jObj, jint tx, jint ty)
 {
-	std::set<Unit*> unitsOnTile = Broodwar->getUnitsOnTile(tx, ty);
+	const std::set<Unit*>& unitsOnTile = Broodwar->getUnitsOnTile(tx, ty);
+	jint* intBuf = scratchBuffer(unitsOnTile.size());
 	int index = 0;
-	for (std::set<Unit*>::iterator i = unitsOnTile.begin(); i != unitsOnTile.end(); ++i)
+	for (std::set<Unit*>::const_iterator i = unitsOnTile.begin(); i != unitsOnTile.end(); ++i)
 	{
 		intBuf[index++] = (*i)->getID();
 	}
@@ -1117,7 +3331,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_build(JNIEnv* env, jobjec
 	Unit* unit = Broodwar->getUnit(unitID);
 	if (unit != NULL) {
 		if (unitTypeMap.count(typeID) > 0) {
-			return unit->build(BWAPI::TilePosition(tx, ty), unitTypeMap[typeID]);
+			return unit->build(BWAPI::TilePosition(tx, ty), findType(unitTypeMap, typeID));
 		}
 	}
 	return JNI_FALSE;
@@ -1128,7 +3342,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_buildAddon(JNIEnv* env, j
 	Unit* unit = Broodwar->getUnit(unitID);
 	if (unit != NULL) {
 		if (unitTypeMap.count(typeID) > 0) {
-			return unit->buildAddon(unitTypeMap[typeID]);
+			return unit->buildAddon(findType(unitTypeMap, typeID));
 		}
 	}
 	return JNI_FALSE;
@@ -1139,7 +3353,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_train(JNIEnv* env, jobjec
 	Unit* unit = Broodwar->getUnit(unitID);
 	if (unit != NULL) {
 		if (unitTypeMap.count(typeID) > 0) {
-			return unit->train(unitTypeMap[typeID]);
+			return unit->train(findType(unitTypeMap, typeID));
 		}
 	}
 	return JNI_FALSE;
@@ -1150,7 +3364,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_morph(JNIEnv* env, jobjec
 	Unit* unit = Broodwar->getUnit(unitID);
 	if (unit != NULL) {
 		if (unitTypeMap.count(typeID) > 0) {
-			return unit->morph(unitTypeMap[typeID]);
+			return unit->morph(findType(unitTypeMap, typeID));
 		}
 	}
 	return JNI_FALSE;
@@ -1161,7 +3375,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_research(JNIEnv* env, job
 	Unit* unit = Broodwar->getUnit(unitID);
 	if (unit != NULL) {
 		if (techTypeMap.count(techID) > 0) {
-			return unit->research(techTypeMap[techID]);
+			return unit->research(findType(techTypeMap, techID));
 		}
 	}
 	return JNI_FALSE;
@@ -1172,7 +3386,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_upgrade(JNIEnv* env, jobj
 	Unit* unit = Broodwar->getUnit(unitID);
 	if (unit != NULL) {
 		if (upgradeTypeMap.count(upgradeID) > 0) {
-			return unit->upgrade(upgradeTypeMap[upgradeID]);
+			return unit->upgrade(findType(upgradeTypeMap, upgradeID));
 		}
 	}
 	return JNI_FALSE;
@@ -1469,7 +3683,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_useTech__II(JNIEnv* env,
 	Unit* unit = Broodwar->getUnit(unitID);
 	if (unit != NULL) {
 		if (techTypeMap.count(techID) > 0) {
-			return unit->useTech(techTypeMap[techID]);
+			return unit->useTech(findType(techTypeMap, techID));
 		}
 	}
 	return JNI_FALSE;
@@ -1480,7 +3694,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_useTech__IIII(JNIEnv* env
 	Unit* unit = Broodwar->getUnit(unitID);
 	if (unit != NULL) {
 		if (techTypeMap.count(techID) > 0) {
-			return unit->useTech(techTypeMap[techID], BWAPI::Position(x, y));
+			return unit->useTech(findType(techTypeMap, techID), BWAPI::Position(x, y));
 		}			
 	}
 	return JNI_FALSE;
@@ -1492,7 +3706,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Unit_useTech__III(JNIEnv* env,
 	Unit* target = Broodwar->getUnit(targetID);
 	if (unit != NULL && target != NULL) {
 		if (techTypeMap.count(techID) > 0) {
-			return unit->useTech(techTypeMap[techID], target);
+			return unit->useTech(findType(techTypeMap, techID), target);
 		}
 	}
 	return JNI_FALSE;
@@ -1507,6 +3721,96 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_placeCOP(JNIEnv* env,
 	return JNI_FALSE;
 }
 
+/**
+* Issues a command described by its BWAPI command type and raw arguments, as received from an out of process agent
+* or a worker thread. The position is in pixels, or in build tiles for commands that take a tile position, and
+* extra is the unit, tech or upgrade type or the training slot.
+*/
+bool issueRawCommand(int unitID, int commandID, int targetID, int x, int y, int extra)
+{
+	Unit* unit = Broodwar->getUnit(unitID);
+	if (unit != NULL && commandID >= 0 && commandID < UnitCommandTypes::None.getID()) {
+		if (unit->issueCommand(UnitCommand(unit, UnitCommandType(commandID), Broodwar->getUnit(targetID), x, y, extra))) {
+			return true;
+		}
+		BRIDGE_LOG(LogCommands, LogDebug, "Command %d of unit %d failed: %s", commandID, unitID,
+			Broodwar->getLastError().toString().c_str());
+		return false;
+	}
+	BRIDGE_LOG(LogCommands, LogDebug, "Command %d of unit %d is not valid", commandID, unitID);
+	return false;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_issueCommand(JNIEnv* env, jobject jObj, jint unitID, jint commandID, jint targetID, jint x, jint y, jint extra)
+{
+	return issueRawCommand(unitID, commandID, targetID, x, y, extra);
+}
+
+/**
+* A command submitted by a worker thread, in the command ring.
+*/
+struct CommandCell {
+	volatile LONG sequence;
+	jint unitID;
+	jint commandID;
+	jint targetID;
+	jint x;
+	jint y;
+	jint extra;
+};
+const int commandRingSize = 4096; // power of two
+CommandCell commandRing[commandRingSize];
+volatile LONG commandWritePosition = 0;
+LONG commandReadPosition = 0;
+
+/**
+* Queues a command from any thread, without locking. Returns false if the queue is full.
+*/
+JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_nativeSubmitCommand(JNIEnv* env, jobject jObj, jint unitID, jint commandID, jint targetID, jint x, jint y, jint extra)
+{
+	CommandCell* cell = claimRingCell(commandRing, commandWritePosition);
+	if (cell == NULL) {
+		BRIDGE_LOG(LogCommands, LogWarning, "Command queue is full, command %d of unit %d was dropped", commandID, unitID);
+		return JNI_FALSE;
+	}
+	cell->unitID = unitID;
+	cell->commandID = commandID;
+	cell->targetID = targetID;
+	cell->x = x;
+	cell->y = y;
+	cell->extra = extra;
+	publishRingCell(cell);
+	return JNI_TRUE;
+}
+
+/**
+* Issues the submitted commands in the order they were queued. Only called by the thread running the match, so
+* BWAPI's command buffer is never written concurrently.
+*/
+void issueSubmittedCommands(void)
+{
+	CommandCell* cell;
+	while ((cell = peekRingCell(commandRing, commandReadPosition)) != NULL) {
+		issueRawCommand(cell->unitID, cell->commandID, cell->targetID, cell->x, cell->y, cell->extra);
+		releaseRingCell(commandRing, commandReadPosition);
+	}
+}
+
+/**
+* Drops the submitted commands that have not been issued, when their match is over.
+*/
+void discardSubmittedCommands(void)
+{
+	int discarded = 0;
+	while (peekRingCell(commandRing, commandReadPosition) != NULL) {
+		releaseRingCell(commandRing, commandReadPosition);
+		discarded++;
+	}
+	if (discarded > 0) {
+		BRIDGE_LOG(LogCommands, LogDebug, "%d commands submitted after the match were dropped", discarded);
+	}
+}
+
 /*****************************************************************************************************************/
 // Extended functions
 /*****************************************************************************************************************/
@@ -1603,7 +3907,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_hasPath__III(JNIEnv*
 JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canBuildHere__IIIZ(JNIEnv* env, jobject jObj, jint tileX, jint tileY, jint unitTypeID, jboolean checkExplored)
 {
 	if (unitTypeMap.count(unitTypeID) > 0) {
-		BWAPI::UnitType unitType = unitTypeMap[unitTypeID];
+		BWAPI::UnitType unitType = findType(unitTypeMap, unitTypeID);
 		return Broodwar->canBuildHere(NULL, TilePosition(tileX, tileY), unitType, checkExplored != JNI_FALSE);
 	}
 
@@ -1614,7 +3918,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canBuildHere__IIIIZ(J
 {
 	if (unitTypeMap.count(unitTypeID) > 0) {
 		BWAPI::Unit* unit = Broodwar->getUnit(unitID);
-		BWAPI::UnitType unitType = unitTypeMap[unitTypeID];
+		BWAPI::UnitType unitType = findType(unitTypeMap, unitTypeID);
 		return Broodwar->canBuildHere(unit, TilePosition(tileX, tileY), unitType, checkExplored != JNI_FALSE);
 	}
 
@@ -1624,7 +3928,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canBuildHere__IIIIZ(J
 JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canMake__I(JNIEnv* env, jobject jObj, jint unitTypeID)
 {
 	if (unitTypeMap.count(unitTypeID) > 0) {
-		BWAPI::UnitType unitType = unitTypeMap[unitTypeID];
+		BWAPI::UnitType unitType = findType(unitTypeMap, unitTypeID);
 		return Broodwar->canMake(NULL, unitType);
 	}
 
@@ -1635,7 +3939,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canMake__II(JNIEnv* e
 {
 	if (unitTypeMap.count(unitTypeID) > 0) {
 		BWAPI::Unit* unit = Broodwar->getUnit(unitID);
-		BWAPI::UnitType unitType = unitTypeMap[unitTypeID];
+		BWAPI::UnitType unitType = findType(unitTypeMap, unitTypeID);
 		return Broodwar->canMake(unit, unitType);
 	}
 
@@ -1645,7 +3949,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canMake__II(JNIEnv* e
 JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canResearch__I(JNIEnv* env, jobject jObj, jint techTypeID)
 {
 	if (techTypeMap.count(techTypeID) > 0) {
-		BWAPI::TechType techType = techTypeMap[techTypeID];
+		BWAPI::TechType techType = findType(techTypeMap, techTypeID);
 		return Broodwar->canResearch(NULL, techType);
 	}
 
@@ -1656,7 +3960,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canResearch__II(JNIEn
 {
 	if (techTypeMap.count(techTypeID) > 0) {
 		BWAPI::Unit* unit = Broodwar->getUnit(unitID);
-		BWAPI::TechType techType = unitTypeMap[techTypeID];
+		BWAPI::TechType techType = findType(techTypeMap, techTypeID);
 		return Broodwar->canResearch(unit, techType);
 	}
 
@@ -1666,7 +3970,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canResearch__II(JNIEn
 JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canUpgrade__I(JNIEnv* env, jobject jObj, jint upgradeTypeID)
 {
 	if (upgradeTypeMap.count(upgradeTypeID) > 0) {
-		BWAPI::UpgradeType upgradeType = upgradeTypeMap[upgradeTypeID];
+		BWAPI::UpgradeType upgradeType = findType(upgradeTypeMap, upgradeTypeID);
 		return Broodwar->canUpgrade(NULL, upgradeType);
 	}
 
@@ -1677,7 +3981,7 @@ JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_canUpgrade__II(JNIEnv
 {
 	if (upgradeTypeMap.count(upgradeTypeID) > 0) {
 		BWAPI::Unit* unit = Broodwar->getUnit(unitID);
-		BWAPI::UpgradeType upgradeType = upgradeTypeMap[upgradeTypeID];
+		BWAPI::UpgradeType upgradeType = findType(upgradeTypeMap, upgradeTypeID);
 		return Broodwar->canUpgrade(unit, upgradeType);
 	}
 
@@ -543,14 +543,6 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getOrderTypes
 JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getOrderTypeName
   (JNIEnv *, jobject, jint);
 
-/*
- * Class:     com_harbinger_jbw_Broodwar
- * Method:    analyzeTerrain
- * Signature: ()V
- */
-JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_analyzeTerrain
-  (JNIEnv *, jobject);
-
 /*
  * Class:     com_harbinger_jbw_Broodwar
  * Method:    getMapName
@@ -609,12 +601,276 @@ JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getBuildableData
 
 /*
  * Class:     com_harbinger_jbw_Broodwar
- * Method:    getBaseLocations
+ * Method:    getEnemyMemoryData
  * Signature: ()[I
  */
-JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getBaseLocations
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getEnemyMemoryData
   (JNIEnv *, jobject);
 
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    setEnemyMemoryTimeout
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setEnemyMemoryTimeout
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getBulletsData
+ * Signature: ([I)I
+ */
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_getBulletsData
+  (JNIEnv *, jobject, jintArray);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    setUnitTransitionMask
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setUnitTransitionMask
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    setEventMask
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setEventMask
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeSetAgentCadence
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeSetAgentCadence
+  (JNIEnv *, jobject, jint, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    setFrameListenersEnabled
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setFrameListenersEnabled
+  (JNIEnv *, jobject, jboolean);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeAddUnitQuery
+ * Signature: ([I)I
+ */
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_nativeAddUnitQuery
+  (JNIEnv *, jobject, jintArray);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeRemoveUnitQuery
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeRemoveUnitQuery
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getUnitQueryResults
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitQueryResults
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getPlayerStatsVersions
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getPlayerStatsVersions
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getPlayerStats
+ * Signature: (I)[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getPlayerStats
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getGameHandle
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_com_harbinger_jbw_Broodwar_getGameHandle
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getMapHash
+ * Signature: ()Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_com_harbinger_jbw_Broodwar_getMapHash
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    analyzeTerrain
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_analyzeTerrain
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeAddFeaturePlanes
+ * Signature: ([ILjava/nio/FloatBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_nativeAddFeaturePlanes
+  (JNIEnv *, jobject, jintArray, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeRemoveFeaturePlanes
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeRemoveFeaturePlanes
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    buildFeaturePlanes
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_buildFeaturePlanes
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    issueCommand
+ * Signature: (IIIIII)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_issueCommand
+  (JNIEnv *, jobject, jint, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeOpenSnapshotRing
+ * Signature: (Ljava/lang/String;II)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_nativeOpenSnapshotRing
+  (JNIEnv *, jobject, jstring, jint, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeCloseSnapshotRing
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeCloseSnapshotRing
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeSetLogLevel
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeSetLogLevel
+  (JNIEnv *, jobject, jint, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    drainLog
+ * Signature: ()[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_harbinger_jbw_Broodwar_drainLog
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getFrameAllocationCount
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_getFrameAllocationCount
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeSubmitCommand
+ * Signature: (IIIIII)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_harbinger_jbw_Broodwar_nativeSubmitCommand
+  (JNIEnv *, jobject, jint, jint, jint, jint, jint, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    compareUnitRecords
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_compareUnitRecords
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getStaticNeutralUpdate
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getStaticNeutralUpdate
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getTerrainRegions
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getTerrainRegions
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getRegionGraphData
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getRegionGraphData
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    setTileRegions
+ * Signature: ([I)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_setTileRegions
+  (JNIEnv *, jobject, jintArray);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeAddGeofence
+ * Signature: ([I)I
+ */
+JNIEXPORT jint JNICALL Java_com_harbinger_jbw_Broodwar_nativeAddGeofence
+  (JNIEnv *, jobject, jintArray);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    nativeRemoveGeofence
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_Broodwar_nativeRemoveGeofence
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getGeofenceCrossings
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getGeofenceCrossings
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_harbinger_jbw_Broodwar
+ * Method:    getUnitData
+ * Signature: (I)[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_Broodwar_getUnitData
+  (JNIEnv *, jobject, jint);
+
 #ifdef __cplusplus
 }
 #endif
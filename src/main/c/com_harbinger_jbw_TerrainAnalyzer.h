@@ -0,0 +1,29 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class com_harbinger_jbw_TerrainAnalyzer */
+
+#ifndef _Included_com_harbinger_jbw_TerrainAnalyzer
+#define _Included_com_harbinger_jbw_TerrainAnalyzer
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     com_harbinger_jbw_TerrainAnalyzer
+ * Method:    analyze
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_TerrainAnalyzer_analyze
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     com_harbinger_jbw_TerrainAnalyzer
+ * Method:    getBaseLocations
+ * Signature: ()[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_TerrainAnalyzer_getBaseLocations
+  (JNIEnv *, jclass);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -8,7 +8,7 @@
 extern "C" {
 #endif
 #undef com_harbinger_jbw_Unit_NUM_ATTRIBUTES
-#define com_harbinger_jbw_Unit_NUM_ATTRIBUTES 123L
+#define com_harbinger_jbw_Unit_NUM_ATTRIBUTES 73L
 #undef com_harbinger_jbw_Unit_FIXED_SCALE
 #define com_harbinger_jbw_Unit_FIXED_SCALE 100.0
 #undef com_harbinger_jbw_Unit_TO_DEGREES
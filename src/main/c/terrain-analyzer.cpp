@@ -0,0 +1,729 @@
+#include "terrain-analyzer.h"
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+/**
+* The analysis runs in four stages:
+*
+* 1. an exact euclidean distance transform of the walk tiles, by columns and then by rows, both in parallel
+* 2. labelling of the connected walkable areas, which tells the bases on islands apart
+* 3. a watershed of the distance transform: regions are flooded from the most open tiles downwards, so two
+*    regions meet at the narrowest point between them, which is kept as a chokepoint unless the regions are
+*    too small or the passage too wide to be told apart, then rasterized to build tiles
+* 4. clustering of the resources and placement of a resource depot next to each cluster, in parallel
+*
+* Stages 1 and 3 are ported to com.harbinger.jbw.RegionAnalysis, which finds the same regions in recorded map
+* files without the game, so changes to them have to be made to both.
+*/
+
+// regions smaller than this, in walk tiles, are merged into their neighbours
+const int minRegionArea = 256;
+// regions are merged when the passage between them is at least this part of the clearance of either
+const double mergeClearanceRatio = 0.9;
+// resources at most this many build tiles apart are in the same cluster
+const int clusterGap = 6;
+// mineral fields with fewer minerals than this only block paths and are not part of a base
+const int minBaseMinerals = 200;
+// a cluster needs this many resources to be a base unless it has a geyser
+const int minClusterResources = 3;
+// how far, in build tiles, a resource depot is searched for around its cluster
+const int depotSearchRange = 10;
+// resource depots cannot be built this close to resources, in build tiles
+const int depotResourceGap = 3;
+const int depotWidth = 4;
+const int depotHeight = 3;
+// a start location within this many build tiles of a cluster is the base of the cluster
+const int startLocationRange = 12;
+
+/*****
+* Parallel loops
+*****/
+
+typedef void (*RangeFunction)(void* context, int begin, int end);
+
+struct RangeTask {
+	RangeFunction function;
+	void* context;
+	int begin;
+	int end;
+};
+
+#ifdef _WIN32
+DWORD WINAPI runRangeTask(LPVOID parameter)
+{
+	RangeTask* task = static_cast<RangeTask*>(parameter);
+	task->function(task->context, task->begin, task->end);
+	return 0;
+}
+#endif
+
+/**
+* Splits [0, count) into one range per processor, calls function for each range on its own thread and
+* waits for all of them. Runs on the calling thread only where threads are not available.
+*/
+void parallelFor(int count, RangeFunction function, void* context)
+{
+	int threads = 1;
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	threads = std::min(static_cast<int>(info.dwNumberOfProcessors), MAXIMUM_WAIT_OBJECTS);
+#endif
+	threads = std::min(threads, count);
+	if (threads <= 1) {
+		if (count > 0) {
+			function(context, 0, count);
+		}
+		return;
+	}
+#ifdef _WIN32
+	std::vector<RangeTask> tasks(threads);
+	for (int i = 0; i < threads; i++) {
+		tasks[i].function = function;
+		tasks[i].context = context;
+		tasks[i].begin = count * i / threads;
+		tasks[i].end = count * (i + 1) / threads;
+	}
+	// the calling thread takes the first range
+	std::vector<HANDLE> handles;
+	for (int i = 1; i < threads; i++) {
+		HANDLE handle = CreateThread(NULL, 0, runRangeTask, &tasks[i], 0, NULL);
+		if (handle != NULL) {
+			handles.push_back(handle);
+		}
+		else {
+			runRangeTask(&tasks[i]);
+		}
+	}
+	runRangeTask(&tasks[0]);
+	if (!handles.empty()) {
+		WaitForMultipleObjects(static_cast<DWORD>(handles.size()), &handles[0], TRUE, INFINITE);
+		for (unsigned int i = 0; i < handles.size(); i++) {
+			CloseHandle(handles[i]);
+		}
+	}
+#endif
+}
+
+/*****
+* Distance transform
+*****/
+
+struct DistanceContext {
+	const TerrainInput* input;
+	int width;
+	int height;
+	// squared distance to the closest unwalkable walk tile along the column, then in any direction
+	std::vector<int> columns;
+	std::vector<int> distance;
+};
+
+/**
+* Distance to the closest unwalkable walk tile in each column, where the edges of the map count as unwalkable.
+*/
+void transformColumns(void* data, int begin, int end)
+{
+	DistanceContext* context = static_cast<DistanceContext*>(data);
+	const int width = context->width;
+	const int height = context->height;
+	for (int x = begin; x < end; x++) {
+		int last = -1;
+		for (int y = 0; y < height; y++) {
+			if (!context->input->walkable[x + width * y]) {
+				last = y;
+			}
+			context->columns[x + width * y] = y - last;
+		}
+		last = height;
+		for (int y = height - 1; y >= 0; y--) {
+			if (!context->input->walkable[x + width * y]) {
+				last = y;
+			}
+			const int d = std::min(context->columns[x + width * y], last - y);
+			context->columns[x + width * y] = d * d;
+		}
+	}
+}
+
+/**
+* Lower envelope of the parabolas rooted at the column distances of each row, after Felzenszwalb and
+* Huttenlocher, bounded by the left and right edges of the map.
+*/
+void transformRows(void* data, int begin, int end)
+{
+	DistanceContext* context = static_cast<DistanceContext*>(data);
+	const int width = context->width;
+	std::vector<int> roots(width);
+	std::vector<double> bounds(width + 1);
+	for (int y = begin; y < end; y++) {
+		const int* f = &context->columns[width * y];
+		int k = 0;
+		roots[0] = 0;
+		bounds[0] = -1e20;
+		bounds[1] = 1e20;
+		for (int q = 1; q < width; q++) {
+			double s;
+			for (;;) {
+				const int r = roots[k];
+				s = ((f[q] + q * q) - (f[r] + r * r)) / (2.0 * (q - r));
+				if (s > bounds[k]) {
+					break;
+				}
+				k--;
+			}
+			k++;
+			roots[k] = q;
+			bounds[k] = s;
+			bounds[k + 1] = 1e20;
+		}
+		k = 0;
+		for (int q = 0; q < width; q++) {
+			while (bounds[k + 1] < q) {
+				k++;
+			}
+			const int r = roots[k];
+			const int edge = std::min(q + 1, width - q);
+			context->distance[q + width * y] = context->input->walkable[q + width * y]
+				? std::min((q - r) * (q - r) + f[r], edge * edge) : 0;
+		}
+	}
+}
+
+/*****
+* Connected areas
+*****/
+
+/**
+* Labels the 4-connected walkable areas of walk tiles from 1, unwalkable tiles are 0.
+*/
+void labelAreas(const TerrainInput& input, int width, int height, std::vector<int>& areas)
+{
+	areas.assign(width * height, 0);
+	std::vector<int> stack;
+	int next = 1;
+	for (int start = 0; start < width * height; start++) {
+		if (!input.walkable[start] || areas[start] != 0) {
+			continue;
+		}
+		const int label = next++;
+		areas[start] = label;
+		stack.push_back(start);
+		while (!stack.empty()) {
+			const int i = stack.back();
+			stack.pop_back();
+			const int x = i % width;
+			const int y = i / width;
+			const int neighbours[4] = { x > 0 ? i - 1 : -1, x < width - 1 ? i + 1 : -1,
+				y > 0 ? i - width : -1, y < height - 1 ? i + width : -1 };
+			for (int n = 0; n < 4; n++) {
+				const int j = neighbours[n];
+				if (j >= 0 && input.walkable[j] && areas[j] == 0) {
+					areas[j] = label;
+					stack.push_back(j);
+				}
+			}
+		}
+	}
+}
+
+/*****
+* Regions and chokepoints
+*****/
+
+struct ByDistance {
+	const std::vector<int>* distance;
+
+	bool operator()(int a, int b) const
+	{
+		const int da = (*distance)[a];
+		const int db = (*distance)[b];
+		return da != db ? da > db : a < b;
+	}
+};
+
+struct Basin {
+	int parent;
+	int area;
+	int peak;
+	int peakDistance;
+};
+
+struct Frontier {
+	int tile;
+	int a;
+	int b;
+};
+
+int findBasin(std::vector<Basin>& basins, int basin)
+{
+	while (basins[basin].parent != basin) {
+		basins[basin].parent = basins[basins[basin].parent].parent;
+		basin = basins[basin].parent;
+	}
+	return basin;
+}
+
+bool shouldMerge(const Basin& a, const Basin& b, int distance)
+{
+	if (std::min(a.area, b.area) < minRegionArea) {
+		return true;
+	}
+	const double passage = sqrt(static_cast<double>(distance));
+	return passage >= mergeClearanceRatio * sqrt(static_cast<double>(std::min(a.peakDistance, b.peakDistance)));
+}
+
+void findRegions(int width, int height, const std::vector<int>& distance, TerrainAnalysis& result)
+{
+	const int size = width * height;
+	std::vector<int> order;
+	order.reserve(size);
+	for (int i = 0; i < size; i++) {
+		if (distance[i] > 0) {
+			order.push_back(i);
+		}
+	}
+	ByDistance byDistance;
+	byDistance.distance = &distance;
+	std::sort(order.begin(), order.end(), byDistance);
+
+	// flood from the most open tiles down, joining the basins that meet where the passage is not narrow
+	std::vector<int> labels(size, -1);
+	std::vector<Basin> basins;
+	std::vector<Frontier> frontiers;
+	for (unsigned int o = 0; o < order.size(); o++) {
+		const int tile = order[o];
+		const int x = tile % width;
+		const int y = tile / width;
+		int a = -1;
+		int b = -1;
+		for (int dy = -1; dy <= 1 && b < 0; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				const int nx = x + dx;
+				const int ny = y + dy;
+				if (nx < 0 || ny < 0 || nx >= width || ny >= height || labels[nx + width * ny] < 0) {
+					continue;
+				}
+				const int basin = findBasin(basins, labels[nx + width * ny]);
+				if (a < 0) {
+					a = basin;
+				}
+				else if (basin != a) {
+					b = basin;
+					break;
+				}
+			}
+		}
+
+		if (a < 0) {
+			Basin basin = { static_cast<int>(basins.size()), 1, tile, distance[tile] };
+			labels[tile] = basin.parent;
+			basins.push_back(basin);
+		}
+		else if (b < 0) {
+			labels[tile] = a;
+			basins[a].area++;
+		}
+		else if (shouldMerge(basins[a], basins[b], distance[tile])) {
+			if (basins[a].area < basins[b].area) {
+				std::swap(a, b);
+			}
+			basins[b].parent = a;
+			basins[a].area += basins[b].area + 1;
+			if (basins[b].peakDistance > basins[a].peakDistance) {
+				basins[a].peak = basins[b].peak;
+				basins[a].peakDistance = basins[b].peakDistance;
+			}
+			labels[tile] = a;
+		}
+		else {
+			Frontier frontier = { tile, a, b };
+			frontiers.push_back(frontier);
+			labels[tile] = a;
+			basins[a].area++;
+		}
+	}
+
+	// number the remaining basins in the order they are first met
+	std::vector<int> regionOf(basins.size(), -1);
+	result.regionMap.assign(size, -1);
+	for (int i = 0; i < size; i++) {
+		if (labels[i] < 0) {
+			continue;
+		}
+		const int root = findBasin(basins, labels[i]);
+		if (regionOf[root] < 0) {
+			regionOf[root] = static_cast<int>(result.regions.size());
+			TerrainRegion region;
+			region.x = basins[root].peak % width;
+			region.y = basins[root].peak / width;
+			region.clearance = static_cast<int>(sqrt(static_cast<double>(basins[root].peakDistance)));
+			region.area = basins[root].area;
+			result.regions.push_back(region);
+		}
+		result.regionMap[i] = regionOf[root];
+	}
+
+	// frontier tiles between regions that were not merged later, grouped by pair of regions
+	std::map<std::pair<int, int>, int> pairs;
+	std::vector<std::pair<int, int> > pairRegions;
+	std::vector<int> pairAt(size, -1);
+	for (unsigned int f = 0; f < frontiers.size(); f++) {
+		const int a = regionOf[findBasin(basins, frontiers[f].a)];
+		const int b = regionOf[findBasin(basins, frontiers[f].b)];
+		if (a == b) {
+			continue;
+		}
+		const std::pair<int, int> key(std::min(a, b), std::max(a, b));
+		std::map<std::pair<int, int>, int>::iterator it = pairs.find(key);
+		if (it == pairs.end()) {
+			it = pairs.insert(std::make_pair(key, static_cast<int>(pairRegions.size()))).first;
+			pairRegions.push_back(key);
+		}
+		pairAt[frontiers[f].tile] = it->second;
+	}
+
+	// each 8-connected line of frontier tiles is a chokepoint, the most open tile is its middle
+	std::vector<int> stack;
+	for (unsigned int f = 0; f < frontiers.size(); f++) {
+		const int start = frontiers[f].tile;
+		const int pair = pairAt[start];
+		if (pair < 0) {
+			continue;
+		}
+		int middle = start;
+		pairAt[start] = -1;
+		stack.push_back(start);
+		while (!stack.empty()) {
+			const int tile = stack.back();
+			stack.pop_back();
+			if (distance[tile] > distance[middle]) {
+				middle = tile;
+			}
+			const int x = tile % width;
+			const int y = tile / width;
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					const int nx = x + dx;
+					const int ny = y + dy;
+					if (nx >= 0 && ny >= 0 && nx < width && ny < height && pairAt[nx + width * ny] == pair) {
+						pairAt[nx + width * ny] = -1;
+						stack.push_back(nx + width * ny);
+					}
+				}
+			}
+		}
+		TerrainChokepoint chokepoint;
+		chokepoint.regionA = pairRegions[pair].first;
+		chokepoint.regionB = pairRegions[pair].second;
+		chokepoint.x = middle % width;
+		chokepoint.y = middle / width;
+		chokepoint.width = static_cast<int>(2 * sqrt(static_cast<double>(distance[middle])));
+		result.chokepoints.push_back(chokepoint);
+	}
+}
+
+/**
+* Assigns each build tile the region of most of its walk tiles, so a region can be looked up by position with
+* a single array access.
+*/
+void rasterizeRegions(int tileWidth, int tileHeight, TerrainAnalysis& result)
+{
+	const int walkWidth = tileWidth * 4;
+	result.tileRegionMap.assign(tileWidth * tileHeight, -1);
+	for (int ty = 0; ty < tileHeight; ty++) {
+		for (int tx = 0; tx < tileWidth; tx++) {
+			// a build tile rarely touches more than two regions
+			int regions[16];
+			int counts[16];
+			int found = 0;
+			for (int wy = ty * 4; wy < ty * 4 + 4; wy++) {
+				for (int wx = tx * 4; wx < tx * 4 + 4; wx++) {
+					const int region = result.regionMap[wx + walkWidth * wy];
+					if (region < 0) {
+						continue;
+					}
+					int i = 0;
+					while (i < found && regions[i] != region) {
+						i++;
+					}
+					if (i == found) {
+						regions[found] = region;
+						counts[found++] = 0;
+					}
+					counts[i]++;
+				}
+			}
+			int best = -1;
+			for (int i = 0; i < found; i++) {
+				if (best < 0 || counts[i] > counts[best]) {
+					best = i;
+				}
+			}
+			if (best >= 0) {
+				result.tileRegionMap[tx + tileWidth * ty] = regions[best];
+			}
+		}
+	}
+}
+
+/*****
+* Bases
+*****/
+
+struct Cluster {
+	std::vector<int> resources;
+	int minerals;
+	int gas;
+	bool geyser;
+	int startLocation;
+	int tx;
+	int ty;
+};
+
+Cluster emptyCluster()
+{
+	Cluster cluster;
+	cluster.minerals = 0;
+	cluster.gas = 0;
+	cluster.geyser = false;
+	cluster.startLocation = -1;
+	cluster.tx = -1;
+	cluster.ty = -1;
+	return cluster;
+}
+
+struct BaseContext {
+	const TerrainInput* input;
+	std::vector<Cluster>* clusters;
+};
+
+// number of build tiles between two rectangles along the axis where they are furthest apart
+int tileGap(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh)
+{
+	const int gapX = std::max(bx - (ax + aw), ax - (bx + bw));
+	const int gapY = std::max(by - (ay + ah), ay - (by + bh));
+	return std::max(0, std::max(gapX, gapY));
+}
+
+bool canBuildDepot(const TerrainInput& input, int tx, int ty)
+{
+	for (int y = ty; y < ty + depotHeight; y++) {
+		for (int x = tx; x < tx + depotWidth; x++) {
+			if (!input.buildable[x + input.width * y]) {
+				return false;
+			}
+		}
+	}
+	for (unsigned int i = 0; i < input.resources.size(); i++) {
+		const TerrainResource& r = input.resources[i];
+		if (tileGap(tx, ty, depotWidth, depotHeight, r.tx, r.ty, r.width, r.height) < depotResourceGap) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* Places the resource depot of each cluster at the buildable position closest to its resources, marking
+* clusters without one with a tx of -1.
+*/
+void placeDepots(void* data, int begin, int end)
+{
+	BaseContext* context = static_cast<BaseContext*>(data);
+	const TerrainInput& input = *context->input;
+	for (int c = begin; c < end; c++) {
+		Cluster& cluster = (*context->clusters)[c];
+		if (cluster.startLocation >= 0) {
+			continue;
+		}
+		int minX = input.width;
+		int minY = input.height;
+		int maxX = 0;
+		int maxY = 0;
+		for (unsigned int i = 0; i < cluster.resources.size(); i++) {
+			const TerrainResource& r = input.resources[cluster.resources[i]];
+			minX = std::min(minX, r.tx);
+			minY = std::min(minY, r.ty);
+			maxX = std::max(maxX, r.tx + r.width);
+			maxY = std::max(maxY, r.ty + r.height);
+		}
+
+		double best = 1e20;
+		cluster.tx = -1;
+		for (int ty = std::max(0, minY - depotSearchRange);
+				ty <= std::min(input.height - depotHeight, maxY + depotSearchRange); ty++) {
+			for (int tx = std::max(0, minX - depotSearchRange);
+					tx <= std::min(input.width - depotWidth, maxX + depotSearchRange); tx++) {
+				// sum of the distances from the center of the depot to the centers of the resources, in tiles
+				double score = 0;
+				for (unsigned int i = 0; i < cluster.resources.size(); i++) {
+					const TerrainResource& r = input.resources[cluster.resources[i]];
+					const double dx = (tx + depotWidth / 2.0) - (r.tx + r.width / 2.0);
+					const double dy = (ty + depotHeight / 2.0) - (r.ty + r.height / 2.0);
+					score += sqrt(dx * dx + dy * dy);
+				}
+				if (score < best && canBuildDepot(input, tx, ty)) {
+					best = score;
+					cluster.tx = tx;
+					cluster.ty = ty;
+				}
+			}
+		}
+	}
+}
+
+/**
+* Returns the connected area under a resource depot, or 0 if none of its walk tiles are walkable.
+*/
+int depotArea(const std::vector<int>& areas, int walkWidth, int tx, int ty)
+{
+	const int cx = tx * 4 + depotWidth * 2;
+	const int cy = ty * 4 + depotHeight * 2;
+	if (areas[cx + walkWidth * cy] != 0) {
+		return areas[cx + walkWidth * cy];
+	}
+	for (int y = ty * 4; y < (ty + depotHeight) * 4; y++) {
+		for (int x = tx * 4; x < (tx + depotWidth) * 4; x++) {
+			if (areas[x + walkWidth * y] != 0) {
+				return areas[x + walkWidth * y];
+			}
+		}
+	}
+	return 0;
+}
+
+void findBases(const TerrainInput& input, const std::vector<int>& areas, TerrainAnalysis& result)
+{
+	// single linkage clustering of the resources that are part of bases
+	const int count = static_cast<int>(input.resources.size());
+	std::vector<int> clusterOf(count, -1);
+	std::vector<Cluster> clusters;
+	std::vector<int> stack;
+	for (int start = 0; start < count; start++) {
+		const TerrainResource& first = input.resources[start];
+		if (clusterOf[start] >= 0 || (!first.geyser && first.amount < minBaseMinerals)) {
+			continue;
+		}
+		Cluster cluster = emptyCluster();
+		const int id = static_cast<int>(clusters.size());
+		clusterOf[start] = id;
+		stack.push_back(start);
+		while (!stack.empty()) {
+			const int i = stack.back();
+			stack.pop_back();
+			const TerrainResource& r = input.resources[i];
+			cluster.resources.push_back(i);
+			if (r.geyser) {
+				cluster.gas += r.amount;
+				cluster.geyser = true;
+			}
+			else {
+				cluster.minerals += r.amount;
+			}
+			for (int j = 0; j < count; j++) {
+				const TerrainResource& n = input.resources[j];
+				if (clusterOf[j] < 0 && (n.geyser || n.amount >= minBaseMinerals)
+						&& tileGap(r.tx, r.ty, r.width, r.height, n.tx, n.ty, n.width, n.height) <= clusterGap) {
+					clusterOf[j] = id;
+					stack.push_back(j);
+				}
+			}
+		}
+		clusters.push_back(cluster);
+	}
+
+	// a start location is the base of the closest cluster in range, or a base without resources
+	std::vector<int> startCluster;
+	for (unsigned int s = 0; s + 1 < input.startLocations.size(); s += 2) {
+		const int sx = input.startLocations[s];
+		const int sy = input.startLocations[s + 1];
+		int closest = -1;
+		int closestGap = startLocationRange + 1;
+		for (unsigned int c = 0; c < clusters.size(); c++) {
+			for (unsigned int i = 0; i < clusters[c].resources.size(); i++) {
+				const TerrainResource& r = input.resources[clusters[c].resources[i]];
+				const int gap = tileGap(sx, sy, depotWidth, depotHeight, r.tx, r.ty, r.width, r.height);
+				if (gap < closestGap && clusters[c].startLocation < 0) {
+					closestGap = gap;
+					closest = c;
+				}
+			}
+		}
+		if (closest < 0) {
+			closest = static_cast<int>(clusters.size());
+			clusters.push_back(emptyCluster());
+		}
+		clusters[closest].startLocation = static_cast<int>(s / 2);
+		clusters[closest].tx = sx;
+		clusters[closest].ty = sy;
+	}
+
+	BaseContext context;
+	context.input = &input;
+	context.clusters = &clusters;
+	parallelFor(static_cast<int>(clusters.size()), placeDepots, &context);
+
+	const int walkWidth = input.width * 4;
+	std::vector<int> startAreas;
+	for (unsigned int c = 0; c < clusters.size(); c++) {
+		if (clusters[c].startLocation >= 0) {
+			startAreas.push_back(depotArea(areas, walkWidth, clusters[c].tx, clusters[c].ty));
+		}
+	}
+	for (unsigned int c = 0; c < clusters.size(); c++) {
+		const Cluster& cluster = clusters[c];
+		const bool startLocation = cluster.startLocation >= 0;
+		if (!startLocation && (cluster.tx < 0
+				|| (!cluster.geyser && static_cast<int>(cluster.resources.size()) < minClusterResources))) {
+			continue;
+		}
+		TerrainBase base;
+		base.tx = cluster.tx;
+		base.ty = cluster.ty;
+		base.x = cluster.tx * 32 + depotWidth * 16;
+		base.y = cluster.ty * 32 + depotHeight * 16;
+		base.minerals = cluster.minerals;
+		base.gas = cluster.gas;
+		base.region = result.regionMap[(cluster.tx * 4 + depotWidth * 2) + walkWidth * (cluster.ty * 4 + depotHeight * 2)];
+		const int area = depotArea(areas, walkWidth, cluster.tx, cluster.ty);
+		base.island = !startAreas.empty() && std::find(startAreas.begin(), startAreas.end(), area) == startAreas.end();
+		base.startLocation = startLocation;
+		result.bases.push_back(base);
+	}
+}
+
+/*****
+* Analysis
+*****/
+
+void analyzeTerrain(const TerrainInput& input, TerrainAnalysis& result)
+{
+	result.regionMap.clear();
+	result.tileRegionMap.clear();
+	result.regions.clear();
+	result.chokepoints.clear();
+	result.bases.clear();
+
+	DistanceContext distance;
+	distance.input = &input;
+	distance.width = input.width * 4;
+	distance.height = input.height * 4;
+	distance.columns.resize(distance.width * distance.height);
+	distance.distance.resize(distance.width * distance.height);
+	parallelFor(distance.width, transformColumns, &distance);
+	parallelFor(distance.height, transformRows, &distance);
+
+	std::vector<int> areas;
+	labelAreas(input, distance.width, distance.height, areas);
+
+	findRegions(distance.width, distance.height, distance.distance, result);
+	rasterizeRegions(input.width, input.height, result);
+	findBases(input, areas, result);
+}
@@ -0,0 +1,90 @@
+#ifndef _Included_terrain_analyzer
+#define _Included_terrain_analyzer
+
+#include <vector>
+
+/**
+* Terrain analysis that works directly on the walkability grid of a map, replacing BWTA and the CGAL, GMP
+* and MPFR libraries it depends on. It does not use BWAPI, the caller describes the map in a TerrainInput.
+*/
+
+/**
+* A mineral field or vespene geyser that is on the map when the match starts, in build tiles.
+*/
+struct TerrainResource {
+	int tx;
+	int ty;
+	int width;
+	int height;
+	int amount;
+	bool geyser;
+};
+
+struct TerrainInput {
+	// size of the map in build tiles
+	int width;
+	int height;
+	// one value per walk tile and per build tile, row by row
+	std::vector<char> walkable;
+	std::vector<char> buildable;
+	std::vector<TerrainResource> resources;
+	// top left build tiles of the resource depots at the start locations, as x, y pairs
+	std::vector<int> startLocations;
+};
+
+/**
+* An area of the map bounded by unwalkable terrain and chokepoints.
+*/
+struct TerrainRegion {
+	// the walk tile furthest from unwalkable terrain and its distance from it, in walk tiles
+	int x;
+	int y;
+	int clearance;
+	// number of walk tiles
+	int area;
+};
+
+/**
+* A narrow passage between two regions.
+*/
+struct TerrainChokepoint {
+	int regionA;
+	int regionB;
+	// the walk tile in the middle of the passage and the width of the passage there, in walk tiles
+	int x;
+	int y;
+	int width;
+};
+
+/**
+* A location where a resource depot can be built next to a cluster of resources.
+*/
+struct TerrainBase {
+	// center of the resource depot in pixels and its top left build tile
+	int x;
+	int y;
+	int tx;
+	int ty;
+	int minerals;
+	int gas;
+	int region;
+	bool island;
+	bool startLocation;
+};
+
+struct TerrainAnalysis {
+	// index of the region of each walk tile, or -1 if it is not walkable
+	std::vector<int> regionMap;
+	// index of the region most walk tiles of each build tile belong to, or -1 if none is walkable
+	std::vector<int> tileRegionMap;
+	std::vector<TerrainRegion> regions;
+	std::vector<TerrainChokepoint> chokepoints;
+	std::vector<TerrainBase> bases;
+};
+
+/**
+* Analyzes the terrain of a map, replacing the contents of result.
+*/
+void analyzeTerrain(const TerrainInput& input, TerrainAnalysis& result);
+
+#endif
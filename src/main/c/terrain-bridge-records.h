@@ -0,0 +1,30 @@
+/* DO NOT EDIT THIS FILE - it is generated from src/main/schema/bridge.schema */
+
+/**
+* Writers for the fixed size records the bridge sends to Java. Expects the namespaces of the
+* written types to be in scope and TO_DEGREES and fixedScale to be defined by the includer.
+*/
+
+#ifndef _Included_terrain_bridge_records
+#define _Included_terrain_bridge_records
+
+const int baseLocationRecordSize = 9;
+
+/**
+* Writes a baseLocation record of 9 values to buf at index and returns the index after it.
+*/
+inline int writeBaseLocation(jint* buf, int index, BWTA::BaseLocation* base)
+{
+	buf[index++] = base->getPosition().x(); // x
+	buf[index++] = base->getPosition().y(); // y
+	buf[index++] = base->getTilePosition().x(); // tx
+	buf[index++] = base->getTilePosition().y(); // ty
+	buf[index++] = base->minerals(); // minerals
+	buf[index++] = base->gas(); // gas
+	buf[index++] = (base->isIsland()) ? 1 : 0; // island
+	buf[index++] = (base->isMineralOnly()) ? 1 : 0; // mineralOnly
+	buf[index++] = (base->isStartLocation()) ? 1 : 0; // startLocation
+	return index;
+}
+
+#endif
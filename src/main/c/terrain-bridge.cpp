@@ -0,0 +1,67 @@
+#include <jni.h>
+#include <BWTA.h>
+#include <BWAPI.h>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "com_harbinger_jbw_TerrainAnalyzer.h"
+
+/**
+* Terrain analysis through BWTA, kept apart from client-bridge so that BWTA and the CGAL, GMP and MPFR
+* libraries it depends on are only loaded when a map has to be analyzed.
+*/
+
+using namespace BWAPI;
+
+// region IDs
+std::map<BWTA::Region*, int> regionMap;
+
+// whether this library's copy of the BWAPI type tables has been initialized
+bool bwapiInitialized = false;
+
+// conversion ratios
+double TO_DEGREES = 180.0 / M_PI;
+double fixedScale = 100.0;
+
+// fixed size record writers, generated from src/main/schema/bridge.schema
+#include "terrain-bridge-records.h"
+
+JNIEXPORT void JNICALL Java_com_harbinger_jbw_TerrainAnalyzer_analyze(JNIEnv* env, jclass jClass, jlong game)
+{
+	// BWTA reads the map through its own copy of BWAPI::Broodwar, point it at the game of client-bridge
+	Broodwar = reinterpret_cast<Game*>(static_cast<intptr_t>(game));
+
+	// this library links BWAPI statically, so its UnitType and WeaponType tables are separate from
+	// those of client-bridge and have to be initialized before BWTA reads them
+	if (!bwapiInitialized) {
+		BWAPI::BWAPI_init();
+		bwapiInitialized = true;
+	}
+
+	regionMap.clear();
+	BWTA::readMap();
+	BWTA::analyze();
+
+	// assign IDs to regions
+	int regionID = 1;
+	const std::set<BWTA::Region*>& regions = BWTA::getRegions();
+	for (std::set<BWTA::Region*>::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+		regionMap[(*i)] = regionID++;
+	}
+}
+
+JNIEXPORT jintArray JNICALL Java_com_harbinger_jbw_TerrainAnalyzer_getBaseLocations(JNIEnv* env, jclass jClass)
+{
+	const std::set<BWTA::BaseLocation*>& bases = BWTA::getBaseLocations();
+	std::vector<jint> data(bases.size() * baseLocationRecordSize + 1);
+
+	int index = 0;
+	for (std::set<BWTA::BaseLocation*>::const_iterator i = bases.begin(); i != bases.end(); ++i) {
+		index = writeBaseLocation(&data[0], index, *i);
+	}
+
+	jintArray result = env->NewIntArray(index);
+	env->SetIntArrayRegion(result, 0, index, &data[0]);
+	return result;
+}
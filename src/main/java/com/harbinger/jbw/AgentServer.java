@@ -0,0 +1,365 @@
+package com.harbinger.jbw;
+
+import java.io.*;
+import java.net.ServerSocket;
+import java.net.Socket;
+import java.net.SocketAddress;
+import java.net.SocketException;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.ConcurrentLinkedQueue;
+
+/**
+ * Streams the game state of every frame the agent is run to agents in other processes, which
+ * connect through {@link RemoteBroodwar}, and issues the commands they send back.
+ *
+ * <p>
+ * Each message is a type and a length followed by the payload, in network byte order. Integer
+ * arrays are written as their length followed by the values.
+ *
+ * <pre>
+ * message    := type:int length:int payload
+ * MATCH_START:= mapHash:utf playerCount:int (name:utf player:int[])* units:int[]
+ * FRAME      := frame:int playerCount:int (playerId:int update:int[])* units:int[]
+ *               eventCount:int (type:int p1:int p2:int text:utf)*
+ * MATCH_END  := winner:boolean
+ * COMMANDS   := commandCount:int (unitId:int command:int targetId:int x:int y:int extra:int)*
+ * </pre>
+ *
+ * <p>
+ * The bridge never waits for the agents. Their messages are written by a thread per agent, and an
+ * agent that falls more than {@value #CLIENT_QUEUE_MESSAGES} messages behind, or whose connection
+ * fails, is disconnected without affecting the match or the other agents. So is an agent that sends
+ * a message longer than {@value #MAX_CLIENT_MESSAGE_BYTES} bytes or whose command count does not
+ * match the length of its message. Commands received while a frame is handled are issued at the
+ * start of the next frame the agent is run.
+ */
+public class AgentServer implements Closeable {
+
+    static final int MATCH_START = 1;
+    static final int FRAME = 2;
+    static final int MATCH_END = 3;
+    static final int COMMANDS = 16;
+
+    /** Number of integers describing a command. */
+    static final int COMMAND_INTS = 6;
+
+    private static final int CLIENT_QUEUE_MESSAGES = 64;
+
+    // largest message accepted from an agent, which bounds what a broken agent can make us allocate
+    private static final int MAX_CLIENT_MESSAGE_BYTES = 1 << 20;
+
+    /**
+     * Issues a command on behalf of an agent, see {@link RemoteBroodwar#issueCommand}.
+     */
+    interface CommandTarget {
+
+        boolean issueCommand(int unitId, int commandId, int targetId, int x, int y, int extra);
+    }
+
+    private final ServerSocket serverSocket;
+    private final CommandTarget commandTarget;
+    private final List<Client> clients = new ArrayList<>();
+    private final ConcurrentLinkedQueue<int[]> commands = new ConcurrentLinkedQueue<>();
+
+    // the last match start, sent to agents that connect during the match
+    private byte[] matchStart;
+
+    // the frame being collected
+    private int frame;
+    private final List<int[]> frameInts = new ArrayList<>();
+    private int[] frameUnits = new int[0];
+    private final ByteArrayOutputStream frameEvents = new ByteArrayOutputStream();
+    private int frameEventCount;
+
+    private final ByteArrayOutputStream messageBytes = new ByteArrayOutputStream(1 << 16);
+    private byte[] scratch = new byte[1 << 16];
+
+    AgentServer(final SocketAddress address, final CommandTarget commandTarget)
+            throws IOException {
+        this.commandTarget = commandTarget;
+        serverSocket = new ServerSocket();
+        serverSocket.bind(address);
+        final Thread acceptThread = new Thread(this::acceptClients, "jbw-agent-server");
+        acceptThread.setDaemon(true);
+        acceptThread.start();
+    }
+
+    /**
+     * @return the address the server is listening on, useful when it was bound to port 0
+     */
+    public SocketAddress getAddress() {
+        return serverSocket.getLocalSocketAddress();
+    }
+
+    /**
+     * @return the number of connected agents
+     */
+    public int getClientCount() {
+        synchronized (clients) {
+            return clients.size();
+        }
+    }
+
+    /**
+     * Stops accepting agents and disconnects the connected ones.
+     */
+    @Override
+    public void close() throws IOException {
+        serverSocket.close();
+        synchronized (clients) {
+            for (final Client client : new ArrayList<>(clients)) {
+                client.close();
+            }
+        }
+    }
+
+    void matchStarted(final String mapHash, final int[] playerData, final String[] names,
+            final int[] unitData) {
+        try {
+            final DataOutputStream out = beginMessage();
+            out.writeUTF(mapHash);
+            out.writeInt(names.length);
+            for (int i = 0; i < names.length; i++) {
+                out.writeUTF(names[i]);
+                writeInts(out, playerData, i * Player.NUM_ATTRIBUTES, Player.NUM_ATTRIBUTES);
+            }
+            writeInts(out, unitData, 0, unitData.length);
+            final byte[] message = endMessage(MATCH_START);
+            synchronized (clients) {
+                matchStart = message;
+                broadcast(message);
+            }
+        } catch (final IOException ex) {
+            throw new UncheckedIOException(ex);
+        }
+    }
+
+    /**
+     * Starts collecting a frame and issues the commands the agents sent since the last frame.
+     */
+    void beginFrame(final int frame) {
+        this.frame = frame;
+        frameInts.clear();
+        frameUnits = new int[0];
+        frameEvents.reset();
+        frameEventCount = 0;
+
+        int[] batch;
+        while ((batch = commands.poll()) != null) {
+            for (int index = 0; index < batch.length; index += COMMAND_INTS) {
+                commandTarget.issueCommand(batch[index], batch[index + 1], batch[index + 2],
+                        batch[index + 3], batch[index + 4], batch[index + 5]);
+            }
+        }
+    }
+
+    void addPlayer(final int playerId, final int[] playerData) {
+        frameInts.add(new int[] { playerId });
+        frameInts.add(playerData);
+    }
+
+    void addUnits(final int[] unitData) {
+        frameUnits = unitData;
+    }
+
+    void addEvent(final int type, final int p1, final int p2, final String text) {
+        try {
+            final DataOutputStream out = new DataOutputStream(frameEvents);
+            out.writeInt(type);
+            out.writeInt(p1);
+            out.writeInt(p2);
+            out.writeUTF((text != null) ? text : "");
+            frameEventCount++;
+        } catch (final IOException ex) {
+            throw new UncheckedIOException(ex);
+        }
+    }
+
+    /**
+     * Sends the collected frame to the agents.
+     */
+    void endFrame() {
+        try {
+            final DataOutputStream out = beginMessage();
+            out.writeInt(frame);
+            out.writeInt(frameInts.size() / 2);
+            for (int i = 0; i < frameInts.size(); i += 2) {
+                out.writeInt(frameInts.get(i)[0]);
+                writeInts(out, frameInts.get(i + 1), 0, frameInts.get(i + 1).length);
+            }
+            writeInts(out, frameUnits, 0, frameUnits.length);
+            out.writeInt(frameEventCount);
+            frameEvents.writeTo(out);
+            final byte[] message = endMessage(FRAME);
+            synchronized (clients) {
+                broadcast(message);
+            }
+        } catch (final IOException ex) {
+            throw new UncheckedIOException(ex);
+        }
+    }
+
+    void matchEnded(final boolean winner) {
+        try {
+            final DataOutputStream out = beginMessage();
+            out.writeBoolean(winner);
+            final byte[] message = endMessage(MATCH_END);
+            synchronized (clients) {
+                matchStart = null;
+                broadcast(message);
+            }
+        } catch (final IOException ex) {
+            throw new UncheckedIOException(ex);
+        }
+    }
+
+    private DataOutputStream beginMessage() {
+        messageBytes.reset();
+        return new DataOutputStream(messageBytes);
+    }
+
+    private byte[] endMessage(final int type) {
+        final byte[] payload = messageBytes.toByteArray();
+        final byte[] message = new byte[payload.length + 8];
+        ByteBuffer.wrap(message).putInt(type).putInt(payload.length);
+        System.arraycopy(payload, 0, message, 8, payload.length);
+        return message;
+    }
+
+    // Writes a range of an array in network byte order with a single copy.
+    private void writeInts(final DataOutputStream out, final int[] data, final int offset,
+            final int length) throws IOException {
+        if (scratch.length < (length * 4)) {
+            scratch = new byte[length * 4];
+        }
+        ByteBuffer.wrap(scratch).asIntBuffer().put(data, offset, length);
+        out.writeInt(length);
+        out.write(scratch, 0, length * 4);
+    }
+
+    private void broadcast(final byte[] message) {
+        for (final Client client : new ArrayList<>(clients)) {
+            if (!client.outgoing.offer(message)) {
+                System.err.println("Agent " + client.name + " fell behind and was disconnected.");
+                client.close();
+            }
+        }
+    }
+
+    private void acceptClients() {
+        while (!serverSocket.isClosed()) {
+            try {
+                final Socket socket = serverSocket.accept();
+                socket.setTcpNoDelay(true);
+                synchronized (clients) {
+                    final Client client = new Client(socket);
+                    if (matchStart != null) {
+                        client.outgoing.add(matchStart);
+                    }
+                    clients.add(client);
+                    client.start();
+                }
+            } catch (final SocketException ex) {
+                // the server was closed
+            } catch (final IOException ex) {
+                System.err.println("Agent could not be accepted.");
+                System.err.println(ex.getMessage());
+            }
+        }
+    }
+
+    /**
+     * A connected agent, with a thread writing its messages and one reading its commands.
+     */
+    private final class Client {
+
+        final Socket socket;
+        final String name;
+        final BlockingQueue<byte[]> outgoing = new ArrayBlockingQueue<>(CLIENT_QUEUE_MESSAGES);
+        private Thread writer;
+
+        Client(final Socket socket) {
+            this.socket = socket;
+            name = String.valueOf(socket.getRemoteSocketAddress());
+        }
+
+        void start() {
+            writer = new Thread(this::writeMessages, "jbw-agent-writer " + name);
+            writer.setDaemon(true);
+            writer.start();
+            final Thread reader = new Thread(this::readCommands, "jbw-agent-reader " + name);
+            reader.setDaemon(true);
+            reader.start();
+        }
+
+        void close() {
+            synchronized (clients) {
+                clients.remove(this);
+            }
+            try {
+                socket.close();
+            } catch (final IOException ex) {
+                // already closed
+            }
+            // the writer may be waiting for a message that will never come
+            if ((writer != null) && (writer != Thread.currentThread())) {
+                writer.interrupt();
+            }
+        }
+
+        private void writeMessages() {
+            try {
+                final OutputStream out =
+                        new BufferedOutputStream(socket.getOutputStream(), 1 << 16);
+                while (!socket.isClosed()) {
+                    out.write(outgoing.take());
+                    if (outgoing.isEmpty()) {
+                        out.flush();
+                    }
+                }
+            } catch (final IOException | InterruptedException ex) {
+                close();
+            }
+        }
+
+        private void readCommands() {
+            try {
+                final DataInputStream in =
+                        new DataInputStream(new BufferedInputStream(socket.getInputStream()));
+                while (true) {
+                    final int type = in.readInt();
+                    final int length = in.readInt();
+                    if ((length < 0) || (length > MAX_CLIENT_MESSAGE_BYTES)) {
+                        throw new IllegalStateException("message length " + length);
+                    }
+                    if (type != COMMANDS) {
+                        in.readFully(new byte[length]);
+                        continue;
+                    }
+                    final int count = in.readInt();
+                    if ((count < 0) || (count > (length / (COMMAND_INTS * 4)))
+                            || (length != (4 + (count * COMMAND_INTS * 4)))) {
+                        throw new IllegalStateException(
+                                "command count " + count + " in " + length + " bytes");
+                    }
+                    final int[] batch = new int[count * COMMAND_INTS];
+                    for (int i = 0; i < batch.length; i++) {
+                        batch[i] = in.readInt();
+                    }
+                    commands.add(batch);
+                }
+            } catch (final IOException ex) {
+                close();
+            } catch (final RuntimeException ex) {
+                System.err.println(
+                        "Agent " + name + " sent an invalid message and was disconnected.");
+                System.err.println(ex.getMessage());
+                close();
+            }
+        }
+    }
+}
@@ -7,7 +7,9 @@ import com.harbinger.jbw.Position.Resolution;
  */
 public class BaseLocation {
 
+    // BEGIN GENERATED baseLocation.size
     static final int NUM_ATTRIBUTES = 9;
+    // END GENERATED baseLocation.size
 
     private final Position center;
     private final Position position;
@@ -18,17 +20,24 @@ public class BaseLocation {
     private final boolean startLocation;
 
     BaseLocation(final int[] data, int index) {
+        // BEGIN GENERATED baseLocation.decode
         final int x = data[index++];
         final int y = data[index++];
-        center = new Position(x, y, Resolution.PIXEL);
         final int tx = data[index++];
         final int ty = data[index++];
+        final int minerals = data[index++];
+        final int gas = data[index++];
+        final boolean island = data[index++] == 1;
+        final boolean mineralOnly = data[index++] == 1;
+        final boolean startLocation = data[index++] == 1;
+        // END GENERATED baseLocation.decode
+        center = new Position(x, y, Resolution.PIXEL);
         position = new Position(tx, ty, Resolution.BUILD);
-        minerals = data[index++];
-        gas = data[index++];
-        island = (data[index++] == 1);
-        mineralOnly = (data[index++] == 1);
-        startLocation = (data[index++] == 1);
+        this.minerals = minerals;
+        this.gas = gas;
+        this.island = island;
+        this.mineralOnly = mineralOnly;
+        this.startLocation = startLocation;
     }
 
     /**
@@ -0,0 +1,161 @@
+package com.harbinger.jbw;
+
+import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.Charset;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+
+/**
+ * The messages of the native bridge, such as connection progress and failed commands.
+ *
+ * <p>
+ * The bridge writes its messages into a fixed ring without locking or allocating, so logging does
+ * not slow down the frame. Messages below the {@link Broodwar#setLogLevel(Category, Level) level}
+ * of their category are not even formatted. A thread started by {@link Broodwar#connect()} takes
+ * the messages out of the ring periodically and passes them to the
+ * {@link Broodwar#setLogHandler(Handler) handler}, so the handler may block without affecting the
+ * game. If the ring fills up in between, further messages are dropped and a warning reports how
+ * many.
+ */
+public final class BridgeLog {
+
+    // how often the ring is drained
+    static final int DRAIN_INTERVAL_MILLIS = 100;
+
+    private static final int RECORD_HEADER_SIZE = 8;
+
+    /**
+     * The parts of the bridge a message comes from. Must match LogCategory in client-bridge.cpp.
+     */
+    public enum Category {
+        /** Connecting to the game and reconnecting. */
+        CONNECTION,
+        /** Matches starting and ending. */
+        MATCH,
+        /** Commands issued to units. */
+        COMMANDS,
+        /** Map and terrain analysis. */
+        MAP
+    }
+
+    /**
+     * The severity of a message. Must match LogLevel in client-bridge.cpp.
+     */
+    public enum Level {
+        DEBUG, INFO, WARNING, ERROR,
+        /** Disables all messages of a category. */
+        OFF
+    }
+
+    /**
+     * Receives the messages of the bridge, on the thread that drains them.
+     */
+    public interface Handler {
+
+        /**
+         * @param entries
+         *            the messages taken out of the ring, oldest first
+         */
+        void log(List<Entry> entries);
+    }
+
+    /**
+     * Prints the messages to the standard output.
+     */
+    public static final Handler CONSOLE = entries -> {
+        for (final Entry entry : entries) {
+            System.out.println("Bridge: " + entry.getMessage());
+        }
+    };
+
+    /**
+     * A message of the bridge.
+     */
+    public static final class Entry {
+
+        private final int frame;
+        private final Category category;
+        private final Level level;
+        private final String message;
+
+        Entry(final int frame, final Category category, final Level level, final String message) {
+            this.frame = frame;
+            this.category = category;
+            this.level = level;
+            this.message = message;
+        }
+
+        /**
+         * @return the frame of the match when the message was logged, or -1 outside of a match
+         */
+        public int getFrame() {
+            return frame;
+        }
+
+        public Category getCategory() {
+            return category;
+        }
+
+        public Level getLevel() {
+            return level;
+        }
+
+        public String getMessage() {
+            return message;
+        }
+
+        @Override
+        public String toString() {
+            return frame + " " + level + " " + category + ": " + message;
+        }
+    }
+
+    private BridgeLog() {
+        // static access only
+    }
+
+    /**
+     * Creates a handler that appends the messages to a file, one per line.
+     *
+     * @param file
+     *            the file to append to
+     *
+     * @return the handler
+     */
+    public static Handler toFile(final File file) {
+        return entries -> {
+            try (PrintWriter out = new PrintWriter(new FileWriter(file, true))) {
+                for (final Entry entry : entries) {
+                    out.println(entry);
+                }
+            } catch (final IOException ex) {
+                System.err.println("Bridge log could not be written.");
+                System.err.println(ex.getMessage());
+            }
+        };
+    }
+
+    /**
+     * Decodes the records drained from the ring.
+     */
+    static List<Entry> decode(final byte[] records, final Charset charset) {
+        if (records == null) {
+            return Collections.emptyList();
+        }
+        final List<Entry> entries = new ArrayList<>();
+        final ByteBuffer buffer = ByteBuffer.wrap(records).order(ByteOrder.LITTLE_ENDIAN);
+        while (buffer.remaining() >= RECORD_HEADER_SIZE) {
+            final int frame = buffer.getInt();
+            final Category category = Category.values()[buffer.get()];
+            final Level level = Level.values()[buffer.get()];
+            final int length = buffer.getShort() & 0xFFFF;
+            final String message = new String(records, buffer.position(), length, charset);
+            buffer.position(buffer.position() + length);
+            entries.add(new Entry(frame, category, level, message));
+        }
+        return entries;
+    }
+}
@@ -3,7 +3,6 @@ package com.harbinger.jbw;
 import static com.harbinger.jbw.Position.Resolution.BUILD;
 import static com.harbinger.jbw.Position.Resolution.PIXEL;
 
-import com.harbinger.jbw.Type.Bullet;
 import com.harbinger.jbw.Type.Command;
 import com.harbinger.jbw.Type.Damage;
 import com.harbinger.jbw.Type.Explosion;
@@ -16,6 +15,9 @@ import com.harbinger.jbw.Type.Upgrade;
 import com.harbinger.jbw.Type.Weapon;
 
 import java.io.*;
+import java.net.SocketAddress;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
 import java.nio.charset.Charset;
 import java.nio.charset.StandardCharsets;
 import java.nio.charset.UnsupportedCharsetException;
@@ -23,20 +25,63 @@ import java.util.*;
 
 /**
  * Provides access to the Broodwar game.
+ *
+ * <p>
+ * While the listener handles a frame, the queries of this class and of the units may be made from
+ * any thread, so the agent can fan its work out to worker threads that finish before the listener
+ * returns. Commands and drawing must be issued on the thread that notifies the listener; worker
+ * threads {@link #submitCommand submit} their commands instead. Unit queries, geofences and
+ * feature planes are also only added and removed on that thread.
  */
 public class Broodwar {
 
     static {
-        loadNativeDependencies();
+        // BWTA and its dependencies are only loaded when needed, see TerrainAnalyzer
+        NativeLibraries.load("client-bridge.dll");
     }
 
     private static final Charset CHARACTER_SET = getKoreanCharset();
 
+    private static final int KEY_PRESSED_MASK = 1 << 30;
+
+    // units a snapshot holds by default, the most Broodwar allows at once
+    private static final int SNAPSHOT_MAX_UNITS = 1700;
+
+    // frames a snapshot ring holds at most, about 500 MB with room for SNAPSHOT_MAX_UNITS units
+    private static final int SNAPSHOT_MAX_SLOTS = 1024;
+
+    // graphical frames per logical frame while exporting a replay, high enough to hardly draw
+    private static final int REPLAY_EXPORT_FRAME_SKIP = 1024;
+
     private final Map<Integer, Unit> units = new HashMap<>();
     private final List<Unit> playerUnits = new ArrayList<>();
     private final List<Unit> alliedUnits = new ArrayList<>();
     private final List<Unit> enemyUnits = new ArrayList<>();
     private final List<Unit> neutralUnits = new ArrayList<>();
+    private final List<RememberedUnit> rememberedEnemyUnits = new ArrayList<>();
+
+    // the records of the accessible static neutral units, patched with the changes the bridge sends
+    private final Map<Integer, int[]> staticNeutralRecords = new LinkedHashMap<>();
+    private final Map<Integer, BaseLocation> staticNeutralBases = new HashMap<>();
+
+    private final int[] bulletData = new int[Bullet.MAX_BULLETS * Bullet.NUM_ATTRIBUTES];
+    private final Bullet[] bullets = new Bullet[Bullet.MAX_BULLETS];
+    private int bulletCount;
+
+    private final Map<UnitTransition, List<UnitTransitionListener>> transitionListeners =
+            new EnumMap<>(UnitTransition.class);
+    private final List<FrameListener> frameListeners = new ArrayList<>();
+    private final Map<Integer, UnitQuery> unitQueries = new HashMap<>();
+    private final Map<Integer, FeaturePlanes> featurePlanes = new HashMap<>();
+    private final Map<Integer, Geofence> geofences = new HashMap<>();
+
+    private boolean flyweightUnits;
+    // the frame the agent was last run on, the frame listeners refresh the units on other frames
+    private int lastUpdateFrame = -1;
+
+    private ReplayDataWriter replayExport;
+    private AgentServer agentServer;
+    private volatile BridgeLog.Handler logHandler = BridgeLog.CONSOLE;
 
     private final Map<Integer, Player> players = new HashMap<>();
     private final List<Player> allies = new ArrayList<>();
@@ -48,6 +93,20 @@ public class Broodwar {
     private Player neutralPlayer;
 
     private GameMap map;
+    private RegionGraph regionGraph;
+
+    private final GameContext context = new GameContext() {
+
+        @Override
+        public Unit getUnit(final int unitId) {
+            return units.get(unitId);
+        }
+
+        @Override
+        public Player getPlayer(final int playerId) {
+            return players.get(playerId);
+        }
+    };
 
     /**
      * Constructs the Broodwar with the listener to notify when game events occur.
@@ -64,6 +123,9 @@ public class Broodwar {
             throw new IllegalArgumentException("listener cannot be null");
         }
         this.listener = listener;
+        for (int i = 0; i < bullets.length; i++) {
+            bullets[i] = new Bullet(bulletData, i * Bullet.NUM_ATTRIBUTES, this);
+        }
     }
 
     /**
@@ -77,7 +139,116 @@ public class Broodwar {
      * established when the game is in the Main Menu, Game Lobby, Mission Briefing, and Battle.net.
      */
     public void connect() {
-        nativeConnect(this);
+        updateEventMask();
+        final Thread logThread = new Thread(this::drainLogPeriodically, "jbw-bridge-log");
+        logThread.setDaemon(true);
+        logThread.start();
+        try {
+            nativeConnect(this);
+        } finally {
+            logThread.interrupt();
+            drainLogEntries();
+        }
+    }
+
+    private void drainLogPeriodically() {
+        try {
+            while (true) {
+                drainLogEntries();
+                Thread.sleep(BridgeLog.DRAIN_INTERVAL_MILLIS);
+            }
+        } catch (final InterruptedException ex) {
+            // connection ended
+        }
+    }
+
+    // The ring has a single consumer.
+    private synchronized void drainLogEntries() {
+        final List<BridgeLog.Entry> entries = BridgeLog.decode(drainLog(), CHARACTER_SET);
+        if (!entries.isEmpty()) {
+            logHandler.log(entries);
+        }
+    }
+
+    // The replay export and the agent server need every event, otherwise only the handled ones.
+    private void updateEventMask() {
+        if ((replayExport != null) || (agentServer != null)) {
+            setEventMask(~KEY_PRESSED_MASK);
+        } else {
+            setEventMask(getEventMask(listener));
+        }
+    }
+
+    /**
+     * Determines which events the listener actually handles, so the bridge can skip the others.
+     * Methods that a {@link BroodwarListener.Adaptor} subclass does not override are not handled.
+     * Match start and end are always delivered.
+     */
+    private static int getEventMask(final BroodwarListener listener) {
+        int mask = EventType.MATCH_START.getMask() | EventType.MATCH_END.getMask();
+        if (isHandled(listener, "matchFrame")) {
+            mask |= EventType.MATCH_FRAME.getMask();
+        }
+        if (isHandled(listener, "sendText", String.class)) {
+            mask |= EventType.SEND_TEXT.getMask();
+        }
+        if (isHandled(listener, "receiveText", String.class)) {
+            mask |= EventType.RECEIVE_TEXT.getMask();
+        }
+        if (isHandled(listener, "playerLeft", Player.class)) {
+            mask |= EventType.PLAYER_LEFT.getMask();
+        }
+        if (isHandled(listener, "nukeDetect", Position.class)) {
+            mask |= EventType.NUKE_DETECT.getMask();
+        }
+        if (isHandled(listener, "unitDiscover", Unit.class)) {
+            mask |= EventType.UNIT_DISCOVER.getMask();
+        }
+        if (isHandled(listener, "unitEvade", Unit.class)) {
+            mask |= EventType.UNIT_EVADE.getMask();
+        }
+        if (isHandled(listener, "unitShow", Unit.class)) {
+            mask |= EventType.UNIT_SHOW.getMask();
+        }
+        if (isHandled(listener, "unitHide", Unit.class)) {
+            mask |= EventType.UNIT_HIDE.getMask();
+        }
+        if (isHandled(listener, "unitCreate", Unit.class)) {
+            mask |= EventType.UNIT_CREATE.getMask();
+        }
+        if (isHandled(listener, "unitDestroy", Unit.class)) {
+            mask |= EventType.UNIT_DESTROY.getMask();
+        }
+        if (isHandled(listener, "unitMorph", Unit.class)) {
+            mask |= EventType.UNIT_MORPH.getMask();
+        }
+        if (isHandled(listener, "unitRenegade", Unit.class)) {
+            mask |= EventType.UNIT_RENEGADE.getMask();
+        }
+        if (isHandled(listener, "saveGame", String.class)) {
+            mask |= EventType.SAVE_GAME.getMask();
+        }
+        if (isHandled(listener, "unitComplete", Unit.class)) {
+            mask |= EventType.UNIT_COMPLETE.getMask();
+        }
+        if (isHandled(listener, "playerDropped", Player.class)) {
+            mask |= EventType.PLAYER_DROPPED.getMask();
+        }
+        if (isHandled(listener, "keyPressed", int.class)) {
+            mask |= KEY_PRESSED_MASK;
+        }
+        return mask;
+    }
+
+    private static boolean isHandled(final BroodwarListener listener, final String name,
+            final Class<?>... parameterTypes) {
+        try {
+            final Class<?> declaringClass =
+                    listener.getClass().getMethod(name, parameterTypes).getDeclaringClass();
+            return declaringClass != BroodwarListener.Adaptor.class;
+        } catch (final NoSuchMethodException ex) {
+            return true;
+        }
     }
 
     /**
@@ -116,6 +287,303 @@ public class Broodwar {
      */
     public native int getFrame();
 
+    /**
+     * Counts the native heap allocations of the thread running the match during the last frame,
+     * including those made by native calls while the listener handled it. Once the bridge has
+     * warmed up, a frame only allocates the bookkeeping of units seen for the first time, so a
+     * count in a frame without new units points at a native call copying data.
+     *
+     * @return the number of native heap allocations during the last completed frame
+     */
+    public native int getFrameAllocationCount();
+
+    /**
+     * Checks that the unit records the bridge reads straight from the raw unit data of the client
+     * match those BWAPI's accessors give for every accessible unit. Meant for testing the bridge,
+     * as it writes every unit twice.
+     *
+     * @return a description of each differing attribute, empty if all records match
+     */
+    public List<String> checkUnitRecords() {
+        final int[] differences = compareUnitRecords();
+        final List<String> descriptions = new ArrayList<>();
+        for (int index = 0; index < differences.length; index += 4) {
+            descriptions.add("Unit " + differences[index] + " "
+                    + Unit.ATTRIBUTE_NAMES[differences[index + 1]] + ": accessor "
+                    + differences[index + 2] + ", raw " + differences[index + 3]);
+        }
+        return descriptions;
+    }
+
+    /**
+     * Sets how often the agent is run. The game state is only updated, and the listener only
+     * notified, on the frames the agent is run.
+     *
+     * <p>
+     * The agent is run at least every {@code frames} frames. If a frame budget is given, the agent
+     * is also run on every frame while its previous run took no longer than the budget, so it only
+     * slows down when it gets expensive. The events of skipped frames are delivered together on
+     * the next frame the agent is run, with events that undo each other removed (e.g. a unit that
+     * was shown and hidden again) and a single {@link BroodwarListener#matchFrame() matchFrame}.
+     * The end of the match is always delivered immediately.
+     *
+     * <p>
+     * {@link FrameListener Frame listeners} are still invoked every frame.
+     *
+     * @param frames
+     *            the maximum number of frames between runs of the agent; 1 runs it every frame
+     *
+     * @param frameBudget
+     *            the number of milliseconds the agent may take and still be run on the next frame;
+     *            0 to always wait for the full number of frames
+     */
+    public void setAgentCadence(final int frames, final int frameBudget) {
+        if (frames < 1) {
+            throw new IllegalArgumentException("frames must be at least 1");
+        }
+        if (frameBudget < 0) {
+            throw new IllegalArgumentException("frameBudget cannot be negative");
+        }
+        nativeSetAgentCadence(frames, frameBudget);
+    }
+
+    /**
+     * Selects how units are updated. By default every attribute of every unit is copied into the
+     * Unit on each frame. Flyweight units are {@link UnitView views} that only decode an attribute
+     * when its getter is called, which saves the copy at the cost of decoding on every read. Which
+     * is faster depends on how many attributes the agent reads; <i>gradle benchmarkUnits</i>
+     * measures both on synthetic frames.
+     *
+     * <p>
+     * Only affects units first seen after the call, so it should be set before the match starts.
+     *
+     * @param flyweightUnits
+     *            true to use flyweight units; false to copy all attributes every frame
+     */
+    public void setFlyweightUnits(final boolean flyweightUnits) {
+        this.flyweightUnits = flyweightUnits;
+    }
+
+    /**
+     * Exports the units, players and events of every frame of the replay being played to a
+     * columnar data file, which can be read with {@link ReplayDataReader}. The file is completed
+     * when the replay ends.
+     *
+     * <p>
+     * The replay is run as fast as possible and the agent is run, and notified of all events, on
+     * every frame. Should be invoked when the match {@link BroodwarListener#matchStart() starts}.
+     *
+     * @param file
+     *            the file to write
+     *
+     * @throws IOException
+     *             if the file could not be created
+     *
+     * @throws IllegalStateException
+     *             thrown if the current match is not a replay
+     */
+    public void exportReplay(final File file) throws IOException {
+        if (!isReplay()) {
+            throw new IllegalStateException("match is not a replay");
+        }
+        if (replayExport != null) {
+            replayExport.close();
+        }
+        replayExport = new ReplayDataWriter(file);
+        setFrameDelay(0);
+        setFrameSkip(REPLAY_EXPORT_FRAME_SKIP);
+        updateEventMask();
+        nativeSetAgentCadence(1, 0);
+    }
+
+    private void stopReplayExport(final IOException cause) {
+        if (cause != null) {
+            System.err.println("Replay could not be exported.");
+            System.err.println(cause.getMessage());
+        }
+        try {
+            replayExport.close();
+        } catch (final IOException ex) {
+            if (cause == null) {
+                System.err.println("Replay could not be exported.");
+                System.err.println(ex.getMessage());
+            }
+        }
+        replayExport = null;
+        updateEventMask();
+    }
+
+    /**
+     * Starts streaming the game state to agents in other processes, which connect to the address
+     * through {@link RemoteBroodwar}, and issuing the commands they send back. The agents receive
+     * the state and events of the frames this agent is run, so the
+     * {@link #setAgentCadence(int, int) cadence} applies to them as well.
+     *
+     * <p>
+     * Can be invoked before {@link #connect() connecting}, and the server keeps running across
+     * matches until it is closed. Agents may connect at any time.
+     *
+     * @param address
+     *            the address to listen on, e.g. a port on the loopback address
+     *
+     * @return the server
+     *
+     * @throws IOException
+     *             if the address could not be bound
+     *
+     * @throws IllegalStateException
+     *             thrown if the agents are already being served
+     */
+    public AgentServer serveAgents(final SocketAddress address) throws IOException {
+        if (agentServer != null) {
+            throw new IllegalStateException("agents are already being served");
+        }
+        agentServer = new AgentServer(address, this::issueCommand);
+        updateEventMask();
+        return agentServer;
+    }
+
+    /**
+     * Stops serving the agents started through {@link #serveAgents(SocketAddress)} and disconnects
+     * them.
+     */
+    public void stopServingAgents() {
+        if (agentServer != null) {
+            try {
+                agentServer.close();
+            } catch (final IOException ex) {
+                System.err.println("Agent server could not be closed.");
+                System.err.println(ex.getMessage());
+            }
+            agentServer = null;
+            updateEventMask();
+        }
+    }
+
+    /**
+     * Publishes the players and units of every frame into a memory-mapped ring file, which any
+     * number of observers in other processes can read with {@link SnapshotReader} without
+     * coordinating with the bridge. Replaces the ring published before, if any.
+     *
+     * <p>
+     * Frames are published even when the agent is not run. The file holds the last {@code slots}
+     * frames, each with room for {@value #SNAPSHOT_MAX_UNITS} units.
+     *
+     * @param file
+     *            the file to create
+     *
+     * @param slots
+     *            the number of frames the ring holds, so readers may lag behind by this many
+     *            frames minus one; at most {@value #SNAPSHOT_MAX_SLOTS}
+     *
+     * @throws IOException
+     *             if the file could not be created and mapped
+     */
+    public void publishSnapshots(final File file, final int slots) throws IOException {
+        if ((slots < 1) || (slots > SNAPSHOT_MAX_SLOTS)) {
+            throw new IllegalArgumentException(
+                    "slots must be between 1 and " + SNAPSHOT_MAX_SLOTS + ": " + slots);
+        }
+        if (!nativeOpenSnapshotRing(file.getAbsolutePath(), slots, SNAPSHOT_MAX_UNITS)) {
+            throw new IOException("Snapshot ring could not be created: " + file);
+        }
+    }
+
+    /**
+     * Stops publishing the snapshots started through {@link #publishSnapshots(File, int)}. The
+     * file is left with the last published frames.
+     */
+    public void stopPublishingSnapshots() {
+        nativeCloseSnapshotRing();
+    }
+
+    /**
+     * Submits a command to be issued by the thread running the match, so any thread can command
+     * units without synchronization. Submitted commands are issued in the order they were
+     * submitted, after the listener and frame listeners have handled the frame; commands submitted
+     * later are issued on the next frame.
+     *
+     * @param unit
+     *            the unit to command
+     *
+     * @param command
+     *            the type of command
+     *
+     * @param target
+     *            the target unit, or null
+     *
+     * @param position
+     *            the target position, or null
+     *
+     * @param extra
+     *            the ID of the unit, tech or upgrade type, or the training slot, depending on the
+     *            command; 0 otherwise
+     *
+     * @return false if the command was dropped because too many commands are waiting
+     */
+    public boolean submitCommand(final Unit unit, final Command command, final Unit target,
+            final Position position, final int extra) {
+        final Position.Resolution resolution = command.takesBuildTile() ? BUILD : PIXEL;
+        return nativeSubmitCommand(unit.getId(), command.getId(),
+                (target != null) ? target.getId() : -1,
+                (position != null) ? position.getX(resolution) : 0,
+                (position != null) ? position.getY(resolution) : 0, extra);
+    }
+
+    /**
+     * Sets the lowest level of the bridge messages of a category that are logged. Messages of
+     * every category are logged from {@link BridgeLog.Level#INFO} by default.
+     *
+     * @param category
+     *            the category of messages
+     *
+     * @param level
+     *            the lowest level logged, or {@link BridgeLog.Level#OFF} to log none
+     */
+    public void setLogLevel(final BridgeLog.Category category, final BridgeLog.Level level) {
+        nativeSetLogLevel(category.ordinal(), level.ordinal());
+    }
+
+    /**
+     * Sets the handler that receives the messages of the bridge, {@link BridgeLog#CONSOLE} by
+     * default. The handler is invoked on a thread of its own.
+     *
+     * @param handler
+     *            the handler
+     */
+    public void setLogHandler(final BridgeLog.Handler handler) {
+        if (handler == null) {
+            throw new IllegalArgumentException("handler cannot be null");
+        }
+        logHandler = handler;
+    }
+
+    /**
+     * Adds a listener to be invoked every frame, regardless of the
+     * {@link #setAgentCadence(int, int) agent cadence}.
+     *
+     * @param frameListener
+     *            listener to invoke every frame
+     */
+    public void addFrameListener(final FrameListener frameListener) {
+        if (frameListener == null) {
+            throw new IllegalArgumentException("frameListener cannot be null");
+        }
+        frameListeners.add(frameListener);
+        setFrameListenersEnabled(true);
+    }
+
+    /**
+     * Removes a listener added through {@link #addFrameListener(FrameListener)}.
+     *
+     * @param frameListener
+     *            listener to remove
+     */
+    public void removeFrameListener(final FrameListener frameListener) {
+        frameListeners.remove(frameListener);
+        setFrameListenersEnabled(!frameListeners.isEmpty());
+    }
+
     /**
      * @return the remaining number of frames before a unit command sent in the current frame can be
      *         processed
@@ -275,6 +743,10 @@ public class Broodwar {
         return players.get(playerId);
     }
 
+    GameContext getContext() {
+        return context;
+    }
+
     /**
      * @return all accessible units
      */
@@ -282,6 +754,25 @@ public class Broodwar {
         return new ArrayList<>(units.values());
     }
 
+    /**
+     * Refreshes the state of a unit from the current frame. Units are updated on the frames the
+     * agent is run, so a {@link FrameListener} acting on a frame in between refreshes the units it
+     * reads first. Only the record of this unit is read, and nothing is read on frames the agent
+     * is run. A unit that is no longer accessible keeps its last state until the agent is run.
+     *
+     * @param unit
+     *            the unit to refresh
+     */
+    public void refreshUnit(final Unit unit) {
+        if (getFrame() == lastUpdateFrame) {
+            return;
+        }
+        final int[] unitData = getUnitData(unit.getId());
+        if (unitData.length > 0) {
+            unit.update(unitData, 0);
+        }
+    }
+
     /**
      * @return all accessible units owned by the agent
      */
@@ -310,6 +801,306 @@ public class Broodwar {
         return new ArrayList<>(neutralUnits);
     }
 
+    /**
+     * Returns the minerals, geysers and other neutral units that cannot move and have been there
+     * since the start of the match, while they are neutral and of their initial type. The bridge
+     * sends them once and afterwards only the attributes that changed, mostly their resources and
+     * whether they are being gathered. They are included in {@link #getNeutralUnits()} as well.
+     *
+     * @return the accessible static neutral units
+     */
+    public List<Unit> getStaticNeutralUnits() {
+        final List<Unit> result = new ArrayList<>(staticNeutralRecords.size());
+        for (final Integer unitId : staticNeutralRecords.keySet()) {
+            result.add(units.get(unitId));
+        }
+        return result;
+    }
+
+    /**
+     * Returns the accessible static neutral resources that belong to a base location, as assigned
+     * by {@link GameMap#getBaseLocation(Position)} from their initial positions.
+     *
+     * @param base
+     *            a BaseLocation of the current map
+     *
+     * @return the accessible minerals and geysers of the base location
+     */
+    public List<Unit> getStaticResources(final BaseLocation base) {
+        final List<Unit> result = new ArrayList<>();
+        for (final Integer unitId : staticNeutralRecords.keySet()) {
+            if (base.equals(staticNeutralBases.get(unitId))) {
+                result.add(units.get(unitId));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the last known state of every enemy unit seen during the match, including those that
+     * are currently out of sight.
+     *
+     * <p>
+     * Remembered units are forgotten when they are destroyed, when the last known location of a
+     * building is visible without it, or when a mobile unit has not been seen for longer than the
+     * {@link #setEnemyMemoryTimeout(int) timeout}.
+     *
+     * @return the remembered enemy units; empty during replays
+     */
+    public List<RememberedUnit> getRememberedEnemyUnits() {
+        return new ArrayList<>(rememberedEnemyUnits);
+    }
+
+    /**
+     * @return the number of accessible bullets in the current frame
+     */
+    public int getBulletCount() {
+        return bulletCount;
+    }
+
+    /**
+     * Retrieves an accessible bullet without allocating a list, for use in per-frame loops.
+     *
+     * <p>
+     * The returned Bullet is only valid during the current frame.
+     *
+     * @param index
+     *            index of the bullet, from 0 to {@link #getBulletCount()} exclusive
+     *
+     * @return the bullet at the index
+     */
+    public Bullet getBullet(final int index) {
+        if ((index < 0) || (index >= bulletCount)) {
+            throw new IndexOutOfBoundsException("index: " + index + ", count: " + bulletCount);
+        }
+        return bullets[index];
+    }
+
+    /**
+     * @return all accessible bullets in the current frame
+     */
+    public List<Bullet> getBullets() {
+        return new ArrayList<>(Arrays.asList(bullets).subList(0, bulletCount));
+    }
+
+    /**
+     * Finds the bullets that are within or heading into an area, such as Psionic Storms over a
+     * group of units or Lurker spines aimed at it.
+     *
+     * @param position
+     *            center of the area
+     *
+     * @param radius
+     *            radius of the area in pixels
+     *
+     * @return the accessible bullets whose current or target position is within the area
+     */
+    public List<Bullet> getBulletsThreatening(final Position position, final int radius) {
+        final int x = position.getX(PIXEL);
+        final int y = position.getY(PIXEL);
+        final List<Bullet> threatening = new ArrayList<>();
+        for (int i = 0; i < bulletCount; i++) {
+            if (bullets[i].isThreatening(x, y, radius)) {
+                threatening.add(bullets[i]);
+            }
+        }
+        return threatening;
+    }
+
+    /**
+     * Sets the number of frames a mobile enemy unit is remembered for after leaving vision. A
+     * negative value remembers mobile units until they are destroyed. The default is 1440 frames
+     * (one minute at fastest speed).
+     *
+     * @param frames
+     *            number of frames to remember hidden mobile units
+     */
+    public native void setEnemyMemoryTimeout(final int frames);
+
+    /**
+     * Subscribes a listener to a kind of unit transition. The bridge only detects the kinds that
+     * have at least one listener.
+     *
+     * @param transition
+     *            the kind of transition to be notified of
+     *
+     * @param transitionListener
+     *            listener to notify
+     */
+    public void addUnitTransitionListener(final UnitTransition transition,
+            final UnitTransitionListener transitionListener) {
+        if ((transition == null) || (transitionListener == null)) {
+            throw new IllegalArgumentException("transition and listener cannot be null");
+        }
+        List<UnitTransitionListener> listeners = transitionListeners.get(transition);
+        if (listeners == null) {
+            listeners = new ArrayList<>();
+            transitionListeners.put(transition, listeners);
+        }
+        listeners.add(transitionListener);
+        updateUnitTransitionMask();
+    }
+
+    /**
+     * Unsubscribes a listener from a kind of unit transition.
+     *
+     * @param transition
+     *            the kind of transition to stop being notified of
+     *
+     * @param transitionListener
+     *            listener to remove
+     */
+    public void removeUnitTransitionListener(final UnitTransition transition,
+            final UnitTransitionListener transitionListener) {
+        final List<UnitTransitionListener> listeners = transitionListeners.get(transition);
+        if ((listeners != null) && listeners.remove(transitionListener) && listeners.isEmpty()) {
+            transitionListeners.remove(transition);
+            updateUnitTransitionMask();
+        }
+    }
+
+    /**
+     * Adds a query to be evaluated by the bridge every frame the agent is run. The matching units
+     * are available through {@link UnitQuery#getUnits()} from the next frame on.
+     *
+     * @param query
+     *            the query to evaluate, which can no longer be changed once added
+     */
+    public void addUnitQuery(final UnitQuery query) {
+        if (query == null) {
+            throw new IllegalArgumentException("query cannot be null");
+        }
+        if (query.getHandle() >= 0) {
+            throw new IllegalStateException("query has already been added");
+        }
+        final int handle = nativeAddUnitQuery(query.compile());
+        if (handle < 0) {
+            throw new IllegalArgumentException("query could not be compiled");
+        }
+        query.setHandle(handle);
+        unitQueries.put(handle, query);
+    }
+
+    /**
+     * Removes a query added through {@link #addUnitQuery(UnitQuery)}.
+     *
+     * @param query
+     *            the query to stop evaluating
+     */
+    public void removeUnitQuery(final UnitQuery query) {
+        if (unitQueries.remove(query.getHandle()) != null) {
+            nativeRemoveUnitQuery(query.getHandle());
+            query.setHandle(-1);
+        }
+    }
+
+    /**
+     * Adds feature planes to be written into a buffer every frame the agent is run, see
+     * {@link FeaturePlanes}. The buffer is written from index 0 and may be read by the agent while
+     * it handles the frame. The planes stay added for later matches; on a map they do not fit the
+     * buffer, they are not written and the bridge logs a warning once per match.
+     *
+     * @param planes
+     *            the feature planes to write
+     *
+     * @param buffer
+     *            a direct buffer in the native byte order with room for the planes on the current
+     *            map, such as one allocated by {@link FeaturePlanes#allocateBuffer(GameMap)}
+     *
+     * @throws IllegalStateException
+     *             thrown if the planes have already been added or the match has not started
+     */
+    public void addFeaturePlanes(final FeaturePlanes planes, final FloatBuffer buffer) {
+        if ((planes == null) || (buffer == null)) {
+            throw new IllegalArgumentException("planes and buffer cannot be null");
+        }
+        if (planes.getHandle() >= 0) {
+            throw new IllegalStateException("feature planes have already been added");
+        }
+        if (map == null) {
+            throw new IllegalStateException("match has not started");
+        }
+        if (!buffer.isDirect() || (buffer.order() != ByteOrder.nativeOrder())) {
+            throw new IllegalArgumentException("buffer must be direct and in native byte order");
+        }
+        if (buffer.capacity() < planes.getCapacity(map)) {
+            throw new IllegalArgumentException(
+                    "buffer must hold at least " + planes.getCapacity(map) + " floats");
+        }
+        final int handle = nativeAddFeaturePlanes(planes.compile(), buffer);
+        if (handle < 0) {
+            throw new IllegalArgumentException("feature planes could not be compiled");
+        }
+        planes.setHandle(handle);
+        featurePlanes.put(handle, planes);
+    }
+
+    /**
+     * Removes feature planes added through {@link #addFeaturePlanes(FeaturePlanes, FloatBuffer)}.
+     *
+     * @param planes
+     *            the feature planes to stop writing
+     */
+    public void removeFeaturePlanes(final FeaturePlanes planes) {
+        if (featurePlanes.remove(planes.getHandle()) != null) {
+            nativeRemoveFeaturePlanes(planes.getHandle());
+            planes.setHandle(-1);
+        }
+    }
+
+    /**
+     * Adds a fence whose crossings are detected by the bridge every frame, see {@link Geofence}.
+     * The crossings are delivered to the listener before {@link BroodwarListener#matchFrame()}.
+     * Fences are removed when the next match starts.
+     *
+     * @param fence
+     *            the fence to watch
+     *
+     * @param fenceListener
+     *            the listener to notify of units entering and leaving the fence
+     *
+     * @throws IllegalStateException
+     *             thrown if the fence has already been added or the match has not started
+     */
+    public void addGeofence(final Geofence fence, final GeofenceListener fenceListener) {
+        if ((fence == null) || (fenceListener == null)) {
+            throw new IllegalArgumentException("fence and listener cannot be null");
+        }
+        if (fence.getHandle() >= 0) {
+            throw new IllegalStateException("fence has already been added");
+        }
+        if (map == null) {
+            throw new IllegalStateException("match has not started");
+        }
+        final int handle = nativeAddGeofence(fence.compile());
+        if (handle < 0) {
+            throw new IllegalArgumentException("fence could not be compiled");
+        }
+        fence.setHandle(handle, fenceListener);
+        geofences.put(handle, fence);
+    }
+
+    /**
+     * Removes a fence added through {@link #addGeofence(Geofence, GeofenceListener)}.
+     *
+     * @param fence
+     *            the fence to stop watching
+     */
+    public void removeGeofence(final Geofence fence) {
+        if (geofences.remove(fence.getHandle()) != null) {
+            nativeRemoveGeofence(fence.getHandle());
+            fence.setHandle(-1, null);
+        }
+    }
+
+    private void updateUnitTransitionMask() {
+        int mask = 0;
+        for (final UnitTransition transition : transitionListeners.keySet()) {
+            mask |= transition.getMask();
+        }
+        setUnitTransitionMask(mask);
+    }
+
     /**
      * Convenience method for retrieving all units owned by a specific player.
      *
@@ -339,6 +1130,13 @@ public class Broodwar {
         return map;
     }
 
+    /**
+     * @return the regions Broodwar divides the map of the current match into for path finding
+     */
+    public RegionGraph getRegionGraph() {
+        return regionGraph;
+    }
+
     /**
      * Indicates if the specified build position is visible.
      *
@@ -1190,27 +1988,6 @@ public class Broodwar {
     // Static Methods
     // *********************************************************************************************
 
-    private static void loadNativeDependencies() {
-        final String base = "src/main/resources/x86/dll";
-
-        // the order is important
-        loadNativeLibrary(new File(base, "gmp-vc90-mt.dll"));
-        loadNativeLibrary(new File(base, "mpfr-vc90-mt.dll"));
-        loadNativeLibrary(new File(base, "client-bridge.dll"));
-    }
-
-    private static void loadNativeLibrary(final File dll) {
-        try {
-            System.load(dll.getAbsolutePath());
-        } catch (final UnsatisfiedLinkError ex) {
-            if (!dll.exists()) {
-                System.err.println("Native code library not found: " + dll.getAbsolutePath());
-            } else {
-                System.err.println("Native code library failed to load: " + ex.toString());
-            }
-        }
-    }
-
     private static Charset getKoreanCharset() {
         try {
             return Charset.forName("Cp949");
@@ -1282,9 +2059,9 @@ public class Broodwar {
 
         // bullet types
         final int[] bulletTypeData = getBulletTypes();
-        for (int index = 0; index < bulletTypeData.length; index += Bullet.NUM_ATTRIBUTES) {
+        for (int index = 0; index < bulletTypeData.length; index += Type.Bullet.NUM_ATTRIBUTES) {
             final int id = bulletTypeData[index];
-            Bullet.getBulletType(id).initialize(bulletTypeData, index, getBulletTypeName(id));
+            Type.Bullet.getBulletType(id).initialize(bulletTypeData, index, getBulletTypeName(id));
         }
 
         // damage types
@@ -1331,14 +2108,21 @@ public class Broodwar {
      */
     void gameStarted() {
         self = null;
+        lastUpdateFrame = -1;
+        for (final Geofence fence : geofences.values()) {
+            fence.setHandle(-1, null);
+        }
+        geofences.clear();
         allies.clear();
         enemies.clear();
         players.clear();
 
         final int[] playerData = getPlayersData();
+        final String[] playerNames = new String[playerData.length / Player.NUM_ATTRIBUTES];
         for (int index = 0; index < playerData.length; index += Player.NUM_ATTRIBUTES) {
             final String name = new String(getPlayerName(playerData[index]), CHARACTER_SET);
             final Player player = new Player(playerData, index, name);
+            playerNames[index / Player.NUM_ATTRIBUTES] = name;
 
             players.put(player.getId(), player);
 
@@ -1359,11 +2143,15 @@ public class Broodwar {
         alliedUnits.clear();
         enemyUnits.clear();
         neutralUnits.clear();
+        rememberedEnemyUnits.clear();
+        staticNeutralRecords.clear();
+        staticNeutralBases.clear();
+        bulletCount = 0;
         final int[] unitData = getAllUnitsData();
 
         for (int index = 0; index < unitData.length; index += Unit.NUM_ATTRIBUTES) {
             final int id = unitData[index];
-            final Unit unit = new Unit(id, this);
+            final Unit unit = createUnit(id);
             unit.update(unitData, index);
 
             units.put(id, unit);
@@ -1381,9 +2169,100 @@ public class Broodwar {
             }
         }
         loadMapData();
+        regionGraph = new RegionGraph(getRegionGraphData(), getMapWidth(), getMapHeight());
+        setTileRegions(map.getTileRegions());
+        updateStaticNeutrals();
+        if (agentServer != null) {
+            agentServer.matchStarted(getMapHash(), playerData, playerNames,
+                    withStaticNeutrals(unitData));
+        }
+    }
+
+    /**
+     * Applies the changes of the static neutral units, which {@link #getAllUnitsData()} leaves out,
+     * and adds them to the neutral units.
+     */
+    private void updateStaticNeutrals() {
+        final int[] update = getStaticNeutralUpdate();
+        int index = 0;
+
+        // units that are no longer static neutrals stay until they are missing from the unit data
+        final int leftCount = update[index++];
+        for (int i = 0; i < leftCount; i++) {
+            staticNeutralRecords.remove(update[index++]);
+        }
+
+        final int changesEnd = index + 1 + (update[index] * 3);
+        index++;
+        while (index < changesEnd) {
+            final int id = update[index];
+            final int[] record = staticNeutralRecords.get(id);
+            while ((index < changesEnd) && (update[index] == id)) {
+                record[update[index + 1]] = update[index + 2];
+                index += 3;
+            }
+            units.get(id).update(record, 0);
+        }
+
+        for (; index < update.length; index += Unit.NUM_ATTRIBUTES) {
+            final int id = update[index];
+            final int[] record = Arrays.copyOfRange(update, index, index + Unit.NUM_ATTRIBUTES);
+            staticNeutralRecords.put(id, record);
+            Unit unit = units.get(id);
+            if (unit == null) {
+                unit = createUnit(id);
+                units.put(id, unit);
+            }
+            unit.update(record, 0);
+            if ((map != null) && unit.getInitialType().isResourceContainer()
+                    && !staticNeutralBases.containsKey(id)) {
+                staticNeutralBases.put(id, map.getBaseLocation(unit.getInitialPosition()));
+            }
+        }
+
+        for (final Integer unitId : staticNeutralRecords.keySet()) {
+            neutralUnits.add(units.get(unitId));
+        }
+    }
+
+    // The unit data with the static neutral units, for the consumers of whole frames.
+    private int[] withStaticNeutrals(final int[] unitData) {
+        final int[] all = Arrays.copyOf(unitData,
+                unitData.length + (staticNeutralRecords.size() * Unit.NUM_ATTRIBUTES));
+        int index = unitData.length;
+        for (final int[] record : staticNeutralRecords.values()) {
+            System.arraycopy(record, 0, all, index, Unit.NUM_ATTRIBUTES);
+            index += Unit.NUM_ATTRIBUTES;
+        }
+        return all;
     }
 
     private void loadMapData() {
+        final String hash = getMapHash();
+        map = MapCache.get(hash);
+        if (map != null) {
+            return;
+        }
+
+        // a map file recorded in an earlier run, possibly analyzed ahead of time by MapAnalyzer
+        final File mapFile = new File("bwta/", hash + GameMap.FILE_EXTENSION);
+        if (mapFile.exists()) {
+            try {
+                map = GameMap.read(mapFile);
+            } catch (final IOException ex) {
+                System.err.println("Map data could not be loaded.");
+                System.err.println(ex.getMessage());
+            }
+            if (map != null) {
+                // files recorded before the regions were exported get them once, before caching
+                if (!map.hasRegions() && loadRegions(false)) {
+                    writeMapFile(mapFile);
+                }
+                MapCache.put(hash, map);
+                return;
+            }
+        }
+
         final String mapName = new String(getMapName(), CHARACTER_SET);
         final String fileName = getMapFileName();
         final int x = getMapWidth();
@@ -1393,10 +2272,44 @@ public class Broodwar {
         final int[] walkable = getWalkableData();
 
         map = new GameMap(mapName, fileName, x, y, z, buildable, walkable);
-        loadMapDetails();
+        if (loadMapDetails()) {
+            MapCache.put(hash, map);
+            writeMapFile(mapFile);
+        }
     }
 
-    private void loadMapDetails() {
+    private void writeMapFile(final File mapFile) {
+        try {
+            map.write(mapFile);
+        } catch (final IOException ex) {
+            System.err.println("Map data could not be cached.");
+            System.err.println(ex.getMessage());
+        }
+    }
+
+    /**
+     * Loads the regions of the map from the native terrain analysis, running it unless it has just
+     * analyzed the map. The BWTA analysis does not provide regions.
+     *
+     * @return true if the regions were loaded; false otherwise
+     */
+    private boolean loadRegions(final boolean analyzed) {
+        if (TerrainAnalyzer.isBwtaSelected()) {
+            return false;
+        }
+        if (!analyzed) {
+            analyzeTerrain();
+        }
+        map.setRegions(getTerrainRegions());
+        return map.hasRegions();
+    }
+
+    /**
+     * Loads the base locations from the map data file, analyzing the map if there is none.
+     *
+     * @return true if the base locations were loaded; false otherwise
+     */
+    private boolean loadMapDetails() {
         final String mapDataCacheFileName = map.getName() + ".jbwta";
         final File mapDataCacheFile = new File("bwta/", mapDataCacheFileName);
 
@@ -1417,7 +2330,8 @@ public class Broodwar {
                 br.close();
 
                 map.setBaseLocations(bases);
-                return;
+                loadRegions(false);
+                return true;
 
             } catch (final IOException ex) {
                 System.err.println("Map data could not be loaded.");
@@ -1425,8 +2339,13 @@ public class Broodwar {
             }
         }
 
-        analyzeTerrain();
-        final int[] bases = getBaseLocations();
+        final int[] bases = TerrainAnalyzer.isBwtaSelected()
+                ? TerrainAnalyzer.analyzeBaseLocations(getGameHandle()) : analyzeTerrain();
+        if (bases == null) {
+            System.err.println("Map data could not be analyzed.");
+            return false;
+        }
+        loadRegions(true);
 
         try {
             if (!mapDataCacheFile.getParentFile().exists()) {
@@ -1439,10 +2358,12 @@ public class Broodwar {
             bw.close();
 
             map.setBaseLocations(bases);
+            return true;
 
         } catch (final Exception ex) {
             System.err.println("Map data could not be cached.");
             System.err.println(ex.getMessage());
+            return false;
         }
     }
 
@@ -1488,17 +2409,50 @@ public class Broodwar {
      * C++ callback function.
      */
     void gameUpdate() {
+        lastUpdateFrame = getFrame();
+        final int exportFrame = (replayExport != null) ? getFrame() : 0;
+        if (replayExport != null) {
+            try {
+                replayExport.beginFrame(exportFrame);
+            } catch (final IOException ex) {
+                stopReplayExport(ex);
+            }
+        }
+        if (agentServer != null) {
+            agentServer.beginFrame(getFrame());
+        }
+
         // update game state
         if (!isReplay()) {
-            self.update(getPlayerUpdate(self.getId()));
+            final int[] playerData = getPlayerUpdate(self.getId());
+            self.update(playerData);
+            if (agentServer != null) {
+                agentServer.addPlayer(self.getId(), playerData);
+            }
             self.updateResearch(getResearchStatus(self.getId()), getUpgradeStatus(self.getId()));
         } else {
             for (final Integer playerId : players.keySet()) {
-                players.get(playerId).update(getPlayerUpdate(playerId));
+                final int[] playerData = getPlayerUpdate(playerId);
+                players.get(playerId).update(playerData);
+                if (replayExport != null) {
+                    replayExport.addPlayer(exportFrame, playerId, playerData);
+                }
+                if (agentServer != null) {
+                    agentServer.addPlayer(playerId, playerData);
+                }
                 players.get(playerId).updateResearch(getResearchStatus(playerId),
                         getUpgradeStatus(playerId));
             }
         }
+        // refresh the effective stats of players whose upgrades or research changed
+        final int[] statsVersions = getPlayerStatsVersions();
+        for (int index = 0; index < statsVersions.length; index += 2) {
+            final Player player = players.get(statsVersions[index]);
+            if ((player != null) && (player.getStatsVersion() != statsVersions[index + 1])) {
+                player.updateStats(statsVersions[index + 1], getPlayerStats(player.getId()));
+            }
+        }
+
         // update units
         final int[] unitData = getAllUnitsData();
         final HashSet<Integer> deadUnits = new HashSet<>(units.keySet());
@@ -1506,6 +2460,17 @@ public class Broodwar {
         alliedUnits.clear();
         enemyUnits.clear();
         neutralUnits.clear();
+        updateStaticNeutrals();
+        deadUnits.removeAll(staticNeutralRecords.keySet());
+        if ((replayExport != null) || (agentServer != null)) {
+            final int[] frameUnits = withStaticNeutrals(unitData);
+            if (replayExport != null) {
+                replayExport.addUnits(exportFrame, frameUnits);
+            }
+            if (agentServer != null) {
+                agentServer.addUnits(frameUnits);
+            }
+        }
 
         for (int index = 0; index < unitData.length; index += Unit.NUM_ATTRIBUTES) {
             final int id = unitData[index];
@@ -1514,7 +2479,7 @@ public class Broodwar {
 
             Unit unit = units.get(id);
             if (unit == null) {
-                unit = new Unit(id, this);
+                unit = createUnit(id);
                 units.put(id, unit);
             }
 
@@ -1544,6 +2509,80 @@ public class Broodwar {
             units.get(unitID).setDestroyed();
             units.remove(unitID);
         }
+
+        // collect the matches of the unit queries
+        if (!unitQueries.isEmpty()) {
+            final int[] queryData = getUnitQueryResults();
+            int index = 0;
+            while (index < queryData.length) {
+                final UnitQuery query = unitQueries.get(queryData[index++]);
+                final int count = queryData[index++];
+                final List<Unit> matches = new ArrayList<>(count);
+                for (int i = 0; i < count; i++) {
+                    final Unit unit = units.get(queryData[index++]);
+                    if (unit != null) {
+                        matches.add(unit);
+                    }
+                }
+                query.setUnits(Collections.unmodifiableList(matches));
+            }
+        }
+
+        // write the feature planes
+        if (!featurePlanes.isEmpty()) {
+            buildFeaturePlanes();
+        }
+
+        // update bullets
+        bulletCount = getBulletsData(bulletData);
+
+        // update the enemy memory
+        rememberedEnemyUnits.clear();
+        final int[] memoryData = getEnemyMemoryData();
+        for (int index = 0; index < memoryData.length; index += RememberedUnit.NUM_ATTRIBUTES) {
+            rememberedEnemyUnits.add(new RememberedUnit(memoryData, index, this));
+        }
+
+        // notify the listeners of the geofences that units crossed
+        if (!geofences.isEmpty()) {
+            final int[] crossingData = getGeofenceCrossings();
+            for (int index = 0; index < crossingData.length; index += 3) {
+                final Geofence fence = geofences.get(crossingData[index]);
+                if (fence == null) {
+                    continue;
+                }
+                if (crossingData[index + 2] != 0) {
+                    final Unit unit = units.get(crossingData[index + 1]);
+                    if (unit != null) {
+                        fence.unitEntered(unit);
+                    }
+                } else {
+                    fence.unitLeft(crossingData[index + 1]);
+                }
+            }
+        }
+    }
+
+    /**
+     * Notifies the frame listeners that a frame has passed.
+     *
+     * <p>
+     * C++ callback function.
+     *
+     * @param frame
+     *            the current frame
+     */
+    void frameTick(final int frame) {
+        if ((frame != lastUpdateFrame) && (self != null)) {
+            self.update(getPlayerUpdate(self.getId()));
+        }
+        for (final FrameListener frameListener : frameListeners) {
+            frameListener.everyFrame(frame);
+        }
+    }
+
+    private Unit createUnit(final int id) {
+        return flyweightUnits ? new UnitView(id, this) : new Unit(id, this);
     }
 
     /**
@@ -1579,151 +2618,90 @@ public class Broodwar {
      *            third parameter for the event
      */
     void eventOccurred(final int eventTypeId, final int p1, final int p2, final String p3) {
+        if (replayExport != null) {
+            replayExport.addEvent(getFrame(), eventTypeId, p1, p2);
+        }
 
         final EventType event = EventType.getEventType(eventTypeId);
-        switch (event) {
-            case MATCH_START :
-                listener.matchStart();
-                break;
-
-            case MATCH_END :
-                listener.matchEnd(p1 == 1);
-                break;
-
-            case MATCH_FRAME :
-                listener.matchFrame();
-                break;
-
-            case MENU_FRAME :
-                // Not currently used.
-                break;
-
-            case SEND_TEXT :
-                listener.sendText(p3);
-                break;
-
-            case RECEIVE_TEXT :
-                listener.receiveText(p3);
-                break;
-
-            case PLAYER_LEFT :
-                listener.playerLeft(players.get(p1));
-                break;
-
-            case NUKE_DETECT :
-                if ((p1 == -1) || (p2 == -1)) {
-                    listener.nukeDetect(Position.UNKNOWN);
-                } else {
-                    listener.nukeDetect(new Position(p1, p2, PIXEL));
-                }
-                break;
-
-            case UNIT_DISCOVER :
-                listener.unitDiscover(units.get(p1));
-                break;
-
-            case UNIT_EVADE :
-                listener.unitEvade(units.get(p1));
-                break;
-
-            case UNIT_SHOW :
-                listener.unitShow(units.get(p1));
-                break;
-
-            case UNIT_HIDE :
-                listener.unitHide(units.get(p1));
-                break;
-
-            case UNIT_CREATE :
-                listener.unitCreate(units.get(p1));
-                break;
-
-            case UNIT_DESTROY :
-                listener.unitDestroy(units.get(p1));
-                break;
-
-            case UNIT_MORPH :
-                listener.unitMorph(units.get(p1));
-                break;
-
-            case UNIT_RENEGADE :
-                listener.unitRenegade(units.get(p1));
-                break;
-
-            case SAVE_GAME :
-                listener.saveGame(p3);
-                break;
-
-            case UNIT_COMPLETE :
-                listener.unitComplete(units.get(p1));
-                break;
-
-            case PLAYER_DROPPED :
-                listener.playerDropped(players.get(p1));
-                break;
-
-            case NONE :
-                // Not currently used.
-                break;
-
-            default :
-                break;
+        if (agentServer != null) {
+            if (event == EventType.MATCH_FRAME) {
+                agentServer.endFrame();
+            } else if (event == EventType.MATCH_END) {
+                agentServer.matchEnded(p1 == 1);
+            } else if (event != EventType.MATCH_START) {
+                agentServer.addEvent(eventTypeId, p1, p2, p3);
+            }
         }
-    }
-
-    private enum EventType {
-        MATCH_START,
-        MATCH_END,
-        MATCH_FRAME,
-        MENU_FRAME,
-        SEND_TEXT,
-        RECEIVE_TEXT,
-        PLAYER_LEFT,
-        NUKE_DETECT,
-        UNIT_DISCOVER,
-        UNIT_EVADE,
-        UNIT_SHOW,
-        UNIT_HIDE,
-        UNIT_CREATE,
-        UNIT_DESTROY,
-        UNIT_MORPH,
-        UNIT_RENEGADE,
-        SAVE_GAME,
-        UNIT_COMPLETE,
-        PLAYER_DROPPED,
-        NONE;
-
-        public static EventType getEventType(final int id) {
-            return EventType.values()[id];
+        event.notifyListener(listener, context, p1, p2, p3);
+        if ((event == EventType.MATCH_END) && (replayExport != null)) {
+            stopReplayExport(null);
         }
     }
 
     /**
-     * Notifies the event listener that a key was pressed.
+     * Notifies the subscribed listeners of a unit transition. Transitions are queued with the
+     * events, so they are delivered after the events of earlier frames and before the events of
+     * the frame they were detected in.
      *
      * <p>
      * C++ callback function.
      *
-     * @param keyCode
-     *            key pressed by the user
+     * @param transitionId
+     *            id of the transition
+     *
+     * @param unitId
+     *            id of the unit that changed
+     *
+     * @param value
+     *            additional information dependent on the kind of transition
      */
-    void keyPressed(final int keyCode) {
-        listener.keyPressed(keyCode);
+    void unitTransition(final int transitionId, final int unitId, final int value) {
+        final UnitTransition transition = UnitTransition.getTransition(transitionId);
+        final Unit unit = units.get(unitId);
+        final List<UnitTransitionListener> listeners = transitionListeners.get(transition);
+        if ((unit != null) && (listeners != null)) {
+            for (final UnitTransitionListener transitionListener : listeners) {
+                transitionListener.unitTransition(unit, transition, value);
+            }
+        }
     }
 
     /**
-     * Utility function for printing to the java console from C++.
+     * Notifies the event listener that a key was pressed.
      *
      * <p>
      * C++ callback function.
+     *
+     * @param keyCode
+     *            key pressed by the user
      */
-    void javaPrint(final String msg) {
-        // TODO: Allow agent to decide how best to print the message.
-        System.out.println("Bridge: " + msg);
+    void keyPressed(final int keyCode) {
+        listener.keyPressed(keyCode);
     }
 
     private native void nativeConnect(final Broodwar broodwar);
 
+    private native void nativeSetLogLevel(final int category, final int level);
+
+    private native byte[] drainLog();
+
+    private native boolean nativeOpenSnapshotRing(final String path, final int slots,
+            final int maxUnits);
+
+    private native void nativeCloseSnapshotRing();
+
+    private native boolean issueCommand(final int unitId, final int commandId, final int targetId,
+            final int x, final int y, final int extra);
+
+    private native boolean nativeSubmitCommand(final int unitId, final int commandId,
+            final int targetId, final int x, final int y, final int extra);
+
+    private native void setEventMask(final int mask);
+
+    private native void nativeSetAgentCadence(final int frames, final int frameBudget);
+
+    private native void setFrameListenersEnabled(final boolean enabled);
+
     private native void nativeEnableUserInput();
 
     private native void nativeEnablePerfectInformation();
@@ -1736,6 +2714,12 @@ public class Broodwar {
 
     private native int[] getAllUnitsData();
 
+    private native int[] getUnitData(final int unitId);
+
+    private native int[] getStaticNeutralUpdate();
+
+    private native int[] compareUnitRecords();
+
     private native int[] getPlayerUpdate(final int playerId);
 
     private native byte[] getPlayerName(final int playerId);
@@ -1744,6 +2728,36 @@ public class Broodwar {
 
     private native int[] getUpgradeStatus(final int playerId);
 
+    private native int[] getPlayerStatsVersions();
+
+    private native int[] getPlayerStats(final int playerId);
+
+    private native int[] getEnemyMemoryData();
+
+    private native int getBulletsData(final int[] buffer);
+
+    private native void setUnitTransitionMask(final int mask);
+
+    private native int nativeAddUnitQuery(final int[] code);
+
+    private native void nativeRemoveUnitQuery(final int handle);
+
+    private native int[] getUnitQueryResults();
+
+    private native int nativeAddFeaturePlanes(final int[] description, final FloatBuffer buffer);
+
+    private native void nativeRemoveFeaturePlanes(final int handle);
+
+    private native void buildFeaturePlanes();
+
+    private native void setTileRegions(final int[] regions);
+
+    private native int nativeAddGeofence(final int[] description);
+
+    private native void nativeRemoveGeofence(final int handle);
+
+    private native int[] getGeofenceCrossings();
+
     private native int[] getRaceTypes();
 
     private native String getRaceTypeName(final int unitTypeId);
@@ -1794,12 +2808,20 @@ public class Broodwar {
     // Map Commands
     // *********************************************************************************************
 
-    private native void analyzeTerrain();
+    private native int[] analyzeTerrain();
+
+    private native int[] getTerrainRegions();
+
+    private native int[] getRegionGraphData();
+
+    private native long getGameHandle();
 
     private native byte[] getMapName();
 
     private native String getMapFileName();
 
+    private native String getMapHash();
+
     private native int getMapWidth();
 
     private native int getMapHeight();
@@ -1809,6 +2831,4 @@ public class Broodwar {
     private native int[] getWalkableData();
 
     private native int[] getBuildableData();
-
-    private native int[] getBaseLocations();
 }
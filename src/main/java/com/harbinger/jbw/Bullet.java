@@ -0,0 +1,232 @@
+package com.harbinger.jbw;
+
+import com.harbinger.jbw.Position.Resolution;
+
+/**
+ * Represents a projectile or spell effect in flight, such as a Psionic Storm, a Lurker spine or a
+ * Spider Mine explosion.
+ *
+ * <p>
+ * Bullets are views over the bullet snapshot that the bridge writes every frame, so a Bullet is
+ * only valid during the frame it was retrieved in. Copy the values of interest if they need to be
+ * kept for longer.
+ */
+public class Bullet {
+
+    // BEGIN GENERATED bullet.size
+    static final int NUM_ATTRIBUTES = 14;
+    // END GENERATED bullet.size
+
+    /** The maximum number of bullets BWAPI tracks at any one time. */
+    static final int MAX_BULLETS = 100;
+
+    private static final double TO_DEGREES = 180.0 / Math.PI;
+    private static final double FIXED_SCALE = 100.0;
+
+    private final Broodwar broodwar;
+    private final int[] data;
+    private final int offset;
+
+    Bullet(final int[] data, final int offset, final Broodwar broodwar) {
+        this.data = data;
+        this.offset = offset;
+        this.broodwar = broodwar;
+    }
+
+    /**
+     * @return the unique ID of this bullet
+     */
+    public int getId() {
+        return id();
+    }
+
+    /**
+     * @return the Player that fired this bullet or null if unknown
+     */
+    public Player getPlayer() {
+        return broodwar.getPlayer(playerId());
+    }
+
+    /**
+     * @return the type of this bullet
+     */
+    public Type.Bullet getType() {
+        return Type.Bullet.getBulletType(typeId());
+    }
+
+    /**
+     * @return the Unit that fired this bullet or null if it is not accessible
+     */
+    public Unit getSource() {
+        return broodwar.getUnit(sourceId());
+    }
+
+    /**
+     * @return the current (pixel) Position of this bullet
+     */
+    public Position getPosition() {
+        return new Position(getX(), getY(), Resolution.PIXEL);
+    }
+
+    /**
+     * @return the current x pixel coordinate of this bullet
+     */
+    public int getX() {
+        return x();
+    }
+
+    /**
+     * @return the current y pixel coordinate of this bullet
+     */
+    public int getY() {
+        return y();
+    }
+
+    /**
+     * @return the direction this bullet is facing, in radians
+     */
+    public double getAngle() {
+        return angle();
+    }
+
+    /**
+     * @return the horizontal velocity of this bullet, in pixels per frame
+     */
+    public double getVelocityX() {
+        return velocityX();
+    }
+
+    /**
+     * @return the vertical velocity of this bullet, in pixels per frame
+     */
+    public double getVelocityY() {
+        return velocityY();
+    }
+
+    /**
+     * @return the Unit this bullet is heading towards or null if it has no accessible target
+     */
+    public Unit getTarget() {
+        return broodwar.getUnit(targetId());
+    }
+
+    /**
+     * @return the (pixel) Position this bullet is heading towards
+     */
+    public Position getTargetPosition() {
+        return new Position(getTargetX(), getTargetY(), Resolution.PIXEL);
+    }
+
+    /**
+     * @return the x pixel coordinate this bullet is heading towards
+     */
+    public int getTargetX() {
+        return targetX();
+    }
+
+    /**
+     * @return the y pixel coordinate this bullet is heading towards
+     */
+    public int getTargetY() {
+        return targetY();
+    }
+
+    /**
+     * @return the number of frames before this bullet is removed, or 0 if it has no time limit
+     */
+    public int getRemoveTimer() {
+        return removeTimer();
+    }
+
+    /**
+     * @return true if this bullet is visible to the agent; false otherwise
+     */
+    public boolean isVisible() {
+        return visible();
+    }
+
+    /**
+     * Checks whether this bullet is within or heading into a circular area.
+     *
+     * @param x
+     *            x pixel coordinate of the area's center
+     *
+     * @param y
+     *            y pixel coordinate of the area's center
+     *
+     * @param radius
+     *            radius of the area in pixels
+     *
+     * @return true if either the current or target position of this bullet is within the area;
+     *         false otherwise
+     */
+    public boolean isThreatening(final int x, final int y, final int radius) {
+        final long r2 = (long) radius * radius;
+        final long dx = getX() - x;
+        final long dy = getY() - y;
+        if (((dx * dx) + (dy * dy)) <= r2) {
+            return true;
+        }
+        final long tx = getTargetX() - x;
+        final long ty = getTargetY() - y;
+        return ((tx * tx) + (ty * ty)) <= r2;
+    }
+
+    // BEGIN GENERATED bullet.view
+    private int id() {
+        return data[offset + 0];
+    }
+
+    private int playerId() {
+        return data[offset + 1];
+    }
+
+    private int typeId() {
+        return data[offset + 2];
+    }
+
+    private int sourceId() {
+        return data[offset + 3];
+    }
+
+    private int x() {
+        return data[offset + 4];
+    }
+
+    private int y() {
+        return data[offset + 5];
+    }
+
+    private double angle() {
+        return data[offset + 6] / TO_DEGREES;
+    }
+
+    private double velocityX() {
+        return data[offset + 7] / FIXED_SCALE;
+    }
+
+    private double velocityY() {
+        return data[offset + 8] / FIXED_SCALE;
+    }
+
+    private int targetId() {
+        return data[offset + 9];
+    }
+
+    private int targetX() {
+        return data[offset + 10];
+    }
+
+    private int targetY() {
+        return data[offset + 11];
+    }
+
+    private int removeTimer() {
+        return data[offset + 12];
+    }
+
+    private boolean visible() {
+        return data[offset + 13] == 1;
+    }
+    // END GENERATED bullet.view
+}
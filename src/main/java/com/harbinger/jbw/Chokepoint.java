@@ -0,0 +1,77 @@
+package com.harbinger.jbw;
+
+import com.harbinger.jbw.Position.Resolution;
+
+import java.util.List;
+
+/**
+ * Represents a narrow passage between two Regions, as found by the native terrain analysis.
+ */
+public class Chokepoint {
+
+    // BEGIN GENERATED terrainChokepoint.size
+    static final int NUM_ATTRIBUTES = 5;
+    // END GENERATED terrainChokepoint.size
+
+    private final Region first;
+    private final Region second;
+    private final Position center;
+    private final int width;
+
+    Chokepoint(final int[] data, int index, final List<Region> regions) {
+        // BEGIN GENERATED terrainChokepoint.decode
+        final int regionA = data[index++];
+        final int regionB = data[index++];
+        final int x = data[index++];
+        final int y = data[index++];
+        final int width = data[index++];
+        // END GENERATED terrainChokepoint.decode
+        first = regions.get(regionA);
+        second = regions.get(regionB);
+        center = new Position(x, y, Resolution.WALK);
+        this.width = width;
+    }
+
+    /**
+     * @return one of the Regions the Chokepoint connects
+     */
+    public Region getFirstRegion() {
+        return first;
+    }
+
+    /**
+     * @return the other Region the Chokepoint connects
+     */
+    public Region getSecondRegion() {
+        return second;
+    }
+
+    /**
+     * @param region
+     *            one of the Regions the Chokepoint connects
+     *
+     * @return the Region on the other side of the Chokepoint
+     */
+    public Region getOtherRegion(final Region region) {
+        return (region == first) ? second : first;
+    }
+
+    /**
+     * @return the middle of the passage
+     */
+    public Position getCenter() {
+        return center;
+    }
+
+    /**
+     * @return the width of the passage at its middle, in pixels
+     */
+    public int getWidth() {
+        return width * 8;
+    }
+
+    @Override
+    public String toString() {
+        return "Chokepoint " + first.getId() + "-" + second.getId() + " at " + center;
+    }
+}
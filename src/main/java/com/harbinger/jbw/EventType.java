@@ -0,0 +1,133 @@
+package com.harbinger.jbw;
+
+import static com.harbinger.jbw.Position.Resolution.PIXEL;
+
+/**
+ * The BWAPI events delivered to the {@link BroodwarListener}, in the order of their IDs.
+ */
+enum EventType {
+    MATCH_START,
+    MATCH_END,
+    MATCH_FRAME,
+    MENU_FRAME,
+    SEND_TEXT,
+    RECEIVE_TEXT,
+    PLAYER_LEFT,
+    NUKE_DETECT,
+    UNIT_DISCOVER,
+    UNIT_EVADE,
+    UNIT_SHOW,
+    UNIT_HIDE,
+    UNIT_CREATE,
+    UNIT_DESTROY,
+    UNIT_MORPH,
+    UNIT_RENEGADE,
+    SAVE_GAME,
+    UNIT_COMPLETE,
+    PLAYER_DROPPED,
+    NONE;
+
+    public static EventType getEventType(final int id) {
+        return EventType.values()[id];
+    }
+
+    int getMask() {
+        return 1 << ordinal();
+    }
+
+    /**
+     * Notifies the listener of an event of this type. The meaning of the parameters is dependent on
+     * the event type itself.
+     */
+    void notifyListener(final BroodwarListener listener, final GameContext context, final int p1,
+            final int p2, final String p3) {
+        switch (this) {
+            case MATCH_START :
+                listener.matchStart();
+                break;
+
+            case MATCH_END :
+                listener.matchEnd(p1 == 1);
+                break;
+
+            case MATCH_FRAME :
+                listener.matchFrame();
+                break;
+
+            case MENU_FRAME :
+                // Not currently used.
+                break;
+
+            case SEND_TEXT :
+                listener.sendText(p3);
+                break;
+
+            case RECEIVE_TEXT :
+                listener.receiveText(p3);
+                break;
+
+            case PLAYER_LEFT :
+                listener.playerLeft(context.getPlayer(p1));
+                break;
+
+            case NUKE_DETECT :
+                if ((p1 == -1) || (p2 == -1)) {
+                    listener.nukeDetect(Position.UNKNOWN);
+                } else {
+                    listener.nukeDetect(new Position(p1, p2, PIXEL));
+                }
+                break;
+
+            case UNIT_DISCOVER :
+                listener.unitDiscover(context.getUnit(p1));
+                break;
+
+            case UNIT_EVADE :
+                listener.unitEvade(context.getUnit(p1));
+                break;
+
+            case UNIT_SHOW :
+                listener.unitShow(context.getUnit(p1));
+                break;
+
+            case UNIT_HIDE :
+                listener.unitHide(context.getUnit(p1));
+                break;
+
+            case UNIT_CREATE :
+                listener.unitCreate(context.getUnit(p1));
+                break;
+
+            case UNIT_DESTROY :
+                listener.unitDestroy(context.getUnit(p1));
+                break;
+
+            case UNIT_MORPH :
+                listener.unitMorph(context.getUnit(p1));
+                break;
+
+            case UNIT_RENEGADE :
+                listener.unitRenegade(context.getUnit(p1));
+                break;
+
+            case SAVE_GAME :
+                listener.saveGame(p3);
+                break;
+
+            case UNIT_COMPLETE :
+                listener.unitComplete(context.getUnit(p1));
+                break;
+
+            case PLAYER_DROPPED :
+                listener.playerDropped(context.getPlayer(p1));
+                break;
+
+            case NONE :
+                // Not currently used.
+                break;
+
+            default :
+                break;
+        }
+    }
+}
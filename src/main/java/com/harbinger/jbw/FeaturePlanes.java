@@ -0,0 +1,268 @@
+package com.harbinger.jbw;
+
+import com.harbinger.jbw.Position.Resolution;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+import java.util.Arrays;
+
+/**
+ * Spatial feature planes of the game, such as the input of a learned policy, written by the bridge
+ * straight into a direct {@link FloatBuffer}.
+ *
+ * <p>
+ * The map is divided into square cells of {@link #getCellSize()} build tiles, and each channel
+ * holds one float per cell. The buffer holds the channels one after another in the order they were
+ * added, each row by row: the value of channel {@code c} at cell {@code (x, y)} is at index
+ * {@code (c * height + y) * width + x}. For example, the enemy ground units, their hit points and
+ * where they can shoot, next to where the agent can see and walk, in cells of 4 by 4 build tiles:
+ *
+ * <pre>
+ * final FeaturePlanes planes = new FeaturePlanes(4)
+ *         .unitCount(new UnitQuery().enemy().not().flying())
+ *         .hitPoints(new UnitQuery().enemy().not().flying())
+ *         .groundThreat(new UnitQuery().enemy())
+ *         .visibility()
+ *         .walkability();
+ * final FloatBuffer buffer = planes.allocateBuffer(broodwar.getMap());
+ * broodwar.addFeaturePlanes(planes, buffer);
+ * </pre>
+ *
+ * <p>
+ * Once added through {@link Broodwar#addFeaturePlanes(FeaturePlanes, FloatBuffer)} the channels can
+ * no longer be changed, and the buffer is rewritten every frame the agent is run, before the
+ * listener is notified.
+ *
+ * <p>
+ * The unit channels only hold the units the agent can access, unless
+ * {@link #rememberedEnemies(boolean)} adds the enemy units that are out of sight at their last
+ * known position, see {@link Broodwar#getRememberedEnemyUnits()}.
+ */
+public class FeaturePlanes {
+
+    // channels, must match FeatureChannel in client-bridge.cpp
+    private static final int UNIT_COUNT = 0;
+    private static final int HIT_POINTS = 1;
+    private static final int GROUND_THREAT = 2;
+    private static final int AIR_THREAT = 3;
+    private static final int VISIBLE = 4;
+    private static final int CREEP = 5;
+    private static final int WALKABLE = 6;
+    private static final int HEIGHT = 7;
+
+    // flags, must match client-bridge.cpp
+    private static final int REMEMBERED_ENEMIES = 1;
+
+    private final int cellSize;
+    private int[] description;
+    private int channelCount;
+
+    private int handle = -1;
+
+    /**
+     * Constructs feature planes without any channels.
+     *
+     * @param cellSize
+     *            the width and height of a cell in build tiles
+     */
+    public FeaturePlanes(final int cellSize) {
+        if (cellSize < 1) {
+            throw new IllegalArgumentException("cellSize must be at least 1");
+        }
+        this.cellSize = cellSize;
+        description = new int[] { cellSize, 0, 0 };
+    }
+
+    /**
+     * Adds a channel holding the number of units in each cell.
+     *
+     * @param filter
+     *            selects the units to count
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes unitCount(final UnitQuery filter) {
+        return add(UNIT_COUNT, filter.compile());
+    }
+
+    /**
+     * Adds a channel holding the sum of the hit points and shields of the units in each cell.
+     *
+     * @param filter
+     *            selects the units to sum
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes hitPoints(final UnitQuery filter) {
+        return add(HIT_POINTS, filter.compile());
+    }
+
+    /**
+     * Adds a channel holding the sum of the damage per attack of the ground weapons that can reach
+     * each cell, taking the range and damage upgrades of the owners into account.
+     *
+     * @param filter
+     *            selects the units whose weapons are summed
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes groundThreat(final UnitQuery filter) {
+        return add(GROUND_THREAT, filter.compile());
+    }
+
+    /**
+     * Adds a channel holding the sum of the damage per attack of the air weapons that can reach
+     * each cell, taking the range and damage upgrades of the owners into account.
+     *
+     * @param filter
+     *            selects the units whose weapons are summed
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes airThreat(final UnitQuery filter) {
+        return add(AIR_THREAT, filter.compile());
+    }
+
+    /**
+     * Adds a channel holding the fraction of each cell that is visible to the agent.
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes visibility() {
+        return add(VISIBLE);
+    }
+
+    /**
+     * Adds a channel holding the fraction of each cell that has creep.
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes creep() {
+        return add(CREEP);
+    }
+
+    /**
+     * Adds a channel holding the fraction of each cell that is walkable, ignoring units.
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes walkability() {
+        return add(WALKABLE);
+    }
+
+    /**
+     * Adds a channel holding the average {@link GameMap#getGroundHeight(Position) ground height}
+     * of each cell.
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes height() {
+        return add(HEIGHT);
+    }
+
+    /**
+     * Sets whether the unit channels also hold the remembered enemy units that are out of sight, at
+     * their last known position with their last known hit points and shields. The filters are
+     * evaluated on that last known state: remembered units are not visible, idle, cloaked or under
+     * attack, they count as completed, and lifted buildings do not count as flying.
+     *
+     * @param remembered
+     *            whether to add the remembered enemy units
+     *
+     * @return these feature planes
+     */
+    public FeaturePlanes rememberedEnemies(final boolean remembered) {
+        if (handle >= 0) {
+            throw new IllegalStateException("feature planes cannot be changed once added");
+        }
+        description[1] = remembered ? (description[1] | REMEMBERED_ENEMIES)
+                : (description[1] & ~REMEMBERED_ENEMIES);
+        return this;
+    }
+
+    /**
+     * @return the width and height of a cell in build tiles
+     */
+    public int getCellSize() {
+        return cellSize;
+    }
+
+    /**
+     * @return the number of channels
+     */
+    public int getChannelCount() {
+        return channelCount;
+    }
+
+    /**
+     * @param map
+     *            the map
+     *
+     * @return the number of cells in a row on the map
+     */
+    public int getWidth(final GameMap map) {
+        return ((map.getSize().getX(Resolution.BUILD) + cellSize) - 1) / cellSize;
+    }
+
+    /**
+     * @param map
+     *            the map
+     *
+     * @return the number of rows of cells on the map
+     */
+    public int getHeight(final GameMap map) {
+        return ((map.getSize().getY(Resolution.BUILD) + cellSize) - 1) / cellSize;
+    }
+
+    /**
+     * @param map
+     *            the map
+     *
+     * @return the number of floats the buffer of these feature planes needs on the map
+     */
+    public int getCapacity(final GameMap map) {
+        return channelCount * getWidth(map) * getHeight(map);
+    }
+
+    /**
+     * Allocates a direct buffer in the native byte order that can hold these feature planes.
+     *
+     * @param map
+     *            the map
+     *
+     * @return the buffer
+     */
+    public FloatBuffer allocateBuffer(final GameMap map) {
+        return ByteBuffer.allocateDirect(getCapacity(map) * 4).order(ByteOrder.nativeOrder())
+                .asFloatBuffer();
+    }
+
+    private FeaturePlanes add(final int channel, final int... filter) {
+        if (handle >= 0) {
+            throw new IllegalStateException("feature planes cannot be changed once added");
+        }
+        final int length = description.length;
+        description = Arrays.copyOf(description, length + 2 + filter.length);
+        description[length] = channel;
+        description[length + 1] = filter.length;
+        System.arraycopy(filter, 0, description, length + 2, filter.length);
+        description[2] = ++channelCount;
+        return this;
+    }
+
+    int[] compile() {
+        if (channelCount == 0) {
+            throw new IllegalStateException("feature planes need at least one channel");
+        }
+        return description.clone();
+    }
+
+    int getHandle() {
+        return handle;
+    }
+
+    void setHandle(final int handle) {
+        this.handle = handle;
+    }
+}
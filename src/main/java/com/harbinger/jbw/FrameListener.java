@@ -0,0 +1,27 @@
+package com.harbinger.jbw;
+
+/**
+ * Serves as a lightweight per-frame callback for modules that need to act every frame, such as
+ * micro management, while the rest of the agent is run at a lower
+ * {@link Broodwar#setAgentCadence(int, int) cadence}.
+ *
+ * <p>
+ * On frames where the agent is not run, the agent's own player is refreshed before the listeners
+ * are invoked, so its resources and supply are current. Units are not, as reading all of them would
+ * cost most of what skipping the agent saves: a listener calls
+ * {@link Broodwar#refreshUnit(Unit)} for the units it reads, which only reads their records. Units
+ * that appeared or disappeared, the unit lists and the other players are only updated on the next
+ * frame the agent is run, along with the events. Native queries and unit commands can be used as
+ * normal.
+ */
+public interface FrameListener {
+
+    /**
+     * Invoked once for every logical frame in the match, after the agent has been notified of the
+     * frame's events if it was run.
+     *
+     * @param frame
+     *            the current frame
+     */
+    public void everyFrame(final int frame);
+}
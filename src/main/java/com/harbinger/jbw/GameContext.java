@@ -0,0 +1,24 @@
+package com.harbinger.jbw;
+
+/**
+ * Looks up the units and players that a {@link Unit} refers to by ID, so units can be kept by
+ * either a {@link Broodwar} or a {@link RemoteBroodwar}.
+ */
+interface GameContext {
+
+    /**
+     * @param unitId
+     *            ID of the unit
+     *
+     * @return the unit, or null if it is not accessible
+     */
+    Unit getUnit(final int unitId);
+
+    /**
+     * @param playerId
+     *            ID of the player
+     *
+     * @return the player, or null if it is not in the match
+     */
+    Player getPlayer(final int playerId);
+}
@@ -3,6 +3,9 @@ package com.harbinger.jbw;
 import com.harbinger.jbw.Position.Resolution;
 
 import java.awt.Point;
+import java.io.*;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
 import java.util.*;
 
 /**
@@ -12,6 +15,15 @@ public class GameMap {
 
     static final int TILE_SIZE = 31;
 
+    /** Extension of the map files recorded by the bridge and completed by {@link MapAnalyzer}. */
+    static final String FILE_EXTENSION = ".jbwmap";
+
+    /** Resources at most this many pixels from the center of a base location belong to it. */
+    static final int BASE_RESOURCE_RANGE = 12 * 32;
+
+    private static final int FILE_MAGIC = 0x4A42574D; // "JBWM"
+    private static final int FILE_VERSION = 2;
+
     private final Position size;
     private final String name;
     private final String fileName;
@@ -21,6 +33,18 @@ public class GameMap {
     private final boolean[] lowResWalkable;
 
     private List<BaseLocation> baseLocations = null;
+    private int[] baseLocationData;
+
+    // regions of the native terrain analysis and the region of each build tile, -1 if none
+    private List<Region> regions = null;
+    private List<Chokepoint> chokepoints = null;
+    private int[] regionData;
+    private int[] tileRegions;
+
+    // derived data, computed by analyze() or read from a map file
+    private short[] clearance;
+    private int[] components;
+    private int[] baseDistances;
 
     public GameMap(final String name, final String fileName, final int width, final int height,
             final int[] heightMap, final int[] buildable, final int[] walkable) {
@@ -51,6 +75,7 @@ public class GameMap {
     }
 
     void setBaseLocations(final int[] baseLocationData) {
+        this.baseLocationData = baseLocationData;
         baseLocations = new ArrayList<>();
         if (baseLocationData != null) {
             for (int index = 0; index < baseLocationData.length; index +=
@@ -61,6 +86,242 @@ public class GameMap {
         }
     }
 
+    /**
+     * Sets the regions found by the native terrain analysis, laid out as
+     * {@code regionCount region* chokepointCount chokepoint* tileRegion*}.
+     */
+    void setRegions(final int[] regionData) {
+        if ((regionData == null) || (regionData.length == 0)) {
+            return;
+        }
+        this.regionData = regionData;
+        int index = 0;
+        final int regionCount = regionData[index++];
+        regions = new ArrayList<>(regionCount);
+        for (int i = 0; i < regionCount; i++, index += Region.NUM_ATTRIBUTES) {
+            regions.add(new Region(i, regionData, index));
+        }
+        final int chokepointCount = regionData[index++];
+        chokepoints = new ArrayList<>(chokepointCount);
+        for (int i = 0; i < chokepointCount; i++, index += Chokepoint.NUM_ATTRIBUTES) {
+            final Chokepoint chokepoint = new Chokepoint(regionData, index, regions);
+            chokepoint.getFirstRegion().addChokepoint(chokepoint);
+            chokepoint.getSecondRegion().addChokepoint(chokepoint);
+            chokepoints.add(chokepoint);
+        }
+        tileRegions = Arrays.copyOfRange(regionData, index, regionData.length);
+    }
+
+    /**
+     * @return true if the regions of the map are known; false otherwise
+     */
+    boolean hasRegions() {
+        return regions != null;
+    }
+
+    /**
+     * @return the index of the Region of each build tile, row by row, or -1 for tiles outside of
+     *         the regions; empty if the regions are unknown
+     */
+    int[] getTileRegions() {
+        return (tileRegions != null) ? tileRegions : new int[0];
+    }
+
+    /**
+     * @return the approximate number of bytes used by this map
+     */
+    long getEstimatedSize() {
+        // 4 bytes per height, 1 per boolean and the fields and headers of a BaseLocation
+        long bytes = (4L * heightMap.length) + buildable.length + walkable.length
+                + lowResWalkable.length;
+        if (baseLocations != null) {
+            bytes += 64L * baseLocations.size();
+        }
+        if (regionData != null) {
+            bytes += (4L * regionData.length) + (4L * tileRegions.length)
+                    + (64L * (regions.size() + chokepoints.size()));
+        }
+        if (clearance != null) {
+            bytes += (2L * clearance.length) + (4L * components.length);
+        }
+        if (baseDistances != null) {
+            bytes += 4L * baseDistances.length;
+        }
+        return bytes;
+    }
+
+    /**
+     * @return true if the derived data of the map has been computed; false otherwise
+     */
+    synchronized boolean isAnalyzed() {
+        return (clearance != null) && ((baseLocations == null) || (baseDistances != null))
+                && hasRegions();
+    }
+
+    /**
+     * Computes the derived data of the map that has not been computed or read from a map file
+     * yet. Invoked on first use of the data, or ahead of time by {@link MapAnalyzer}.
+     */
+    synchronized void analyze() {
+        if (clearance == null) {
+            clearance = computeClearance();
+            components = computeComponents();
+        }
+        if ((baseDistances == null) && (baseLocations != null)) {
+            baseDistances = computeBaseDistances();
+        }
+    }
+
+    /**
+     * Finds the regions and chokepoints of the map from its walk tiles unless they are known,
+     * the way the native terrain analysis does. Invoked ahead of time by {@link MapAnalyzer}, as
+     * it takes too long to run during a match.
+     */
+    synchronized void analyzeRegions() {
+        if (!hasRegions()) {
+            setRegions(RegionAnalysis.analyze(walkable, size.getX(Resolution.BUILD),
+                    size.getY(Resolution.BUILD)));
+        }
+    }
+
+    /**
+     * Reads a map file written by {@link #write(File)}.
+     *
+     * @param file
+     *            the map file
+     *
+     * @return the map
+     *
+     * @throws IOException
+     *             if the file could not be read or is not a map file of this version
+     */
+    static GameMap read(final File file) throws IOException {
+        try (DataInputStream in =
+                new DataInputStream(new BufferedInputStream(new FileInputStream(file)))) {
+            if (in.readInt() != FILE_MAGIC) {
+                throw new IOException("Not a map file: " + file);
+            }
+            // version 1 files have no regions, which are added when the map is played again
+            final int version = in.readInt();
+            if ((version < 1) || (version > FILE_VERSION)) {
+                throw new IOException("Not a map file of version " + FILE_VERSION + ": " + file);
+            }
+            final String name = in.readUTF();
+            final String fileName = in.readUTF();
+            final int width = in.readInt();
+            final int height = in.readInt();
+            final int[] heightMap = readInts(in, width * height);
+            final int[] buildable = readBytes(in, width * height);
+            final int[] walkable = readBytes(in, width * height * 16);
+
+            final GameMap map =
+                    new GameMap(name, fileName, width, height, heightMap, buildable, walkable);
+            final int bases = in.readInt();
+            if (bases >= 0) {
+                map.setBaseLocations(readInts(in, bases));
+            }
+            if (in.readBoolean()) {
+                map.clearance = new short[walkable.length];
+                for (int i = 0; i < map.clearance.length; i++) {
+                    map.clearance[i] = in.readShort();
+                }
+                map.components = readInts(in, walkable.length);
+            }
+            final int distances = in.readInt();
+            if (distances >= 0) {
+                map.baseDistances = readInts(in, distances);
+            }
+            if (version >= 2) {
+                final int regionLength = in.readInt();
+                if (regionLength >= 0) {
+                    map.setRegions(readInts(in, regionLength));
+                }
+            }
+            return map;
+        }
+    }
+
+    /**
+     * Writes the map, including its base locations and whatever derived data has been computed,
+     * to a map file. The file is replaced only once it has been written completely.
+     *
+     * @param file
+     *            the map file
+     *
+     * @throws IOException
+     *             if the file could not be written
+     */
+    synchronized void write(final File file) throws IOException {
+        final File temp = new File(file.getPath() + ".tmp");
+        try (DataOutputStream out =
+                new DataOutputStream(new BufferedOutputStream(new FileOutputStream(temp)))) {
+            out.writeInt(FILE_MAGIC);
+            out.writeInt(FILE_VERSION);
+            out.writeUTF(name);
+            out.writeUTF(fileName);
+            out.writeInt(size.getX(Resolution.BUILD));
+            out.writeInt(size.getY(Resolution.BUILD));
+            writeInts(out, heightMap);
+            writeBooleans(out, buildable);
+            writeBooleans(out, walkable);
+            if (baseLocationData != null) {
+                out.writeInt(baseLocationData.length);
+                writeInts(out, baseLocationData);
+            } else {
+                out.writeInt(-1);
+            }
+            out.writeBoolean(clearance != null);
+            if (clearance != null) {
+                for (final short value : clearance) {
+                    out.writeShort(value);
+                }
+                writeInts(out, components);
+            }
+            if (baseDistances != null) {
+                out.writeInt(baseDistances.length);
+                writeInts(out, baseDistances);
+            } else {
+                out.writeInt(-1);
+            }
+            if (regionData != null) {
+                out.writeInt(regionData.length);
+                writeInts(out, regionData);
+            } else {
+                out.writeInt(-1);
+            }
+        }
+        Files.move(temp.toPath(), file.toPath(), StandardCopyOption.REPLACE_EXISTING);
+    }
+
+    private static int[] readInts(final DataInput in, final int length) throws IOException {
+        final int[] values = new int[length];
+        for (int i = 0; i < length; i++) {
+            values[i] = in.readInt();
+        }
+        return values;
+    }
+
+    private static int[] readBytes(final DataInput in, final int length) throws IOException {
+        final int[] values = new int[length];
+        for (int i = 0; i < length; i++) {
+            values[i] = in.readByte();
+        }
+        return values;
+    }
+
+    private static void writeInts(final DataOutput out, final int[] values) throws IOException {
+        for (final int value : values) {
+            out.writeInt(value);
+        }
+    }
+
+    private static void writeBooleans(final DataOutput out, final boolean[] values)
+            throws IOException {
+        for (final boolean value : values) {
+            out.writeByte(value ? 1 : 0);
+        }
+    }
+
     public Position getSize() {
         return size;
     }
@@ -158,6 +419,31 @@ public class GameMap {
         return Collections.unmodifiableList(baseLocations);
     }
 
+    /**
+     * Returns the BaseLocation a mineral field or geyser belongs to, the one with the closest
+     * center within {@value #BASE_RESOURCE_RANGE} pixels.
+     *
+     * @param p
+     *            the initial Position of the resource
+     *
+     * @return the BaseLocation, or null if none is close enough or the base locations are unknown
+     */
+    public BaseLocation getBaseLocation(final Position p) {
+        if (baseLocations == null) {
+            return null;
+        }
+        BaseLocation closest = null;
+        double closestDistance = BASE_RESOURCE_RANGE;
+        for (final BaseLocation bl : baseLocations) {
+            final double distance = p.getDistance(bl.getCenter(), Resolution.PIXEL);
+            if (distance <= closestDistance) {
+                closest = bl;
+                closestDistance = distance;
+            }
+        }
+        return closest;
+    }
+
     /**
      * Convenience method that provides only the BaseLocations that are starting locations.
      *
@@ -173,6 +459,242 @@ public class GameMap {
         return startLocations;
     }
 
+    /**
+     * @return the Regions of the map, empty if the map has not been analyzed by the native terrain
+     *         analysis
+     */
+    public List<Region> getRegions() {
+        return (regions != null) ? Collections.unmodifiableList(regions)
+                : Collections.<Region> emptyList();
+    }
+
+    /**
+     * @return the Chokepoints between the Regions of the map
+     */
+    public List<Chokepoint> getChokepoints() {
+        return (chokepoints != null) ? Collections.unmodifiableList(chokepoints)
+                : Collections.<Chokepoint> emptyList();
+    }
+
+    /**
+     * Finds the Region of a Position from the region of its build tile, which the terrain analysis
+     * assigns once, so no polygons need to be tested.
+     *
+     * @param p
+     *            the Position to look up
+     *
+     * @return the Region, or null if the build tile is not walkable or the regions are unknown
+     */
+    public Region getRegion(final Position p) {
+        if ((tileRegions == null) || !p.isValid(this)) {
+            return null;
+        }
+        final int region = tileRegions[getBuildTileArrayIndex(p)];
+        return (region >= 0) ? regions.get(region) : null;
+    }
+
+    /**
+     * Returns the distance from a Position to the closest unwalkable walk tile or the edge of the
+     * map, in walk tiles.
+     *
+     * @param p
+     *            the Position to check
+     *
+     * @return the clearance at the Position, or 0 if it is not walkable
+     */
+    public int getClearance(final Position p) {
+        if (p.isValid(this)) {
+            analyze();
+            return clearance[getWalkTileArrayIndex(p)];
+        } else {
+            return 0;
+        }
+    }
+
+    /**
+     * Indicates if a ground unit can walk between two Positions, ignoring units and buildings.
+     *
+     * @param a
+     *            the first Position
+     *
+     * @param b
+     *            the second Position
+     *
+     * @return true if both Positions are walkable and connected; false otherwise
+     */
+    public boolean isConnected(final Position a, final Position b) {
+        if (a.isValid(this) && b.isValid(this)) {
+            analyze();
+            final int component = components[getWalkTileArrayIndex(a)];
+            return (component != 0) && (component == components[getWalkTileArrayIndex(b)]);
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * Returns the shortest walkable distance between two BaseLocations of this map, as
+     * {@link #getGroundDistance(Position, Position)} does, without searching for a path.
+     *
+     * @param a
+     *            the first BaseLocation
+     *
+     * @param b
+     *            the second BaseLocation
+     *
+     * @return the distance in pixels, or -1 if not reachable or not a BaseLocation of this map
+     */
+    public double getGroundDistance(final BaseLocation a, final BaseLocation b) {
+        if (baseLocations == null) {
+            return -1;
+        }
+        final int i = baseLocations.indexOf(a);
+        final int j = baseLocations.indexOf(b);
+        if ((i < 0) || (j < 0)) {
+            return -1;
+        }
+        analyze();
+        final int cost = baseDistances[(i * baseLocations.size()) + j];
+        return (cost < 0) ? -1 : ((cost * TILE_SIZE) / 10.0);
+    }
+
+    // Converts a position to a 1-dimensional walk tile array index for this map.
+    private int getWalkTileArrayIndex(final Position p) {
+        return p.getX(Resolution.WALK) + (size.getX(Resolution.WALK) * p.getY(Resolution.WALK));
+    }
+
+    // Chessboard distance transform of the walk tiles, in a forward and a backward pass.
+    private short[] computeClearance() {
+        final int width = size.getX(Resolution.WALK);
+        final int height = size.getY(Resolution.WALK);
+        final short[] distance = new short[width * height];
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (walkable[x + (width * y)]) {
+                    final int d = Math.min(Math.min(distanceAt(distance, width, height, x - 1, y),
+                            distanceAt(distance, width, height, x - 1, y - 1)),
+                            Math.min(distanceAt(distance, width, height, x, y - 1),
+                                    distanceAt(distance, width, height, x + 1, y - 1)));
+                    distance[x + (width * y)] = (short) (d + 1);
+                }
+            }
+        }
+        for (int y = height - 1; y >= 0; y--) {
+            for (int x = width - 1; x >= 0; x--) {
+                final int i = x + (width * y);
+                if (walkable[i]) {
+                    final int d = Math.min(Math.min(distanceAt(distance, width, height, x + 1, y),
+                            distanceAt(distance, width, height, x + 1, y + 1)),
+                            Math.min(distanceAt(distance, width, height, x, y + 1),
+                                    distanceAt(distance, width, height, x - 1, y + 1)));
+                    distance[i] = (short) Math.min(distance[i], d + 1);
+                }
+            }
+        }
+        return distance;
+    }
+
+    private static int distanceAt(final short[] distance, final int width, final int height,
+            final int x, final int y) {
+        if ((x < 0) || (y < 0) || (x >= width) || (y >= height)) {
+            return 0;
+        }
+        return distance[x + (width * y)];
+    }
+
+    // Labels the 4-connected walkable areas of walk tiles from 1, unwalkable tiles are 0.
+    private int[] computeComponents() {
+        final int width = size.getX(Resolution.WALK);
+        final int height = size.getY(Resolution.WALK);
+        final int[] labels = new int[width * height];
+        final int[] stack = new int[width * height];
+        int next = 1;
+        for (int start = 0; start < labels.length; start++) {
+            if (!walkable[start] || (labels[start] != 0)) {
+                continue;
+            }
+            final int label = next++;
+            int top = 0;
+            labels[start] = label;
+            stack[top++] = start;
+            while (top > 0) {
+                final int i = stack[--top];
+                final int x = i % width;
+                final int y = i / width;
+                if ((x > 0) && walkable[i - 1] && (labels[i - 1] == 0)) {
+                    labels[i - 1] = label;
+                    stack[top++] = i - 1;
+                }
+                if ((x < (width - 1)) && walkable[i + 1] && (labels[i + 1] == 0)) {
+                    labels[i + 1] = label;
+                    stack[top++] = i + 1;
+                }
+                if ((y > 0) && walkable[i - width] && (labels[i - width] == 0)) {
+                    labels[i - width] = label;
+                    stack[top++] = i - width;
+                }
+                if ((y < (height - 1)) && walkable[i + width] && (labels[i + width] == 0)) {
+                    labels[i + width] = label;
+                    stack[top++] = i + width;
+                }
+            }
+        }
+        return labels;
+    }
+
+    /*
+     * Runs Dijkstra's algorithm from every BaseLocation with the same movement rules and costs as
+     * aStarSearchDistance(), giving the matrix of costs between them or -1 if not reachable.
+     */
+    private int[] computeBaseDistances() {
+        final int width = size.getX(Resolution.BUILD);
+        final int height = size.getY(Resolution.BUILD);
+        final int count = baseLocations.size();
+        final int[] result = new int[count * count];
+        final int[] cost = new int[width * height];
+        // entries are the cost in the high and the tile index in the low 32 bits
+        final PriorityQueue<Long> openTiles = new PriorityQueue<>();
+        for (int i = 0; i < count; i++) {
+            Arrays.fill(cost, Integer.MAX_VALUE);
+            final int start = getBuildTileArrayIndex(baseLocations.get(i).getPosition());
+            cost[start] = 0;
+            openTiles.add((long) start);
+            while (!openTiles.isEmpty()) {
+                final long entry = openTiles.poll();
+                final int tile = (int) entry;
+                final int g = (int) (entry >>> 32);
+                if (g > cost[tile]) {
+                    continue;
+                }
+                final int px = tile % width;
+                final int py = tile / width;
+                for (int x = Math.max(px - 1, 0); x <= Math.min(px + 1, width - 1); x++) {
+                    for (int y = Math.max(py - 1, 0); y <= Math.min(py + 1, height - 1); y++) {
+                        final int t = x + (width * y);
+                        if ((t == tile) || !lowResWalkable[t]) {
+                            continue;
+                        }
+                        final boolean diagonal = (x != px) && (y != py);
+                        if (diagonal && !lowResWalkable[px + (width * y)]
+                                && !lowResWalkable[x + (width * py)]) {
+                            continue; // Not diagonally accessible
+                        }
+                        final int next = g + (diagonal ? 14 : 10);
+                        if (next < cost[t]) {
+                            cost[t] = next;
+                            openTiles.add(((long) next << 32) | t);
+                        }
+                    }
+                }
+            }
+            for (int j = 0; j < count; j++) {
+                final int c = cost[getBuildTileArrayIndex(baseLocations.get(j).getPosition())];
+                result[(i * count) + j] = (c == Integer.MAX_VALUE) ? -1 : c;
+            }
+        }
+        return result;
+    }
+
     /**
      * Find the shortest walkable distance, in pixels, between two tile positions or -1 if not
      * reachable. Works only after initialize(). Ported from BWTA.
@@ -0,0 +1,169 @@
+package com.harbinger.jbw;
+
+import static com.harbinger.jbw.Position.Resolution.PIXEL;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * An area of the map the bridge watches for units entering and leaving it: a {@link Region}, a
+ * rectangle or a circle, for example around a {@link Chokepoint}. For example, the enemy units
+ * entering the main base:
+ *
+ * <pre>
+ * final Geofence mainBase = Geofence.region(map.getRegion(self.getStartLocation()))
+ *         .matching(new UnitQuery().enemy());
+ * broodwar.addGeofence(mainBase, listener);
+ * </pre>
+ *
+ * <p>
+ * The bridge only tests units again when they move, against the fences of their region and their
+ * part of the map and the fences they are in, so fences cost little while units stand still. The
+ * filter is checked at the same time, so a unit that starts or stops matching it while standing
+ * still is only noticed once it moves. Units that die or are no longer accessible leave the fences
+ * they were in, so every enter is followed by a leave.
+ *
+ * <p>
+ * Fences only hold units the agent can access: an enemy unit that goes out of sight leaves its
+ * fences even though it is still remembered by {@link Broodwar#getRememberedEnemyUnits()}, and
+ * remembered units never enter a fence. Agents that need the last known positions in an area can
+ * test the remembered units against it themselves.
+ */
+public final class Geofence {
+
+    // kinds, must match GeofenceKind in client-bridge.cpp
+    private static final int REGION = 0;
+    private static final int RECTANGLE = 1;
+    private static final int CIRCLE = 2;
+
+    private final int kind;
+    private final int[] params;
+    private final int[] filter;
+
+    private int handle = -1;
+    private GeofenceListener listener;
+    private final Map<Integer, Unit> units = new HashMap<>();
+
+    private Geofence(final int kind, final int[] params, final int[] filter) {
+        this.kind = kind;
+        this.params = params;
+        this.filter = filter;
+    }
+
+    /**
+     * Creates a fence around a Region of the terrain analysis, see {@link GameMap#getRegion}.
+     *
+     * @param region
+     *            the Region
+     *
+     * @return the fence
+     */
+    public static Geofence region(final Region region) {
+        if (region == null) {
+            throw new IllegalArgumentException("region cannot be null");
+        }
+        return new Geofence(REGION, new int[] { region.getId(), 0, 0, 0 }, new int[0]);
+    }
+
+    /**
+     * Creates a rectangular fence.
+     *
+     * @param topLeft
+     *            the top left corner, inside the fence
+     *
+     * @param bottomRight
+     *            the bottom right corner, outside the fence
+     *
+     * @return the fence
+     */
+    public static Geofence rectangle(final Position topLeft, final Position bottomRight) {
+        return new Geofence(RECTANGLE, new int[] { topLeft.getX(PIXEL), topLeft.getY(PIXEL),
+                bottomRight.getX(PIXEL), bottomRight.getY(PIXEL) }, new int[0]);
+    }
+
+    /**
+     * Creates a circular fence.
+     *
+     * @param center
+     *            the center of the circle
+     *
+     * @param radius
+     *            the radius in pixels
+     *
+     * @return the fence
+     */
+    public static Geofence circle(final Position center, final int radius) {
+        return new Geofence(CIRCLE,
+                new int[] { center.getX(PIXEL), center.getY(PIXEL), radius, 0 }, new int[0]);
+    }
+
+    /**
+     * Creates a circular fence around a Chokepoint, covering its passage and a margin on both
+     * sides.
+     *
+     * @param chokepoint
+     *            the Chokepoint
+     *
+     * @param margin
+     *            how far the fence extends beyond the edges of the passage, in pixels
+     *
+     * @return the fence
+     */
+    public static Geofence around(final Chokepoint chokepoint, final int margin) {
+        return circle(chokepoint.getCenter(), (chokepoint.getWidth() / 2) + margin);
+    }
+
+    /**
+     * Restricts the fence to the units matching a query, which is evaluated by the bridge.
+     *
+     * @param query
+     *            the conditions the units must meet
+     *
+     * @return a fence of the same area for the matching units only
+     */
+    public Geofence matching(final UnitQuery query) {
+        return new Geofence(kind, params, query.compile());
+    }
+
+    /**
+     * @return the units inside the fence, as of the crossings delivered so far
+     */
+    public List<Unit> getUnits() {
+        return new ArrayList<>(units.values());
+    }
+
+    int[] compile() {
+        final int[] description = new int[1 + params.length + filter.length];
+        description[0] = kind;
+        System.arraycopy(params, 0, description, 1, params.length);
+        System.arraycopy(filter, 0, description, 1 + params.length, filter.length);
+        return description;
+    }
+
+    int getHandle() {
+        return handle;
+    }
+
+    void setHandle(final int handle, final GeofenceListener listener) {
+        this.handle = handle;
+        this.listener = listener;
+        units.clear();
+    }
+
+    void unitEntered(final Unit unit) {
+        units.put(unit.getId(), unit);
+        listener.unitEntered(unit, this);
+    }
+
+    /**
+     * Looks the unit up among those inside the fence, as it may have been destroyed or lost.
+     */
+    void unitLeft(final int unitId) {
+        final Unit unit = units.remove(unitId);
+        if (unit != null) {
+            listener.unitLeft(unit, this);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+package com.harbinger.jbw;
+
+/**
+ * Serves as a callback interface for {@link Geofence geofences}. The implementing class is
+ * registered with each fence through {@link Broodwar#addGeofence(Geofence, GeofenceListener)}.
+ *
+ * <p>
+ * The crossings of all frames since the agent last ran are delivered together, before
+ * {@link BroodwarListener#matchFrame()}.
+ */
+public interface GeofenceListener {
+
+    /**
+     * Invoked when a unit has entered a fence, including when it became accessible inside it.
+     *
+     * @param unit
+     *            the unit that entered
+     *
+     * @param fence
+     *            the fence it entered
+     */
+    public void unitEntered(final Unit unit, final Geofence fence);
+
+    /**
+     * Invoked when a unit has left a fence, including when it died or became inaccessible inside
+     * it, in which case the unit holds its last known state.
+     *
+     * @param unit
+     *            the unit that left
+     *
+     * @param fence
+     *            the fence it left
+     */
+    public void unitLeft(final Unit unit, final Geofence fence);
+}
@@ -0,0 +1,87 @@
+package com.harbinger.jbw;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+
+/**
+ * Computes the derived data of recorded maps ahead of time, so it is not computed during a match.
+ *
+ * <p>
+ * The bridge records a map file named by the hash of the map the first time the map is played.
+ * This tool analyzes all map files of a directory in parallel and writes the results back to the
+ * files, where the bridge picks them up in later matches. It does not need the game or the native
+ * libraries, so it can be run on any platform.
+ *
+ * <p>
+ * It computes the clearance, the connected areas, the distances between the bases and, for files
+ * recorded without them, the regions and chokepoints. The base locations themselves still come
+ * from the first play of the map: a map file only holds the terrain, not the resources the bases
+ * are found from, so this tool cannot analyze maps that have never been played.
+ *
+ * <pre>
+ * java -cp jbw.jar com.harbinger.jbw.MapAnalyzer [directory] [threads]
+ * </pre>
+ *
+ * The directory defaults to <i>bwta</i> and the number of threads to the number of processors.
+ */
+public final class MapAnalyzer {
+
+    private MapAnalyzer() {
+    }
+
+    public static void main(final String[] args) throws InterruptedException {
+        final File directory = new File((args.length > 0) ? args[0] : "bwta");
+        final int threads = (args.length > 1) ? Integer.parseInt(args[1])
+                : Runtime.getRuntime().availableProcessors();
+
+        final File[] files =
+                directory.listFiles((dir, name) -> name.endsWith(GameMap.FILE_EXTENSION));
+        if (files == null) {
+            System.err.println("Not a directory: " + directory);
+            System.exit(1);
+        }
+        Arrays.sort(files);
+
+        final ExecutorService executor = Executors.newFixedThreadPool(threads);
+        final List<Future<String>> results = new ArrayList<>();
+        for (final File file : files) {
+            results.add(executor.submit(() -> analyze(file)));
+        }
+        executor.shutdown();
+
+        int failed = 0;
+        for (int i = 0; i < files.length; i++) {
+            try {
+                System.out.println(results.get(i).get());
+            } catch (final ExecutionException ex) {
+                System.err.println(files[i].getName() + ": " + ex.getCause().getMessage());
+                failed++;
+            }
+        }
+        System.out.println("Analyzed " + (files.length - failed) + " of " + files.length
+                + " maps using " + threads + " threads.");
+        if (failed > 0) {
+            System.exit(1);
+        }
+    }
+
+    private static String analyze(final File file) throws IOException {
+        final long start = System.nanoTime();
+        final GameMap map = GameMap.read(file);
+        if (map.isAnalyzed()) {
+            return file.getName() + ": " + map.getName() + " is already analyzed";
+        }
+        map.analyze();
+        map.analyzeRegions();
+        map.write(file);
+        final long millis = (System.nanoTime() - start) / 1000000;
+        return file.getName() + ": " + map.getName() + " analyzed in " + millis + " ms";
+    }
+}
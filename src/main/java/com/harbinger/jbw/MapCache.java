@@ -0,0 +1,73 @@
+package com.harbinger.jbw;
+
+import java.util.HashMap;
+import java.util.Iterator;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+/**
+ * Keeps the maps of previous matches in memory, so a match on a map that has already been played
+ * by this process starts without fetching the map from the game or reading the map data again.
+ *
+ * <p>
+ * The cache is shared by all Broodwar instances in the process and is keyed by the hash of the map
+ * file. The least recently used maps are evicted once the estimated size of the cached maps
+ * exceeds the capacity, which is set in bytes by the {@value #CAPACITY_PROPERTY} system property
+ * and defaults to {@value #DEFAULT_CAPACITY} bytes. A capacity of 0 disables the cache.
+ */
+final class MapCache {
+
+    /** System property setting the capacity of the cache in bytes. */
+    static final String CAPACITY_PROPERTY = "jbw.map.cache.bytes";
+
+    private static final long DEFAULT_CAPACITY = 64L * 1024 * 1024;
+
+    // iterates from the least to the most recently used map
+    private static final Map<String, GameMap> maps = new LinkedHashMap<>(16, 0.75f, true);
+    // the estimated sizes of the maps when they were cached, which eviction subtracts again
+    private static final Map<String, Long> sizes = new HashMap<>();
+    private static final long capacity = Long.getLong(CAPACITY_PROPERTY, DEFAULT_CAPACITY);
+    private static long size;
+
+    private MapCache() {
+    }
+
+    /**
+     * @param hash
+     *            hash of the map file
+     *
+     * @return the cached map, or null if it is not cached
+     */
+    static synchronized GameMap get(final String hash) {
+        return maps.get(hash);
+    }
+
+    /**
+     * Caches a map, evicting the least recently used maps if the cache is over capacity. Maps
+     * larger than the capacity are not cached.
+     *
+     * @param hash
+     *            hash of the map file
+     *
+     * @param map
+     *            the map, which must not be modified after it is cached
+     */
+    static synchronized void put(final String hash, final GameMap map) {
+        final long mapSize = map.getEstimatedSize();
+        if (mapSize > capacity) {
+            return;
+        }
+        maps.put(hash, map);
+        final Long previousSize = sizes.put(hash, mapSize);
+        if (previousSize != null) {
+            size -= previousSize;
+        }
+        size += mapSize;
+
+        final Iterator<String> it = maps.keySet().iterator();
+        while (size > capacity) {
+            size -= sizes.remove(it.next());
+            it.remove();
+        }
+    }
+}
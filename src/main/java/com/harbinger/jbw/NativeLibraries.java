@@ -0,0 +1,89 @@
+package com.harbinger.jbw;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.InputStream;
+import java.net.URL;
+import java.net.URLConnection;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+
+/**
+ * Locates and loads the native libraries of the bridge.
+ *
+ * <p>
+ * A library is looked up in the directory named by the {@value #PATH_PROPERTY} system property if
+ * it is set, otherwise in the source tree (when running from a checkout) and finally in the jar,
+ * from which it is extracted to a temporary directory before being loaded.
+ */
+final class NativeLibraries {
+
+    /** System property naming a directory that contains the native libraries. */
+    static final String PATH_PROPERTY = "jbw.native.path";
+
+    private static final String RESOURCE_DIRECTORY = "x86/dll/";
+    private static final File SOURCE_DIRECTORY = new File("src/main/resources/x86/dll");
+    private static final File EXTRACT_DIRECTORY =
+            new File(System.getProperty("java.io.tmpdir"), "jbw-native");
+
+    private NativeLibraries() {
+    }
+
+    /**
+     * Loads a native library. Dependencies must be loaded before the libraries that need them.
+     *
+     * @param name
+     *            file name of the library
+     *
+     * @return true if the library was loaded; false otherwise
+     */
+    static boolean load(final String name) {
+        final File dll = locate(name);
+        if (dll == null) {
+            System.err.println("Native code library not found: " + name);
+            return false;
+        }
+        try {
+            System.load(dll.getAbsolutePath());
+            return true;
+        } catch (final UnsatisfiedLinkError ex) {
+            System.err.println("Native code library failed to load: " + ex.toString());
+            return false;
+        }
+    }
+
+    private static File locate(final String name) {
+        final String path = System.getProperty(PATH_PROPERTY);
+        if (path != null) {
+            return new File(path, name);
+        }
+
+        final File source = new File(SOURCE_DIRECTORY, name);
+        if (source.exists()) {
+            return source;
+        }
+
+        final URL resource = NativeLibraries.class.getClassLoader()
+                .getResource(RESOURCE_DIRECTORY + name);
+        return (resource != null) ? extract(resource, name) : null;
+    }
+
+    private static File extract(final URL resource, final String name) {
+        final File target = new File(EXTRACT_DIRECTORY, name);
+        try {
+            final URLConnection connection = resource.openConnection();
+            // an up to date copy may be in use by another agent and cannot be overwritten
+            if (target.exists() && (target.length() == connection.getContentLengthLong())) {
+                return target;
+            }
+            EXTRACT_DIRECTORY.mkdirs();
+            try (InputStream in = connection.getInputStream()) {
+                Files.copy(in, target.toPath(), StandardCopyOption.REPLACE_EXISTING);
+            }
+            return target;
+        } catch (final IOException ex) {
+            System.err.println("Native code library could not be extracted: " + ex.getMessage());
+            return target.exists() ? target : null;
+        }
+    }
+}
@@ -3,7 +3,11 @@ package com.harbinger.jbw;
 import com.harbinger.jbw.Position.Resolution;
 import com.harbinger.jbw.Type.Race;
 import com.harbinger.jbw.Type.Tech;
+import com.harbinger.jbw.Type.UnitType;
 import com.harbinger.jbw.Type.Upgrade;
+import com.harbinger.jbw.Type.Weapon;
+
+import java.util.Arrays;
 
 /**
  * Represents a StarCraft player.
@@ -12,7 +16,24 @@ import com.harbinger.jbw.Type.Upgrade;
  */
 public class Player {
 
+    // BEGIN GENERATED player.size
     static final int NUM_ATTRIBUTES = 11;
+    // END GENERATED player.size
+
+    // effective stats layout, must match UnitStat and WeaponStat in client-bridge.cpp
+    private static final int TOP_SPEED = 0;
+    private static final int SIGHT_RANGE = 1;
+    private static final int GROUND_WEAPON_MAX_RANGE = 2;
+    private static final int AIR_WEAPON_MAX_RANGE = 3;
+    private static final int ARMOR = 4;
+    private static final int MAX_ENERGY = 5;
+    private static final int GROUND_WEAPON_COOLDOWN = 6;
+    private static final int UNIT_STAT_COUNT = 7;
+    private static final int WEAPON_MAX_RANGE = 0;
+    private static final int WEAPON_DAMAGE = 1;
+    private static final int WEAPON_STAT_COUNT = 2;
+
+    private static final double FIXED_SCALE = 100.0;
 
     private final int id;
     private final int raceId;
@@ -43,18 +64,30 @@ public class Player {
     private final boolean[] upgrading;
     private final int[] upgradeLevel;
 
+    private int[] allUnitCount = new int[0];
+    private int[] visibleUnitCount = new int[0];
+    private int[] completedUnitCount = new int[0];
+    private int[] deadUnitCount = new int[0];
+    private int[] killedUnitCount = new int[0];
+
+    private int statsVersion = -1;
+    private int[] unitStats = new int[0];
+    private int[] weaponStats = new int[0];
+
     Player(final int[] data, int index, final String name) {
+        // BEGIN GENERATED player.decode
         id = data[index++];
         raceId = data[index++];
         typeId = data[index++];
         startLocationX = data[index++];
         startLocationY = data[index++];
-        self = (data[index++] == 1);
-        ally = (data[index++] == 1);
-        enemy = (data[index++] == 1);
-        neutral = (data[index++] == 1);
-        observer = (data[index++] == 1);
+        self = data[index++] == 1;
+        ally = data[index++] == 1;
+        enemy = data[index++] == 1;
+        neutral = data[index++] == 1;
+        observer = data[index++] == 1;
         color = data[index++];
+        // END GENERATED player.decode
         this.name = name;
         // Initialise technology records
         int highestIDTechType = 0;
@@ -83,6 +116,25 @@ public class Player {
         killScore = data[index++];
         buildingScore = data[index++];
         razingScore = data[index++];
+
+        // unit type counts follow as consecutive tables indexed by unit type id
+        final int typeCount = data[index++];
+        if (allUnitCount.length != typeCount) {
+            allUnitCount = new int[typeCount];
+            visibleUnitCount = new int[typeCount];
+            completedUnitCount = new int[typeCount];
+            deadUnitCount = new int[typeCount];
+            killedUnitCount = new int[typeCount];
+        }
+        System.arraycopy(data, index, allUnitCount, 0, typeCount);
+        index += typeCount;
+        System.arraycopy(data, index, visibleUnitCount, 0, typeCount);
+        index += typeCount;
+        System.arraycopy(data, index, completedUnitCount, 0, typeCount);
+        index += typeCount;
+        System.arraycopy(data, index, deadUnitCount, 0, typeCount);
+        index += typeCount;
+        System.arraycopy(data, index, killedUnitCount, 0, typeCount);
     }
 
     void updateResearch(final int[] techData, final int[] upgradeData) {
@@ -99,6 +151,20 @@ public class Player {
         }
     }
 
+    void updateStats(final int version, final int[] data) {
+        int index = 0;
+        final int typeCount = data[index++];
+        unitStats = Arrays.copyOfRange(data, index, index + (typeCount * UNIT_STAT_COUNT));
+        index += unitStats.length;
+        final int weaponCount = data[index++];
+        weaponStats = Arrays.copyOfRange(data, index, index + (weaponCount * WEAPON_STAT_COUNT));
+        statsVersion = version;
+    }
+
+    int getStatsVersion() {
+        return statsVersion;
+    }
+
     int getId() {
         return id;
     }
@@ -204,6 +270,128 @@ public class Player {
         return upgrading[upgrade.getId()];
     }
 
+    /**
+     * @return the number of units of the type the player has, including incomplete units and
+     *         units inside transports
+     */
+    public int getAllUnitCount(final UnitType type) {
+        return getCount(allUnitCount, type);
+    }
+
+    /**
+     * @return the number of units of the type the player has that are visible to the agent
+     */
+    public int getVisibleUnitCount(final UnitType type) {
+        return getCount(visibleUnitCount, type);
+    }
+
+    /**
+     * @return the number of completed units of the type the player has
+     */
+    public int getCompletedUnitCount(final UnitType type) {
+        return getCount(completedUnitCount, type);
+    }
+
+    /**
+     * @return the number of incomplete units of the type the player has
+     */
+    public int getIncompleteUnitCount(final UnitType type) {
+        return getAllUnitCount(type) - getCompletedUnitCount(type);
+    }
+
+    /**
+     * @return the number of units of the type the player has lost
+     */
+    public int getDeadUnitCount(final UnitType type) {
+        return getCount(deadUnitCount, type);
+    }
+
+    /**
+     * @return the number of units of the type the player has killed
+     */
+    public int getKilledUnitCount(final UnitType type) {
+        return getCount(killedUnitCount, type);
+    }
+
+    private static int getCount(final int[] counts, final UnitType type) {
+        final int id = type.getId();
+        return ((id >= 0) && (id < counts.length)) ? counts[id] : 0;
+    }
+
+    /**
+     * @return the top speed of units of the type, in pixels per frame, including the player's
+     *         upgrades
+     */
+    public double getTopSpeed(final UnitType type) {
+        return getStat(unitStats, UNIT_STAT_COUNT, type.getId(), TOP_SPEED) / FIXED_SCALE;
+    }
+
+    /**
+     * @return the sight range of units of the type, in pixels, including the player's upgrades
+     */
+    public int getSightRange(final UnitType type) {
+        return getStat(unitStats, UNIT_STAT_COUNT, type.getId(), SIGHT_RANGE);
+    }
+
+    /**
+     * @return the maximum range of the ground weapon of units of the type, in pixels, including
+     *         the player's upgrades
+     */
+    public int getGroundWeaponMaxRange(final UnitType type) {
+        return getStat(unitStats, UNIT_STAT_COUNT, type.getId(), GROUND_WEAPON_MAX_RANGE);
+    }
+
+    /**
+     * @return the maximum range of the air weapon of units of the type, in pixels, including the
+     *         player's upgrades
+     */
+    public int getAirWeaponMaxRange(final UnitType type) {
+        return getStat(unitStats, UNIT_STAT_COUNT, type.getId(), AIR_WEAPON_MAX_RANGE);
+    }
+
+    /**
+     * @return the armor of units of the type, including the player's upgrades
+     */
+    public int getArmor(final UnitType type) {
+        return getStat(unitStats, UNIT_STAT_COUNT, type.getId(), ARMOR);
+    }
+
+    /**
+     * @return the maximum energy of units of the type, including the player's upgrades
+     */
+    public int getMaxEnergy(final UnitType type) {
+        return getStat(unitStats, UNIT_STAT_COUNT, type.getId(), MAX_ENERGY);
+    }
+
+    /**
+     * @return the number of frames between ground attacks of units of the type, including the
+     *         player's upgrades
+     */
+    public int getGroundWeaponCooldown(final UnitType type) {
+        return getStat(unitStats, UNIT_STAT_COUNT, type.getId(), GROUND_WEAPON_COOLDOWN);
+    }
+
+    /**
+     * @return the maximum range of the weapon, in pixels, including the player's upgrades
+     */
+    public int getWeaponMaxRange(final Weapon weapon) {
+        return getStat(weaponStats, WEAPON_STAT_COUNT, weapon.getId(), WEAPON_MAX_RANGE);
+    }
+
+    /**
+     * @return the damage of a single hit of the weapon, including the player's upgrades but
+     *         before armor and damage type modifiers
+     */
+    public int getWeaponDamage(final Weapon weapon) {
+        return getStat(weaponStats, WEAPON_STAT_COUNT, weapon.getId(), WEAPON_DAMAGE);
+    }
+
+    private static int getStat(final int[] stats, final int statCount, final int id,
+            final int stat) {
+        final int index = (id * statCount) + stat;
+        return ((id >= 0) && (index < stats.length)) ? stats[index] : 0;
+    }
+
     /**
      * {@inheritDoc}
      */
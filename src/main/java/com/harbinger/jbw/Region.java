@@ -0,0 +1,93 @@
+package com.harbinger.jbw;
+
+import com.harbinger.jbw.Position.Resolution;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+
+/**
+ * Represents an area of the map bounded by unwalkable terrain and chokepoints, as found by the
+ * native terrain analysis.
+ */
+public class Region {
+
+    // BEGIN GENERATED terrainRegion.size
+    static final int NUM_ATTRIBUTES = 4;
+    // END GENERATED terrainRegion.size
+
+    private final int id;
+    private final Position center;
+    private final int clearance;
+    private final int area;
+    private final List<Chokepoint> chokepoints = new ArrayList<>();
+    private final List<Region> neighbors = new ArrayList<>();
+
+    Region(final int id, final int[] data, int index) {
+        // BEGIN GENERATED terrainRegion.decode
+        final int x = data[index++];
+        final int y = data[index++];
+        final int clearance = data[index++];
+        final int area = data[index++];
+        // END GENERATED terrainRegion.decode
+        this.id = id;
+        center = new Position(x, y, Resolution.WALK);
+        this.clearance = clearance;
+        this.area = area;
+    }
+
+    void addChokepoint(final Chokepoint chokepoint) {
+        chokepoints.add(chokepoint);
+        final Region neighbor = chokepoint.getOtherRegion(this);
+        if (!neighbors.contains(neighbor)) {
+            neighbors.add(neighbor);
+        }
+    }
+
+    /**
+     * @return the index of the Region in {@link GameMap#getRegions()}
+     */
+    public int getId() {
+        return id;
+    }
+
+    /**
+     * @return the most open Position of the Region, the furthest from unwalkable terrain
+     */
+    public Position getCenter() {
+        return center;
+    }
+
+    /**
+     * @return the distance from the center to the closest unwalkable terrain, in pixels
+     */
+    public int getClearance() {
+        return clearance * 8;
+    }
+
+    /**
+     * @return the number of walkable walk tiles of the Region
+     */
+    public int getArea() {
+        return area;
+    }
+
+    /**
+     * @return the Chokepoints leading out of the Region
+     */
+    public List<Chokepoint> getChokepoints() {
+        return Collections.unmodifiableList(chokepoints);
+    }
+
+    /**
+     * @return the Regions connected to this one by a Chokepoint
+     */
+    public List<Region> getNeighbors() {
+        return Collections.unmodifiableList(neighbors);
+    }
+
+    @Override
+    public String toString() {
+        return "Region " + id + " at " + center;
+    }
+}
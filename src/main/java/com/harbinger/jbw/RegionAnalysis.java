@@ -0,0 +1,389 @@
+package com.harbinger.jbw;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Finds the regions and chokepoints of a map from its walk tiles without the game, so
+ * {@link MapAnalyzer} can add them to recorded map files.
+ *
+ * <p>
+ * This is a port of the first three stages of the native terrain analysis in
+ * <i>terrain-analyzer.cpp</i>: an exact euclidean distance transform, a watershed of it from the
+ * most open tiles down, and the rasterization of the regions to build tiles. It gives the same
+ * regions and chokepoints, in the same order, so changes to either have to be made to both. The
+ * bases are not found here, as the resources of a map are only known while it is played.
+ */
+final class RegionAnalysis {
+
+    // regions smaller than this, in walk tiles, are merged into their neighbours
+    private static final int MIN_REGION_AREA = 256;
+
+    // regions are merged when the passage between them is at least this part of the clearance
+    // of either
+    private static final double MERGE_CLEARANCE_RATIO = 0.9;
+
+    private final int width;
+    private final int height;
+    private final boolean[] walkable;
+
+    // squared distance of each walk tile to the closest unwalkable walk tile or the map edge
+    private int[] distance;
+
+    // basins of the watershed, merged into their parents
+    private int[] parent;
+    private int[] area;
+    private int[] peak;
+    private int[] peakDistance;
+    private int basinCount;
+
+    private int[] regionMap;
+    private final List<int[]> regions = new ArrayList<>();
+    private final List<int[]> chokepoints = new ArrayList<>();
+
+    private RegionAnalysis(final boolean[] walkable, final int tileWidth, final int tileHeight) {
+        this.walkable = walkable;
+        width = tileWidth * 4;
+        height = tileHeight * 4;
+    }
+
+    /**
+     * Analyzes the walk tiles of a map.
+     *
+     * @param walkable
+     *            the walkability of each walk tile, row by row
+     *
+     * @param tileWidth
+     *            the width of the map in build tiles
+     *
+     * @param tileHeight
+     *            the height of the map in build tiles
+     *
+     * @return the regions laid out as {@link GameMap#setRegions(int[])} reads them
+     */
+    static int[] analyze(final boolean[] walkable, final int tileWidth, final int tileHeight) {
+        final RegionAnalysis analysis = new RegionAnalysis(walkable, tileWidth, tileHeight);
+        analysis.transform();
+        analysis.findRegions();
+        final int[] tileRegions = analysis.rasterize(tileWidth, tileHeight);
+
+        final int[] data = new int[2 + (analysis.regions.size() * Region.NUM_ATTRIBUTES)
+                + (analysis.chokepoints.size() * Chokepoint.NUM_ATTRIBUTES)
+                + tileRegions.length];
+        int index = 0;
+        data[index++] = analysis.regions.size();
+        for (final int[] region : analysis.regions) {
+            System.arraycopy(region, 0, data, index, Region.NUM_ATTRIBUTES);
+            index += Region.NUM_ATTRIBUTES;
+        }
+        data[index++] = analysis.chokepoints.size();
+        for (final int[] chokepoint : analysis.chokepoints) {
+            System.arraycopy(chokepoint, 0, data, index, Chokepoint.NUM_ATTRIBUTES);
+            index += Chokepoint.NUM_ATTRIBUTES;
+        }
+        System.arraycopy(tileRegions, 0, data, index, tileRegions.length);
+        return data;
+    }
+
+    /*
+     * Distance to the closest unwalkable walk tile along each column, where the edges of the map
+     * count as unwalkable, then the lower envelope of the parabolas rooted at the column distances
+     * of each row, after Felzenszwalb and Huttenlocher, bounded by the left and right edges.
+     */
+    private void transform() {
+        final int[] columns = new int[width * height];
+        for (int x = 0; x < width; x++) {
+            int last = -1;
+            for (int y = 0; y < height; y++) {
+                if (!walkable[x + (width * y)]) {
+                    last = y;
+                }
+                columns[x + (width * y)] = y - last;
+            }
+            last = height;
+            for (int y = height - 1; y >= 0; y--) {
+                if (!walkable[x + (width * y)]) {
+                    last = y;
+                }
+                final int d = Math.min(columns[x + (width * y)], last - y);
+                columns[x + (width * y)] = d * d;
+            }
+        }
+
+        distance = new int[width * height];
+        final int[] roots = new int[width];
+        final double[] bounds = new double[width + 1];
+        for (int y = 0; y < height; y++) {
+            final int row = width * y;
+            int k = 0;
+            roots[0] = 0;
+            bounds[0] = -1e20;
+            bounds[1] = 1e20;
+            for (int q = 1; q < width; q++) {
+                double s;
+                for (;;) {
+                    final int r = roots[k];
+                    s = ((columns[row + q] + (q * q)) - (columns[row + r] + (r * r)))
+                            / (2.0 * (q - r));
+                    if (s > bounds[k]) {
+                        break;
+                    }
+                    k--;
+                }
+                k++;
+                roots[k] = q;
+                bounds[k] = s;
+                bounds[k + 1] = 1e20;
+            }
+            k = 0;
+            for (int q = 0; q < width; q++) {
+                while (bounds[k + 1] < q) {
+                    k++;
+                }
+                final int r = roots[k];
+                final int edge = Math.min(q + 1, width - q);
+                distance[row + q] = walkable[row + q]
+                        ? Math.min(((q - r) * (q - r)) + columns[row + r], edge * edge) : 0;
+            }
+        }
+    }
+
+    private int findBasin(int basin) {
+        while (parent[basin] != basin) {
+            parent[basin] = parent[parent[basin]];
+            basin = parent[basin];
+        }
+        return basin;
+    }
+
+    private boolean shouldMerge(final int a, final int b, final int passageDistance) {
+        if (Math.min(area[a], area[b]) < MIN_REGION_AREA) {
+            return true;
+        }
+        final double passage = Math.sqrt(passageDistance);
+        return passage >= (MERGE_CLEARANCE_RATIO
+                * Math.sqrt(Math.min(peakDistance[a], peakDistance[b])));
+    }
+
+    private int addBasin(final int tile) {
+        if (basinCount == parent.length) {
+            final int capacity = parent.length * 2;
+            parent = Arrays.copyOf(parent, capacity);
+            area = Arrays.copyOf(area, capacity);
+            peak = Arrays.copyOf(peak, capacity);
+            peakDistance = Arrays.copyOf(peakDistance, capacity);
+        }
+        final int basin = basinCount++;
+        parent[basin] = basin;
+        area[basin] = 1;
+        peak[basin] = tile;
+        peakDistance[basin] = distance[tile];
+        return basin;
+    }
+
+    /*
+     * Floods the walk tiles from the most open down, joining the basins that meet where the
+     * passage is not narrow. Each 8-connected line of tiles where two remaining regions met is a
+     * chokepoint, whose middle is its most open tile.
+     */
+    private void findRegions() {
+        final int size = width * height;
+
+        // most open first, then by index, sorted as longs for speed
+        int count = 0;
+        for (int i = 0; i < size; i++) {
+            if (distance[i] > 0) {
+                count++;
+            }
+        }
+        final long[] order = new long[count];
+        count = 0;
+        for (int i = 0; i < size; i++) {
+            if (distance[i] > 0) {
+                order[count++] = ((long) (Integer.MAX_VALUE - distance[i]) << 32) | i;
+            }
+        }
+        Arrays.sort(order);
+
+        final int[] labels = new int[size];
+        Arrays.fill(labels, -1);
+        parent = new int[1024];
+        area = new int[1024];
+        peak = new int[1024];
+        peakDistance = new int[1024];
+        basinCount = 0;
+        // tile and the two basins of each tile where basins met and were not merged
+        int[] frontiers = new int[3 * 1024];
+        int frontierCount = 0;
+
+        for (final long entry : order) {
+            final int tile = (int) entry;
+            final int x = tile % width;
+            final int y = tile / width;
+            int a = -1;
+            int b = -1;
+            for (int dy = -1; (dy <= 1) && (b < 0); dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    final int nx = x + dx;
+                    final int ny = y + dy;
+                    if ((nx < 0) || (ny < 0) || (nx >= width) || (ny >= height)
+                            || (labels[nx + (width * ny)] < 0)) {
+                        continue;
+                    }
+                    final int basin = findBasin(labels[nx + (width * ny)]);
+                    if (a < 0) {
+                        a = basin;
+                    } else if (basin != a) {
+                        b = basin;
+                        break;
+                    }
+                }
+            }
+
+            if (a < 0) {
+                labels[tile] = addBasin(tile);
+            } else if (b < 0) {
+                labels[tile] = a;
+                area[a]++;
+            } else if (shouldMerge(a, b, distance[tile])) {
+                if (area[a] < area[b]) {
+                    final int swap = a;
+                    a = b;
+                    b = swap;
+                }
+                parent[b] = a;
+                area[a] += area[b] + 1;
+                if (peakDistance[b] > peakDistance[a]) {
+                    peak[a] = peak[b];
+                    peakDistance[a] = peakDistance[b];
+                }
+                labels[tile] = a;
+            } else {
+                if (frontierCount * 3 == frontiers.length) {
+                    frontiers = Arrays.copyOf(frontiers, frontiers.length * 2);
+                }
+                frontiers[frontierCount * 3] = tile;
+                frontiers[(frontierCount * 3) + 1] = a;
+                frontiers[(frontierCount * 3) + 2] = b;
+                frontierCount++;
+                labels[tile] = a;
+                area[a]++;
+            }
+        }
+
+        // number the remaining basins in the order they are first met
+        final int[] regionOf = new int[basinCount];
+        Arrays.fill(regionOf, -1);
+        regionMap = new int[size];
+        Arrays.fill(regionMap, -1);
+        for (int i = 0; i < size; i++) {
+            if (labels[i] < 0) {
+                continue;
+            }
+            final int root = findBasin(labels[i]);
+            if (regionOf[root] < 0) {
+                regionOf[root] = regions.size();
+                regions.add(new int[] { peak[root] % width, peak[root] / width,
+                        (int) Math.sqrt(peakDistance[root]), area[root] });
+            }
+            regionMap[i] = regionOf[root];
+        }
+
+        // frontier tiles between regions that were not merged later, grouped by pair of regions
+        final Map<Long, Integer> pairs = new HashMap<>();
+        final List<int[]> pairRegions = new ArrayList<>();
+        final int[] pairAt = new int[size];
+        Arrays.fill(pairAt, -1);
+        for (int f = 0; f < frontierCount; f++) {
+            final int a = regionOf[findBasin(frontiers[(f * 3) + 1])];
+            final int b = regionOf[findBasin(frontiers[(f * 3) + 2])];
+            if (a == b) {
+                continue;
+            }
+            final long key = ((long) Math.min(a, b) << 32) | Math.max(a, b);
+            Integer pair = pairs.get(key);
+            if (pair == null) {
+                pair = pairRegions.size();
+                pairs.put(key, pair);
+                pairRegions.add(new int[] { Math.min(a, b), Math.max(a, b) });
+            }
+            pairAt[frontiers[f * 3]] = pair;
+        }
+
+        final int[] stack = new int[size];
+        for (int f = 0; f < frontierCount; f++) {
+            final int start = frontiers[f * 3];
+            final int pair = pairAt[start];
+            if (pair < 0) {
+                continue;
+            }
+            int middle = start;
+            int top = 0;
+            pairAt[start] = -1;
+            stack[top++] = start;
+            while (top > 0) {
+                final int tile = stack[--top];
+                if (distance[tile] > distance[middle]) {
+                    middle = tile;
+                }
+                final int x = tile % width;
+                final int y = tile / width;
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        final int nx = x + dx;
+                        final int ny = y + dy;
+                        if ((nx >= 0) && (ny >= 0) && (nx < width) && (ny < height)
+                                && (pairAt[nx + (width * ny)] == pair)) {
+                            pairAt[nx + (width * ny)] = -1;
+                            stack[top++] = nx + (width * ny);
+                        }
+                    }
+                }
+            }
+            chokepoints.add(new int[] { pairRegions.get(pair)[0], pairRegions.get(pair)[1],
+                    middle % width, middle / width, (int) (2 * Math.sqrt(distance[middle])) });
+        }
+    }
+
+    /*
+     * Assigns each build tile the region of most of its walk tiles, the first one found on a tie.
+     */
+    private int[] rasterize(final int tileWidth, final int tileHeight) {
+        final int[] tileRegions = new int[tileWidth * tileHeight];
+        final int[] found = new int[16];
+        final int[] counts = new int[16];
+        for (int ty = 0; ty < tileHeight; ty++) {
+            for (int tx = 0; tx < tileWidth; tx++) {
+                int foundCount = 0;
+                for (int wy = ty * 4; wy < ((ty * 4) + 4); wy++) {
+                    for (int wx = tx * 4; wx < ((tx * 4) + 4); wx++) {
+                        final int region = regionMap[wx + (width * wy)];
+                        if (region < 0) {
+                            continue;
+                        }
+                        int i = 0;
+                        while ((i < foundCount) && (found[i] != region)) {
+                            i++;
+                        }
+                        if (i == foundCount) {
+                            found[foundCount] = region;
+                            counts[foundCount++] = 0;
+                        }
+                        counts[i]++;
+                    }
+                }
+                int best = -1;
+                for (int i = 0; i < foundCount; i++) {
+                    if ((best < 0) || (counts[i] > counts[best])) {
+                        best = i;
+                    }
+                }
+                tileRegions[tx + (tileWidth * ty)] = (best >= 0) ? found[best] : -1;
+            }
+        }
+        return tileRegions;
+    }
+}
@@ -0,0 +1,241 @@
+package com.harbinger.jbw;
+
+import com.harbinger.jbw.Position.Resolution;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * The regions Broodwar divides the map into for path finding, as exported by BWAPI. They are much
+ * smaller than the {@link Region Regions} of the terrain analysis and are known for every map
+ * without analyzing it.
+ *
+ * <p>
+ * Each build tile belongs to one region, except for split tiles whose walk tiles are divided
+ * between two regions. Looking up the region of a position takes one or two array loads.
+ */
+public class RegionGraph {
+
+    // build tiles divided between two regions carry this flag and the index of their split tile
+    private static final int SPLIT_TILE = 0x2000;
+
+    private final int width;
+    private final int height;
+    private final int[] tileRegions;
+    private final int[] splitTiles;
+    private final Node[] nodes;
+
+    /**
+     * A region of the graph.
+     */
+    public static final class Node {
+
+        // BEGIN GENERATED regionNode.size
+        static final int NUM_ATTRIBUTES = 12;
+        // END GENERATED regionNode.size
+
+        private final int id;
+        private final int islandId;
+        private final Position center;
+        private final int priority;
+        private final int left;
+        private final int top;
+        private final int right;
+        private final int bottom;
+        private final boolean walkable;
+        private final boolean higherGround;
+        private final int[] neighborIds;
+
+        Node(final int[] data, int index) {
+            // BEGIN GENERATED regionNode.decode
+            final int id = data[index++];
+            final int islandId = data[index++];
+            final int centerX = data[index++];
+            final int centerY = data[index++];
+            final int priority = data[index++];
+            final int left = data[index++];
+            final int top = data[index++];
+            final int right = data[index++];
+            final int bottom = data[index++];
+            final boolean walkable = data[index++] == 1;
+            final boolean higherGround = data[index++] == 1;
+            final int neighborCount = data[index++];
+            // END GENERATED regionNode.decode
+            this.id = id;
+            this.islandId = islandId;
+            center = new Position(centerX, centerY, Resolution.PIXEL);
+            this.priority = priority;
+            this.left = left;
+            this.top = top;
+            this.right = right;
+            this.bottom = bottom;
+            this.walkable = walkable;
+            this.higherGround = higherGround;
+            neighborIds = Arrays.copyOfRange(data, index, index + neighborCount);
+        }
+
+        /**
+         * @return the ID BWAPI gives the region
+         */
+        public int getId() {
+            return id;
+        }
+
+        /**
+         * @return the ID of the island of the region; regions with the same ID are connected
+         */
+        public int getIslandId() {
+            return islandId;
+        }
+
+        public Position getCenter() {
+            return center;
+        }
+
+        /**
+         * @return the priority Broodwar gives the region when searching for paths
+         */
+        public int getPriority() {
+            return priority;
+        }
+
+        /**
+         * @return the left edge of the bounding box, in pixels
+         */
+        public int getLeft() {
+            return left;
+        }
+
+        /**
+         * @return the top edge of the bounding box, in pixels
+         */
+        public int getTop() {
+            return top;
+        }
+
+        /**
+         * @return the right edge of the bounding box, in pixels
+         */
+        public int getRight() {
+            return right;
+        }
+
+        /**
+         * @return the bottom edge of the bounding box, in pixels
+         */
+        public int getBottom() {
+            return bottom;
+        }
+
+        public boolean isWalkable() {
+            return walkable;
+        }
+
+        public boolean isHigherGround() {
+            return higherGround;
+        }
+
+        int[] getNeighborIds() {
+            return neighborIds;
+        }
+
+        @Override
+        public String toString() {
+            return "Node " + id + " at " + center;
+        }
+    }
+
+    /**
+     * Decodes the region graph sent by the bridge.
+     */
+    RegionGraph(final int[] data, final int width, final int height) {
+        this.width = width;
+        this.height = height;
+        int index = 0;
+        final int count = data[index++];
+        final List<Node> decoded = new ArrayList<>(count);
+        int maxId = -1;
+        for (int i = 0; i < count; i++) {
+            final Node node = new Node(data, index);
+            index += Node.NUM_ATTRIBUTES + node.neighborIds.length;
+            decoded.add(node);
+            maxId = Math.max(maxId, node.id);
+        }
+        nodes = new Node[maxId + 1];
+        for (final Node node : decoded) {
+            nodes[node.id] = node;
+        }
+        tileRegions = Arrays.copyOfRange(data, index, index + (width * height));
+        index += width * height;
+        final int splitCount = data[index++];
+        splitTiles = Arrays.copyOfRange(data, index, index + (splitCount * 3));
+    }
+
+    /**
+     * @return the regions of the graph
+     */
+    public List<Node> getNodes() {
+        final List<Node> result = new ArrayList<>(nodes.length);
+        for (final Node node : nodes) {
+            if (node != null) {
+                result.add(node);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @param id
+     *            the ID of a region
+     *
+     * @return the region, or null if there is none with the ID
+     */
+    public Node getNode(final int id) {
+        return ((id >= 0) && (id < nodes.length)) ? nodes[id] : null;
+    }
+
+    /**
+     * Finds the region of a position, as BWAPI's Game::getRegionAt does.
+     *
+     * @param p
+     *            the Position to look up
+     *
+     * @return the region, or null if the position is outside the map
+     */
+    public Node getNode(final Position p) {
+        final int px = p.getPX();
+        final int py = p.getPY();
+        if ((px < 0) || (py < 0) || (px >= (width * 32)) || (py >= (height * 32))) {
+            return null;
+        }
+        int id = tileRegions[(px / 32) + (width * (py / 32))];
+        if ((id & SPLIT_TILE) != 0) {
+            final int split = (id & ~SPLIT_TILE) * 3;
+            if (split >= splitTiles.length) {
+                return null;
+            }
+            final int walkTile = ((px & 31) / 8) + (((py & 31) / 8) * 4);
+            id = ((splitTiles[split] >> walkTile) & 1) != 0 ? splitTiles[split + 2]
+                    : splitTiles[split + 1];
+        }
+        return getNode(id);
+    }
+
+    /**
+     * @param node
+     *            a region of the graph
+     *
+     * @return the regions bordering it
+     */
+    public List<Node> getNeighbors(final Node node) {
+        final List<Node> result = new ArrayList<>(node.neighborIds.length);
+        for (final int id : node.neighborIds) {
+            final Node neighbor = getNode(id);
+            if (neighbor != null) {
+                result.add(neighbor);
+            }
+        }
+        return result;
+    }
+}
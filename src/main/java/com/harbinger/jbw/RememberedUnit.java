@@ -0,0 +1,136 @@
+package com.harbinger.jbw;
+
+import com.harbinger.jbw.Position.Resolution;
+import com.harbinger.jbw.Type.UnitType;
+
+/**
+ * The last known state of an enemy unit that has been seen during the match.
+ *
+ * <p>
+ * Enemy units stop being accessible as soon as they leave vision. The bridge remembers where each
+ * enemy unit was last seen until it is destroyed, its building is seen to be gone, or a mobile unit
+ * has been out of sight for longer than the {@link Broodwar#setEnemyMemoryTimeout(int) timeout}.
+ */
+public class RememberedUnit {
+
+    static final int NUM_ATTRIBUTES = 10;
+
+    private final Broodwar broodwar;
+    private final int id;
+    private final int playerId;
+    private final int typeId;
+    private final int x;
+    private final int y;
+    private final int hitPoints;
+    private final int shields;
+    private final int lastSeenFrame;
+    private final boolean building;
+    private final boolean visible;
+
+    RememberedUnit(final int[] data, int index, final Broodwar broodwar) {
+        this.broodwar = broodwar;
+        id = data[index++];
+        playerId = data[index++];
+        typeId = data[index++];
+        x = data[index++];
+        y = data[index++];
+        hitPoints = data[index++];
+        shields = data[index++];
+        lastSeenFrame = data[index++];
+        building = (data[index++] == 1);
+        visible = (data[index++] == 1);
+    }
+
+    /**
+     * @return the unique ID of the remembered unit
+     */
+    public int getId() {
+        return id;
+    }
+
+    /**
+     * @return the Player that owned the unit when it was last seen
+     */
+    public Player getPlayer() {
+        return broodwar.getPlayer(playerId);
+    }
+
+    /**
+     * @return the type of the unit when it was last seen
+     */
+    public UnitType getType() {
+        return UnitType.getUnitType(typeId);
+    }
+
+    /**
+     * @return the (pixel) Position where the unit was last seen
+     */
+    public Position getPosition() {
+        return new Position(x, y, Resolution.PIXEL);
+    }
+
+    /**
+     * @return the hit points of the unit when it was last seen
+     */
+    public int getHitPoints() {
+        return hitPoints;
+    }
+
+    /**
+     * @return the shields of the unit when it was last seen
+     */
+    public int getShields() {
+        return shields;
+    }
+
+    /**
+     * @return the frame in which the unit was last seen
+     */
+    public int getLastSeenFrame() {
+        return lastSeenFrame;
+    }
+
+    /**
+     * @return true if the unit is a building; false otherwise
+     */
+    public boolean isBuilding() {
+        return building;
+    }
+
+    /**
+     * @return true if the unit is visible in the current frame; false otherwise
+     */
+    public boolean isVisible() {
+        return visible;
+    }
+
+    /**
+     * @return the accessible Unit if it is currently visible; null otherwise
+     */
+    public Unit getUnit() {
+        return visible ? broodwar.getUnit(id) : null;
+    }
+
+    /**
+     * {@inheritDoc}
+     */
+    @Override
+    public int hashCode() {
+        return id;
+    }
+
+    /**
+     * {@inheritDoc}
+     */
+    @Override
+    public boolean equals(final Object obj) {
+        if (this == obj) {
+            return true;
+        }
+        if ((obj == null) || (getClass() != obj.getClass())) {
+            return false;
+        }
+        final RememberedUnit other = (RememberedUnit) obj;
+        return (id == other.id) && (lastSeenFrame == other.lastSeenFrame);
+    }
+}
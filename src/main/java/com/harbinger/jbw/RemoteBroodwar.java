@@ -0,0 +1,413 @@
+package com.harbinger.jbw;
+
+import static com.harbinger.jbw.Position.Resolution.BUILD;
+import static com.harbinger.jbw.Position.Resolution.PIXEL;
+
+import com.harbinger.jbw.Type.Command;
+
+import java.io.*;
+import java.net.Socket;
+import java.net.SocketAddress;
+import java.nio.ByteBuffer;
+import java.util.*;
+
+/**
+ * Provides access to a Broodwar game run by another process, which streams its state through an
+ * {@link AgentServer}. Does not need the native libraries, so the agent can run on any platform
+ * and a crash of the agent does not affect the match.
+ *
+ * <p>
+ * The listener is notified of the same events as through {@link Broodwar}, with the same
+ * {@link Unit} and {@link Player} objects, on the thread that invoked {@link #connect}. Only the
+ * state the bridge streams is available: the players, the units and the map if it has been
+ * recorded in the bwta directory. Native queries, drawing and the command methods of {@link Unit}
+ * are not available; commands are sent through {@link #issueCommand} instead, in a batch after the
+ * listener has handled the frame.
+ */
+public class RemoteBroodwar implements Closeable {
+
+    private final Map<Integer, Unit> units = new HashMap<>();
+    private final List<Unit> playerUnits = new ArrayList<>();
+    private final List<Unit> alliedUnits = new ArrayList<>();
+    private final List<Unit> enemyUnits = new ArrayList<>();
+    private final List<Unit> neutralUnits = new ArrayList<>();
+
+    private final Map<Integer, Player> players = new HashMap<>();
+    private final List<Player> allies = new ArrayList<>();
+    private final List<Player> enemies = new ArrayList<>();
+
+    private final BroodwarListener listener;
+
+    private final GameContext context = new GameContext() {
+
+        @Override
+        public Unit getUnit(final int unitId) {
+            return units.get(unitId);
+        }
+
+        @Override
+        public Player getPlayer(final int playerId) {
+            return players.get(playerId);
+        }
+    };
+
+    private boolean flyweightUnits;
+
+    private Socket socket;
+    private int[] commands = new int[AgentServer.COMMAND_INTS * 64];
+    private int commandCount;
+
+    private int frame;
+    private Player self;
+    private Player neutralPlayer;
+    private GameMap map;
+
+    /**
+     * Constructs the remote Broodwar with the listener to notify when game events occur.
+     *
+     * @param listener
+     *            listener to notify of game events
+     */
+    public RemoteBroodwar(final BroodwarListener listener) {
+        if (listener == null) {
+            throw new IllegalArgumentException("listener cannot be null");
+        }
+        this.listener = listener;
+    }
+
+    /**
+     * Connects to the agent server of a Broodwar game.
+     *
+     * <p>
+     * This method will block until the server disconnects or the connection is
+     * {@link #close() closed}.
+     *
+     * @param address
+     *            address of the {@link AgentServer}
+     *
+     * @throws IOException
+     *             if the connection could not be established or failed
+     */
+    public void connect(final SocketAddress address) throws IOException {
+        socket = new Socket();
+        socket.setTcpNoDelay(true);
+        socket.connect(address);
+        try {
+            final DataInputStream in =
+                    new DataInputStream(new BufferedInputStream(socket.getInputStream(), 1 << 16));
+            final DataOutputStream out =
+                    new DataOutputStream(new BufferedOutputStream(socket.getOutputStream()));
+            listener.connected();
+            while (true) {
+                final int type;
+                try {
+                    type = in.readInt();
+                } catch (final EOFException ex) {
+                    return;
+                }
+                in.readInt(); // length
+                switch (type) {
+                    case AgentServer.MATCH_START :
+                        matchStarted(in);
+                        break;
+
+                    case AgentServer.FRAME :
+                        frameReceived(in);
+                        sendCommands(out);
+                        break;
+
+                    case AgentServer.MATCH_END :
+                        listener.matchEnd(in.readBoolean());
+                        break;
+
+                    default :
+                        throw new IOException("Unknown message type " + type);
+                }
+            }
+        } catch (final IOException ex) {
+            if (!socket.isClosed()) {
+                throw ex;
+            }
+        } finally {
+            socket.close();
+        }
+    }
+
+    /**
+     * Disconnects from the game.
+     */
+    @Override
+    public void close() throws IOException {
+        if (socket != null) {
+            socket.close();
+        }
+    }
+
+    /**
+     * Selects how units are updated, see {@link Broodwar#setFlyweightUnits(boolean)}.
+     *
+     * @param flyweightUnits
+     *            true to use flyweight units; false to copy all attributes every frame
+     */
+    public void setFlyweightUnits(final boolean flyweightUnits) {
+        this.flyweightUnits = flyweightUnits;
+    }
+
+    /**
+     * Issues a command to a unit. The commands issued while handling a frame are sent together
+     * when the listener returns, and are issued by the bridge on the next frame the agent is run.
+     *
+     * @param unit
+     *            the unit to command
+     *
+     * @param command
+     *            the type of command
+     *
+     * @param target
+     *            the target unit, or null
+     *
+     * @param position
+     *            the target position, or null
+     *
+     * @param extra
+     *            the ID of the unit, tech or upgrade type, or the training slot, depending on the
+     *            command; 0 otherwise
+     */
+    public void issueCommand(final Unit unit, final Command command, final Unit target,
+            final Position position, final int extra) {
+        if (commands.length < ((commandCount + 1) * AgentServer.COMMAND_INTS)) {
+            commands = Arrays.copyOf(commands, commands.length * 2);
+        }
+        final boolean tile = command.takesBuildTile();
+        int index = commandCount++ * AgentServer.COMMAND_INTS;
+        commands[index++] = unit.getId();
+        commands[index++] = command.getId();
+        commands[index++] = (target != null) ? target.getId() : -1;
+        commands[index++] = (position != null) ? position.getX(tile ? BUILD : PIXEL) : 0;
+        commands[index++] = (position != null) ? position.getY(tile ? BUILD : PIXEL) : 0;
+        commands[index] = extra;
+    }
+
+    /**
+     * @return the number of logical frames since the match started
+     */
+    public int getFrame() {
+        return frame;
+    }
+
+    /**
+     * @return the current agent or null during replays
+     */
+    public Player getAgent() {
+        return self;
+    }
+
+    /**
+     * @return the neutral Player
+     */
+    public Player getNeutralPlayer() {
+        return neutralPlayer;
+    }
+
+    /**
+     * @return the players in the match
+     */
+    public List<Player> getPlayers() {
+        return new ArrayList<>(players.values());
+    }
+
+    /**
+     * @return the agent's allies in the match
+     */
+    public List<Player> getAllies() {
+        return new ArrayList<>(allies);
+    }
+
+    /**
+     * @return the agent's enemies in the match
+     */
+    public List<Player> getEnemies() {
+        return new ArrayList<>(enemies);
+    }
+
+    /**
+     * @return all accessible units
+     */
+    public List<Unit> getAllUnits() {
+        return new ArrayList<>(units.values());
+    }
+
+    /**
+     * @return the agent's units
+     */
+    public List<Unit> getUnits() {
+        return new ArrayList<>(playerUnits);
+    }
+
+    /**
+     * @return the units of the agent's allies
+     */
+    public List<Unit> getAlliedUnits() {
+        return new ArrayList<>(alliedUnits);
+    }
+
+    /**
+     * @return the accessible units of the agent's enemies
+     */
+    public List<Unit> getEnemyUnits() {
+        return new ArrayList<>(enemyUnits);
+    }
+
+    /**
+     * @return the accessible neutral units
+     */
+    public List<Unit> getNeutralUnits() {
+        return new ArrayList<>(neutralUnits);
+    }
+
+    /**
+     * @param player
+     *            the Player whose Units to return
+     *
+     * @return all accessible units owned by the player
+     */
+    public List<Unit> getUnits(final Player player) {
+        final List<Unit> result = new ArrayList<>();
+        for (final Unit unit : units.values()) {
+            if (unit.getPlayer() == player) {
+                result.add(unit);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @return the map that the current match is using, or null if it has not been recorded in the
+     *         bwta directory of this process
+     */
+    public GameMap getMap() {
+        return map;
+    }
+
+    private void matchStarted(final DataInputStream in) throws IOException {
+        final String hash = in.readUTF();
+        self = null;
+        neutralPlayer = null;
+        players.clear();
+        allies.clear();
+        enemies.clear();
+        final int playerCount = in.readInt();
+        for (int i = 0; i < playerCount; i++) {
+            final String name = in.readUTF();
+            final Player player = new Player(readInts(in), 0, name);
+            players.put(player.getId(), player);
+            if (player.isSelf()) {
+                self = player;
+            } else if (player.isAlly()) {
+                allies.add(player);
+            } else if (player.isEnemy()) {
+                enemies.add(player);
+            } else if (player.isNeutral()) {
+                neutralPlayer = player;
+            }
+        }
+
+        units.clear();
+        frame = 0;
+        updateUnits(readInts(in));
+        loadMap(hash);
+        listener.matchStart();
+    }
+
+    private void frameReceived(final DataInputStream in) throws IOException {
+        frame = in.readInt();
+        final int playerCount = in.readInt();
+        for (int i = 0; i < playerCount; i++) {
+            final Player player = players.get(in.readInt());
+            final int[] playerData = readInts(in);
+            if (player != null) {
+                player.update(playerData);
+            }
+        }
+        updateUnits(readInts(in));
+
+        final int eventCount = in.readInt();
+        for (int i = 0; i < eventCount; i++) {
+            final EventType event = EventType.getEventType(in.readInt());
+            final int p1 = in.readInt();
+            final int p2 = in.readInt();
+            final String p3 = in.readUTF();
+            event.notifyListener(listener, context, p1, p2, p3);
+        }
+        listener.matchFrame();
+    }
+
+    private void updateUnits(final int[] unitData) {
+        final Set<Integer> deadUnits = new HashSet<>(units.keySet());
+        playerUnits.clear();
+        alliedUnits.clear();
+        enemyUnits.clear();
+        neutralUnits.clear();
+
+        for (int index = 0; index < unitData.length; index += Unit.NUM_ATTRIBUTES) {
+            final int id = unitData[index];
+            deadUnits.remove(id);
+
+            Unit unit = units.get(id);
+            if (unit == null) {
+                unit = flyweightUnits ? new UnitView(id, context) : new Unit(id, context);
+                units.put(id, unit);
+            }
+            unit.update(unitData, index);
+
+            if ((self != null) && (unit.getPlayer() == self)) {
+                playerUnits.add(unit);
+            } else if (allies.contains(unit.getPlayer())) {
+                alliedUnits.add(unit);
+            } else if (enemies.contains(unit.getPlayer())) {
+                enemyUnits.add(unit);
+            } else {
+                neutralUnits.add(unit);
+            }
+        }
+
+        for (final Integer unitId : deadUnits) {
+            units.remove(unitId).setDestroyed();
+        }
+    }
+
+    private void loadMap(final String hash) {
+        map = MapCache.get(hash);
+        final File mapFile = new File("bwta/", hash + GameMap.FILE_EXTENSION);
+        if ((map == null) && mapFile.exists()) {
+            try {
+                map = GameMap.read(mapFile);
+                MapCache.put(hash, map);
+            } catch (final IOException ex) {
+                System.err.println("Map data could not be loaded.");
+                System.err.println(ex.getMessage());
+            }
+        }
+    }
+
+    private void sendCommands(final DataOutputStream out) throws IOException {
+        if (commandCount == 0) {
+            return;
+        }
+        final int length = commandCount * AgentServer.COMMAND_INTS;
+        final ByteBuffer message = ByteBuffer.allocate(12 + (length * 4));
+        message.putInt(AgentServer.COMMANDS).putInt(4 + (length * 4)).putInt(commandCount);
+        message.asIntBuffer().put(commands, 0, length);
+        out.write(message.array());
+        out.flush();
+        commandCount = 0;
+    }
+
+    private static int[] readInts(final DataInputStream in) throws IOException {
+        final byte[] bytes = new byte[in.readInt() * 4];
+        in.readFully(bytes);
+        final int[] values = new int[bytes.length / 4];
+        ByteBuffer.wrap(bytes).asIntBuffer().get(values);
+        return values;
+    }
+}
@@ -0,0 +1,311 @@
+package com.harbinger.jbw;
+
+import java.io.*;
+import java.util.*;
+import java.util.zip.DataFormatException;
+import java.util.zip.Inflater;
+
+/**
+ * Reads a replay data file exported through {@link Broodwar#exportReplay(File)}.
+ *
+ * <p>
+ * The file holds three tables:
+ * <ul>
+ * <li><i>units</i> - a <i>frame</i> column followed by the attributes the bridge sends for each
+ * unit, one row per unit and frame. The <i>bits</i> columns hold the boolean attributes packed as
+ * in {@link Unit}.</li>
+ * <li><i>players</i> - <i>frame</i>, <i>player</i> and the resources, supply and scores of each
+ * player, one row per player and frame.</li>
+ * <li><i>events</i> - <i>frame</i>, <i>type</i> and the two integer parameters of each event. The
+ * type is the ID of the BWAPI event and the parameters are as passed to the listener, e.g. the ID
+ * of the unit.</li>
+ * </ul>
+ *
+ * <p>
+ * The rows are stored in chunks of consecutive frames, and every column of a chunk can be read
+ * without reading the other columns. The unit and player rows of a chunk are ordered by unit or
+ * player and then by frame; the event rows are in the order the events occurred.
+ *
+ * <pre>
+ * try (ReplayDataReader reader = new ReplayDataReader(file)) {
+ *     for (int chunk = 0; chunk &lt; reader.getChunkCount(); chunk++) {
+ *         final int[] ids = reader.readColumn("units", "id", chunk);
+ *         final int[] hitPoints = reader.readColumn("units", "hitPoints", chunk);
+ *         ...
+ *     }
+ * }
+ * </pre>
+ */
+public class ReplayDataReader implements Closeable {
+
+    private final RandomAccessFile file;
+    private final Map<String, Integer> tables = new HashMap<>();
+    private final List<List<String>> columns = new ArrayList<>();
+
+    private final int[] firstFrames;
+    private final int[] lastFrames;
+    // [chunk][table] row count, and [chunk][table][column * 2] offset and length
+    private final int[][] rows;
+    private final long[][][] locations;
+
+    private final Inflater inflater = new Inflater();
+    private byte[] compressed = new byte[1 << 16];
+    private byte[] encoded = new byte[1 << 16];
+
+    /**
+     * Opens a replay data file and reads its index.
+     *
+     * @param file
+     *            the file to read
+     *
+     * @throws IOException
+     *             if the file could not be read or is not a complete replay data file
+     */
+    public ReplayDataReader(final File file) throws IOException {
+        this.file = new RandomAccessFile(file, "r");
+        try {
+            if ((this.file.readInt() != ReplayDataWriter.MAGIC)
+                    || (this.file.readInt() != ReplayDataWriter.VERSION)) {
+                throw new IOException("Not a replay data file of version "
+                        + ReplayDataWriter.VERSION + ": " + file);
+            }
+            final int tableCount = this.file.readInt();
+            for (int t = 0; t < tableCount; t++) {
+                tables.put(this.file.readUTF(), t);
+                final int columnCount = this.file.readInt();
+                final List<String> names = new ArrayList<>(columnCount);
+                for (int c = 0; c < columnCount; c++) {
+                    names.add(this.file.readUTF());
+                }
+                columns.add(Collections.unmodifiableList(names));
+            }
+
+            this.file.seek(this.file.length() - 12);
+            final long indexOffset = this.file.readLong();
+            if (this.file.readInt() != ReplayDataWriter.MAGIC) {
+                throw new IOException("Replay data file was not completed: " + file);
+            }
+            final byte[] indexData = new byte[(int) (this.file.length() - 12 - indexOffset)];
+            this.file.seek(indexOffset);
+            this.file.readFully(indexData);
+            final DataInputStream index =
+                    new DataInputStream(new ByteArrayInputStream(indexData));
+            final int chunkCount = index.readInt();
+            firstFrames = new int[chunkCount];
+            lastFrames = new int[chunkCount];
+            rows = new int[chunkCount][tableCount];
+            locations = new long[chunkCount][tableCount][];
+            for (int chunk = 0; chunk < chunkCount; chunk++) {
+                firstFrames[chunk] = index.readInt();
+                lastFrames[chunk] = index.readInt();
+                for (int t = 0; t < tableCount; t++) {
+                    rows[chunk][t] = index.readInt();
+                    locations[chunk][t] = new long[columns.get(t).size() * 2];
+                    for (int c = 0; c < locations[chunk][t].length; c += 2) {
+                        locations[chunk][t][c] = index.readLong();
+                        locations[chunk][t][c + 1] = index.readInt();
+                    }
+                }
+            }
+        } catch (final IOException ex) {
+            this.file.close();
+            throw ex;
+        }
+    }
+
+    /**
+     * @return the names of the tables in the file
+     */
+    public Set<String> getTables() {
+        return Collections.unmodifiableSet(tables.keySet());
+    }
+
+    /**
+     * @param table
+     *            name of the table
+     *
+     * @return the names of the columns of the table
+     */
+    public List<String> getColumns(final String table) {
+        return columns.get(getTable(table));
+    }
+
+    /**
+     * @return the number of chunks in the file
+     */
+    public int getChunkCount() {
+        return firstFrames.length;
+    }
+
+    /**
+     * @param chunk
+     *            index of the chunk
+     *
+     * @return the first frame in the chunk
+     */
+    public int getFirstFrame(final int chunk) {
+        return firstFrames[chunk];
+    }
+
+    /**
+     * @param chunk
+     *            index of the chunk
+     *
+     * @return the last frame in the chunk
+     */
+    public int getLastFrame(final int chunk) {
+        return lastFrames[chunk];
+    }
+
+    /**
+     * Finds the chunk that holds a frame.
+     *
+     * @param frame
+     *            the frame
+     *
+     * @return the index of the chunk, or -1 if no chunk holds the frame
+     */
+    public int getChunk(final int frame) {
+        int low = 0;
+        int high = firstFrames.length - 1;
+        while (low <= high) {
+            final int middle = (low + high) >>> 1;
+            if (lastFrames[middle] < frame) {
+                low = middle + 1;
+            } else if (firstFrames[middle] > frame) {
+                high = middle - 1;
+            } else {
+                return middle;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @param table
+     *            name of the table
+     *
+     * @param chunk
+     *            index of the chunk
+     *
+     * @return the number of rows of the table in the chunk
+     */
+    public int getRowCount(final String table, final int chunk) {
+        return rows[chunk][getTable(table)];
+    }
+
+    /**
+     * Reads the values of a column in a chunk, without reading the other columns.
+     *
+     * @param table
+     *            name of the table
+     *
+     * @param column
+     *            name of the column
+     *
+     * @param chunk
+     *            index of the chunk
+     *
+     * @return the values, one per row
+     *
+     * @throws IOException
+     *             if the column could not be read
+     */
+    public int[] readColumn(final String table, final String column, final int chunk)
+            throws IOException {
+        final int t = getTable(table);
+        final int c = columns.get(t).indexOf(column);
+        if (c < 0) {
+            throw new IllegalArgumentException("unknown column: " + table + "." + column);
+        }
+        final int length = (int) locations[chunk][t][(c * 2) + 1];
+        if (compressed.length < length) {
+            compressed = new byte[length];
+        }
+        file.seek(locations[chunk][t][c * 2]);
+        file.readFully(compressed, 0, length);
+
+        final int count = rows[chunk][t];
+        if (encoded.length < (count * 5)) {
+            encoded = new byte[count * 5];
+        }
+        inflater.reset();
+        inflater.setInput(compressed, 0, length);
+        int size = 0;
+        try {
+            while (!inflater.finished() && (size < encoded.length)) {
+                final int inflated = inflater.inflate(encoded, size, encoded.length - size);
+                if ((inflated == 0) && inflater.needsInput()) {
+                    break;
+                }
+                size += inflated;
+            }
+        } catch (final DataFormatException ex) {
+            throw new IOException("Corrupt column " + table + "." + column, ex);
+        }
+
+        final int[] values = new int[count];
+        int position = 0;
+        int previous = 0;
+        for (int i = 0; i < count; i++) {
+            int zigzag = 0;
+            int shift = 0;
+            byte b;
+            do {
+                if (position == size) {
+                    throw new IOException("Truncated column " + table + "." + column);
+                }
+                b = encoded[position++];
+                zigzag |= (b & 0x7F) << shift;
+                shift += 7;
+            } while (b < 0);
+            previous += (zigzag >>> 1) ^ -(zigzag & 1);
+            values[i] = previous;
+        }
+        return values;
+    }
+
+    /**
+     * Reads the values of a column in all chunks.
+     *
+     * @param table
+     *            name of the table
+     *
+     * @param column
+     *            name of the column
+     *
+     * @return the values of the rows of every chunk, in the order of the chunks
+     *
+     * @throws IOException
+     *             if the column could not be read
+     */
+    public int[] readColumn(final String table, final String column) throws IOException {
+        final int t = getTable(table);
+        int total = 0;
+        for (int chunk = 0; chunk < getChunkCount(); chunk++) {
+            total += rows[chunk][t];
+        }
+        final int[] values = new int[total];
+        int offset = 0;
+        for (int chunk = 0; chunk < getChunkCount(); chunk++) {
+            final int[] chunkValues = readColumn(table, column, chunk);
+            System.arraycopy(chunkValues, 0, values, offset, chunkValues.length);
+            offset += chunkValues.length;
+        }
+        return values;
+    }
+
+    @Override
+    public void close() throws IOException {
+        inflater.end();
+        file.close();
+    }
+
+    private int getTable(final String table) {
+        final Integer t = tables.get(table);
+        if (t == null) {
+            throw new IllegalArgumentException("unknown table: " + table);
+        }
+        return t;
+    }
+}
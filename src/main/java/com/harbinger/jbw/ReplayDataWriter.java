@@ -0,0 +1,258 @@
+package com.harbinger.jbw;
+
+import java.io.*;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.zip.Deflater;
+
+/**
+ * Writes the units, players and events of a replay to a columnar data file, which is read by
+ * {@link ReplayDataReader}.
+ *
+ * <p>
+ * The rows are collected into chunks of {@value #CHUNK_FRAMES} frames. Within a chunk the unit
+ * rows are ordered by unit and then by frame, so consecutive rows mostly describe the same unit
+ * one frame apart. Each column of a chunk is stored on its own as the differences between
+ * consecutive values, as zigzag varints, compressed with deflate. The index at the end of the file
+ * holds the frames and the location of every column of every chunk.
+ *
+ * <pre>
+ * file   := header chunk* index indexOffset:long MAGIC:int
+ * header := MAGIC:int VERSION:int tableCount:int (name:utf columnCount:int columnName:utf*)*
+ * index  := chunkCount:int (firstFrame:int lastFrame:int (rows:int (offset:long length:int)*)*)*
+ * </pre>
+ */
+final class ReplayDataWriter implements Closeable {
+
+    static final int MAGIC = 0x4A425752; // "JBWR"
+    static final int VERSION = 1;
+
+    static final String UNITS = "units";
+    static final String PLAYERS = "players";
+    static final String EVENTS = "events";
+
+    /** Number of scores at the start of a player update that are exported. */
+    static final int PLAYER_SCORES = 10;
+    static final String[] PLAYER_COLUMNS = { "frame", "player", "minerals", "gas", "supplyUsed",
+            "supplyTotal", "cumulativeMinerals", "cumulativeGas", "unitScore", "killScore",
+            "buildingScore", "razingScore" };
+    static final String[] EVENT_COLUMNS = { "frame", "type", "p1", "p2" };
+
+    private static final int CHUNK_FRAMES = 240;
+
+    private final DataOutputStream out;
+    private long position;
+
+    private final Table units;
+    private final Table players;
+    private final Table events;
+    private final List<int[]> chunkFrames = new ArrayList<>();
+    private final List<long[][]> chunkColumns = new ArrayList<>();
+    private final List<int[]> chunkRows = new ArrayList<>();
+
+    private int firstFrame = -1;
+    private int lastFrame;
+
+    private final Deflater deflater = new Deflater(Deflater.BEST_SPEED);
+    private byte[] encoded = new byte[1 << 16];
+    private byte[] compressed = new byte[1 << 16];
+
+    ReplayDataWriter(final File file) throws IOException {
+        final String[] unitColumns = new String[Unit.NUM_ATTRIBUTES + 1];
+        unitColumns[0] = "frame";
+        System.arraycopy(Unit.ATTRIBUTE_NAMES, 0, unitColumns, 1, Unit.NUM_ATTRIBUTES);
+        units = new Table(UNITS, unitColumns, 1);
+        players = new Table(PLAYERS, PLAYER_COLUMNS, 1);
+        events = new Table(EVENTS, EVENT_COLUMNS, -1);
+
+        out = new DataOutputStream(new BufferedOutputStream(new FileOutputStream(file), 1 << 16));
+        final ByteArrayOutputStream header = new ByteArrayOutputStream();
+        final DataOutputStream headerOut = new DataOutputStream(header);
+        headerOut.writeInt(MAGIC);
+        headerOut.writeInt(VERSION);
+        headerOut.writeInt(3);
+        for (final Table table : new Table[] { units, players, events }) {
+            headerOut.writeUTF(table.name);
+            headerOut.writeInt(table.columnNames.length);
+            for (final String column : table.columnNames) {
+                headerOut.writeUTF(column);
+            }
+        }
+        header.writeTo(out);
+        position = header.size();
+    }
+
+    /**
+     * Starts a frame, writing the current chunk first if it is full.
+     */
+    void beginFrame(final int frame) throws IOException {
+        if ((firstFrame >= 0) && ((frame - firstFrame) >= CHUNK_FRAMES)) {
+            writeChunk();
+        }
+        if (firstFrame < 0) {
+            firstFrame = frame;
+        }
+        lastFrame = frame;
+    }
+
+    void addUnits(final int frame, final int[] unitData) {
+        for (int index = 0; index < unitData.length; index += Unit.NUM_ATTRIBUTES) {
+            final int row = units.addRow();
+            units.columns[0][row] = frame;
+            for (int i = 0; i < Unit.NUM_ATTRIBUTES; i++) {
+                units.columns[i + 1][row] = unitData[index + i];
+            }
+        }
+    }
+
+    void addPlayer(final int frame, final int playerId, final int[] playerData) {
+        final int row = players.addRow();
+        players.columns[0][row] = frame;
+        players.columns[1][row] = playerId;
+        for (int i = 0; i < PLAYER_SCORES; i++) {
+            players.columns[i + 2][row] = playerData[i];
+        }
+    }
+
+    void addEvent(final int frame, final int type, final int p1, final int p2) {
+        final int row = events.addRow();
+        events.columns[0][row] = frame;
+        events.columns[1][row] = type;
+        events.columns[2][row] = p1;
+        events.columns[3][row] = p2;
+    }
+
+    /**
+     * Writes the last chunk and the index and closes the file.
+     */
+    @Override
+    public void close() throws IOException {
+        try {
+            if (firstFrame >= 0) {
+                writeChunk();
+            }
+            final long indexOffset = position;
+            out.writeInt(chunkFrames.size());
+            for (int chunk = 0; chunk < chunkFrames.size(); chunk++) {
+                out.writeInt(chunkFrames.get(chunk)[0]);
+                out.writeInt(chunkFrames.get(chunk)[1]);
+                final long[][] columns = chunkColumns.get(chunk);
+                for (int table = 0; table < columns.length; table++) {
+                    out.writeInt(chunkRows.get(chunk)[table]);
+                    for (int column = 0; column < columns[table].length; column += 2) {
+                        out.writeLong(columns[table][column]);
+                        out.writeInt((int) columns[table][column + 1]);
+                    }
+                }
+            }
+            out.writeLong(indexOffset);
+            out.writeInt(MAGIC);
+        } finally {
+            out.close();
+            deflater.end();
+        }
+    }
+
+    private void writeChunk() throws IOException {
+        final Table[] tables = { units, players, events };
+        final long[][] locations = new long[tables.length][];
+        final int[] rows = new int[tables.length];
+        for (int t = 0; t < tables.length; t++) {
+            final Table table = tables[t];
+            final int[] order = table.order();
+            locations[t] = new long[table.columns.length * 2];
+            rows[t] = table.rows;
+            for (int c = 0; c < table.columns.length; c++) {
+                locations[t][c * 2] = position;
+                locations[t][(c * 2) + 1] = writeColumn(table.columns[c], order, table.rows);
+            }
+            table.rows = 0;
+        }
+        chunkFrames.add(new int[] { firstFrame, lastFrame });
+        chunkColumns.add(locations);
+        chunkRows.add(rows);
+        firstFrame = -1;
+    }
+
+    // Writes the values of a column in the given row order and returns the number of bytes.
+    private int writeColumn(final int[] values, final int[] order, final int rows)
+            throws IOException {
+        if (encoded.length < (rows * 5)) {
+            encoded = new byte[rows * 5];
+        }
+        int length = 0;
+        int previous = 0;
+        for (int i = 0; i < rows; i++) {
+            final int value = values[(order != null) ? order[i] : i];
+            final int delta = value - previous;
+            int zigzag = (delta << 1) ^ (delta >> 31);
+            while ((zigzag & ~0x7F) != 0) {
+                encoded[length++] = (byte) ((zigzag & 0x7F) | 0x80);
+                zigzag >>>= 7;
+            }
+            encoded[length++] = (byte) zigzag;
+            previous = value;
+        }
+
+        deflater.reset();
+        deflater.setInput(encoded, 0, length);
+        deflater.finish();
+        int size = 0;
+        while (!deflater.finished()) {
+            if (size == compressed.length) {
+                compressed = Arrays.copyOf(compressed, compressed.length * 2);
+            }
+            size += deflater.deflate(compressed, size, compressed.length - size);
+        }
+        out.write(compressed, 0, size);
+        position += size;
+        return size;
+    }
+
+    /**
+     * The rows of one table in the current chunk, stored by column.
+     */
+    private static final class Table {
+
+        final String name;
+        final String[] columnNames;
+        final int[][] columns;
+        // column whose value groups the rows of a chunk, or -1 to keep the rows in order
+        final int groupColumn;
+        int rows;
+
+        Table(final String name, final String[] columnNames, final int groupColumn) {
+            this.name = name;
+            this.columnNames = columnNames;
+            this.groupColumn = groupColumn;
+            columns = new int[columnNames.length][1024];
+        }
+
+        int addRow() {
+            if (rows == columns[0].length) {
+                for (int i = 0; i < columns.length; i++) {
+                    columns[i] = Arrays.copyOf(columns[i], rows * 2);
+                }
+            }
+            return rows++;
+        }
+
+        // Orders the rows by the group column and then by the order they were added in.
+        int[] order() {
+            if (groupColumn < 0) {
+                return null;
+            }
+            final long[] keys = new long[rows];
+            for (int i = 0; i < rows; i++) {
+                keys[i] = ((long) columns[groupColumn][i] << 32) | i;
+            }
+            Arrays.sort(keys);
+            final int[] order = new int[rows];
+            for (int i = 0; i < rows; i++) {
+                order[i] = (int) keys[i];
+            }
+            return order;
+        }
+    }
+}
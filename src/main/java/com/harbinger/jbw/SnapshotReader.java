@@ -0,0 +1,235 @@
+package com.harbinger.jbw;
+
+import java.io.*;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+
+/**
+ * Reads the frames a bridge publishes into a snapshot ring file through
+ * {@link Broodwar#publishSnapshots(File, int)}, from any process and without slowing down the
+ * bridge.
+ *
+ * <p>
+ * The file is a header followed by a fixed number of slots, all made of little-endian 32-bit
+ * integers. The bridge writes frame {@code g} (counting from 1) into slot {@code (g - 1) % slots},
+ * then stores {@code g} in the header. The sequence of a slot is odd while the slot is written, so
+ * a reader that sees the same even sequence before and after copying a slot has a consistent
+ * frame; otherwise it was overwritten and the reader tries again with the latest frame.
+ *
+ * <pre>
+ * header := magic version slots slotSize unitSize playerSize latest reserved[9]
+ * slot   := sequence generation frame playerCount unitCount totalUnits reserved[2]
+ *           (playerId minerals gas supplyUsed supplyTotal gatheredMinerals gatheredGas
+ *            unitScore killScore buildingScore razingScore)* unit*
+ * </pre>
+ *
+ * <p>
+ * Sizes are in integers. A unit is the record the bridge sends for each {@link Unit}, with the
+ * attributes of the units table of {@link ReplayDataReader} after its frame. Units that did not
+ * fit the slot are left out, so {@code totalUnits} may exceed {@code unitCount}.
+ *
+ * <p>
+ * The sequence check relies on the reads of a slot being seen in program order, which x86 and
+ * x86-64 guarantee for plain loads. The bridge only runs on x86 Windows and the file is only
+ * shared through that machine's memory, so the reader takes no fences; Java 8 has no portable
+ * load fence, and a reader ported to a weaker memory model must add one after each sequence
+ * read and before the second one.
+ */
+public class SnapshotReader implements Closeable {
+
+    static final int MAGIC = 0x4A425753; // "JBWS"
+    static final int VERSION = 1;
+
+    private static final int HEADER_SIZE = 16;
+    private static final int LATEST = 6;
+    private static final int SLOT_HEADER_SIZE = 8;
+
+    // attempts to copy the latest frame before giving up, each fails only if the bridge lapped us
+    private static final int MAX_ATTEMPTS = 16;
+
+    private final RandomAccessFile file;
+    private final IntBuffer ints;
+    private final int slots;
+    private final int slotSize;
+    private final int unitSize;
+    private final int playerSize;
+
+    /**
+     * Maps a snapshot ring file for reading.
+     *
+     * @param file
+     *            the file the bridge publishes to
+     *
+     * @throws IOException
+     *             if the file could not be mapped or is not a snapshot ring
+     */
+    public SnapshotReader(final File file) throws IOException {
+        this.file = new RandomAccessFile(file, "r");
+        try {
+            final MappedByteBuffer buffer =
+                    this.file.getChannel().map(FileChannel.MapMode.READ_ONLY, 0, file.length());
+            ints = buffer.order(ByteOrder.LITTLE_ENDIAN).asIntBuffer();
+            if ((ints.capacity() < HEADER_SIZE) || (ints.get(0) != MAGIC)
+                    || (ints.get(1) != VERSION)) {
+                throw new IOException("Not a snapshot ring of version " + VERSION + ": " + file);
+            }
+            slots = ints.get(2);
+            slotSize = ints.get(3);
+            unitSize = ints.get(4);
+            playerSize = ints.get(5);
+            if ((slots < 1) || (slotSize < SLOT_HEADER_SIZE)
+                    || (ints.capacity() < (HEADER_SIZE + ((long) slots * slotSize)))) {
+                throw new IOException("Snapshot ring is truncated: " + file);
+            }
+            if (unitSize != Unit.NUM_ATTRIBUTES) {
+                throw new IOException("Snapshot ring was written by another version: " + file);
+            }
+        } catch (final IOException ex) {
+            this.file.close();
+            throw ex;
+        }
+    }
+
+    /**
+     * @return the generation of the latest published frame, or 0 if none has been published
+     */
+    public int getLatestGeneration() {
+        return ints.get(LATEST);
+    }
+
+    /**
+     * Copies the latest published frame.
+     *
+     * @return the frame, or null if none has been published yet or the bridge kept overwriting
+     *         the frames faster than they could be copied
+     */
+    public Snapshot readLatest() {
+        for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+            final int generation = ints.get(LATEST);
+            if (generation <= 0) {
+                return null;
+            }
+            final Snapshot snapshot = read(generation);
+            if (snapshot != null) {
+                return snapshot;
+            }
+        }
+        return null;
+    }
+
+    /**
+     * Copies a published frame if it is still in the ring.
+     *
+     * @param generation
+     *            the generation of the frame
+     *
+     * @return the frame, or null if it has been overwritten or is being written
+     */
+    public Snapshot read(final int generation) {
+        // plain loads, ordered on the machines the bridge runs on, see the class doc
+        final int slot = HEADER_SIZE + (((generation - 1) % slots) * slotSize);
+        final int sequence = ints.get(slot);
+        if (((sequence & 1) != 0) || (ints.get(slot + 1) != generation)) {
+            return null;
+        }
+        final int frame = ints.get(slot + 2);
+        final int playerCount = ints.get(slot + 3);
+        final int unitCount = ints.get(slot + 4);
+        final int totalUnits = ints.get(slot + 5);
+        final int playerLength = playerCount * playerSize;
+        final int unitLength = unitCount * unitSize;
+        if ((playerCount < 0) || (unitCount < 0)
+                || ((SLOT_HEADER_SIZE + playerLength + unitLength) > slotSize)) {
+            return null;
+        }
+        final int[] playerData = new int[playerLength];
+        final int[] unitData = new int[unitLength];
+        final IntBuffer data = ints.duplicate();
+        data.position(slot + SLOT_HEADER_SIZE);
+        data.get(playerData);
+        data.get(unitData);
+        if (ints.get(slot) != sequence) {
+            return null;
+        }
+        return new Snapshot(generation, frame, totalUnits, playerSize, playerData, unitData);
+    }
+
+    @Override
+    public void close() throws IOException {
+        file.close();
+    }
+
+    /**
+     * A consistent copy of one published frame.
+     */
+    public static final class Snapshot {
+
+        private final int generation;
+        private final int frame;
+        private final int totalUnits;
+        private final int playerSize;
+        private final int[] playerData;
+        private final int[] unitData;
+
+        Snapshot(final int generation, final int frame, final int totalUnits,
+                final int playerSize, final int[] playerData, final int[] unitData) {
+            this.generation = generation;
+            this.frame = frame;
+            this.totalUnits = totalUnits;
+            this.playerSize = playerSize;
+            this.playerData = playerData;
+            this.unitData = unitData;
+        }
+
+        /**
+         * @return the number of frames the bridge had published when this one was, counting it
+         */
+        public int getGeneration() {
+            return generation;
+        }
+
+        /**
+         * @return the frame of the match
+         */
+        public int getFrame() {
+            return frame;
+        }
+
+        /**
+         * @return the number of players
+         */
+        public int getPlayerCount() {
+            return playerData.length / playerSize;
+        }
+
+        /**
+         * @return the players, each as its ID followed by its resources, supply and scores
+         */
+        public int[] getPlayerData() {
+            return playerData;
+        }
+
+        /**
+         * @return the number of units in the snapshot
+         */
+        public int getUnitCount() {
+            return unitData.length / Unit.NUM_ATTRIBUTES;
+        }
+
+        /**
+         * @return the number of accessible units in the frame, including those that did not fit
+         */
+        public int getTotalUnitCount() {
+            return totalUnits;
+        }
+
+        /**
+         * @return the unit records, one after another
+         */
+        public int[] getUnitData() {
+            return unitData;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+package com.harbinger.jbw;
+
+/**
+ * Selects the terrain analysis and runs the BWTA terrain analysis.
+ *
+ * <p>
+ * Maps are analyzed by the native terrain analysis of the client bridge unless the
+ * {@value #ANALYZER_PROPERTY} system property is set to <i>bwta</i>. The BWTA analysis lives in its
+ * own native library, as it depends on the large CGAL, GMP and MPFR libraries. These are only
+ * loaded the first time a map without cached map data is analyzed with BWTA.
+ */
+final class TerrainAnalyzer {
+
+    /** System property selecting the terrain analysis, either <i>native</i> or <i>bwta</i>. */
+    static final String ANALYZER_PROPERTY = "jbw.terrain.analyzer";
+
+    private static boolean loaded;
+
+    private TerrainAnalyzer() {
+    }
+
+    /**
+     * @return true if maps are analyzed with BWTA; false if by the client bridge
+     */
+    static boolean isBwtaSelected() {
+        return "bwta".equalsIgnoreCase(System.getProperty(ANALYZER_PROPERTY));
+    }
+
+    /**
+     * Analyzes the terrain of the current map with BWTA.
+     *
+     * @param game
+     *            handle of the game, as returned by the client bridge
+     *
+     * @return the base locations of the map, or null if the analysis is not available
+     */
+    static synchronized int[] analyzeBaseLocations(final long game) {
+        if (!loaded) {
+            // the order is important
+            loaded = NativeLibraries.load("gmp-vc90-mt.dll")
+                    && NativeLibraries.load("mpfr-vc90-mt.dll")
+                    && NativeLibraries.load("terrain-bridge.dll");
+            if (!loaded) {
+                return null;
+            }
+        }
+        analyze(game);
+        return getBaseLocations();
+    }
+
+    private static native void analyze(final long game);
+
+    private static native int[] getBaseLocations();
+}
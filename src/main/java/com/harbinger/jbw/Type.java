@@ -429,6 +429,14 @@ public class Type {
         public int getId() {
             return id;
         }
+
+        /**
+         * @return true if BWAPI takes the target position of this command in build tiles, as for
+         *         the commands that place a building
+         */
+        boolean takesBuildTile() {
+            return (this == BUILD) || (this == LAND) || (this == PLACE_COP);
+        }
     }
 
     /**
@@ -1206,8 +1214,10 @@ public class Type {
         Undefined232(232), // Factories (BWAPI4)
         Unknown(233);
 
+        // BEGIN GENERATED unitType.size
         static final int NUM_ATTRIBUTES = 57;
-        private static final double fixedScale = 100.0;
+        // END GENERATED unitType.size
+        private static final double FIXED_SCALE = 100.0;
 
         private final int id;
         private int raceId;
@@ -1285,9 +1295,11 @@ public class Type {
 
         public void initialize(final int[] data, int index, final String name,
                 final int[] requiredUnits) {
-            if (id != data[index++]) {
+            if (id != data[index]) {
                 throw new IllegalArgumentException();
             }
+            // BEGIN GENERATED unitType.decode
+            index++; // id
             raceId = data[index++];
             whatBuildId = data[index++];
             requiredTechId = data[index++];
@@ -1318,7 +1330,7 @@ public class Type {
             maxGroundHits = data[index++];
             airWeaponID = data[index++];
             maxAirHits = data[index++];
-            topSpeed = data[index++] / fixedScale;
+            topSpeed = data[index++] / FIXED_SCALE;
             acceleration = data[index++];
             haltDistance = data[index++];
             turnRadius = data[index++];
@@ -1344,6 +1356,7 @@ public class Type {
             addon = data[index++] == 1;
             flyingBuilding = data[index++] == 1;
             spell = data[index++] == 1;
+            // END GENERATED unitType.decode
 
             this.name = name;
             for (int i = 0; i < requiredUnits.length; i += 2) {
@@ -42,12 +42,34 @@ public class Unit {
 
     // TODO: Create a null unit
 
-    static final int NUM_ATTRIBUTES = 123;
+    // BEGIN GENERATED unit.size
+    static final int NUM_ATTRIBUTES = 73;
+    // END GENERATED unit.size
+
+    // BEGIN GENERATED unit.columns
+    static final String[] ATTRIBUTE_NAMES = {
+            "id", "replayId", "playerId", "typeId", "x", "y", "tileX", "tileY", "angle",
+            "velocityX", "velocityY", "hitPoints", "shield", "energy", "resources", "resourceGroup",
+            "lastCommandFrame", "lastCommandId", "lastAttackingPlayerId", "initialTypeId",
+            "initialX", "initialY", "initialTileX", "initialTileY", "initialHitPoints",
+            "initialResources", "killCount", "acidSporeCount", "interceptorCount", "scarabCount",
+            "spiderMineCount", "groundWeaponCooldown", "airWeaponCooldown", "spellCooldown",
+            "defenseMatrixPoints", "defenseMatrixTimer", "ensnareTimer", "irradiateTimer",
+            "lockdownTimer", "maelstromTimer", "orderTimer", "plagueTimer", "removeTimer",
+            "stasisTimer", "stimTimer", "buildTypeId", "trainingQueueSize", "researchingTechId",
+            "upgradingUpgradeId", "remainingBuildTimer", "remainingTrainTime",
+            "remainingResearchTime", "remainingUpgradeTime", "buildUnitId", "targetUnitId",
+            "targetX", "targetY", "orderId", "orderTargetId", "secondaryOrderId", "rallyX",
+            "rallyY", "rallyUnitId", "addOnId", "nydusExitUnitId", "transportId",
+            "loadedUnitsCount", "carrierUnitId", "hatcheryUnitId", "larvaCount", "powerUpUnitId",
+            "bits0", "bits1"
+    };
+    // END GENERATED unit.columns
 
     private static final double FIXED_SCALE = 100.0;
     private static final double TO_DEGREES = 180.0 / Math.PI;
 
-    private final Broodwar broodwar;
+    private final GameContext broodwar;
 
     private final int id;
     private int replayId;
@@ -174,6 +196,10 @@ public class Unit {
     private boolean visible;
 
     public Unit(final int id, final Broodwar broodwar) {
+        this(id, broodwar.getContext());
+    }
+
+    Unit(final int id, final GameContext broodwar) {
         this.id = id;
         this.broodwar = broodwar;
     }
@@ -183,7 +209,8 @@ public class Unit {
     }
 
     public void update(final int[] data, int index) {
-        index++; // ID = data[index++];
+        // BEGIN GENERATED unit.decode
+        index++; // id
         replayId = data[index++];
         playerId = data[index++];
         typeId = data[index++];
@@ -254,58 +281,61 @@ public class Unit {
         hatcheryUnitId = data[index++];
         larvaCount = data[index++];
         powerUpUnitId = data[index++];
-        exists = data[index++] == 1;
-        nukeReady = data[index++] == 1;
-        accelerating = data[index++] == 1;
-        attacking = data[index++] == 1;
-        attackFrame = data[index++] == 1;
-        beingConstructed = data[index++] == 1;
-        beingGathered = data[index++] == 1;
-        beingHealed = data[index++] == 1;
-        blind = data[index++] == 1;
-        braking = data[index++] == 1;
-        burrowed = data[index++] == 1;
-        carryingGas = data[index++] == 1;
-        carryingMinerals = data[index++] == 1;
-        cloaked = data[index++] == 1;
-        completed = data[index++] == 1;
-        constructing = data[index++] == 1;
-        defenseMatrixed = data[index++] == 1;
-        detected = data[index++] == 1;
-        ensnared = data[index++] == 1;
-        following = data[index++] == 1;
-        gatheringGas = data[index++] == 1;
-        gatheringMinerals = data[index++] == 1;
-        hallucination = data[index++] == 1;
-        holdingPosition = data[index++] == 1;
-        idle = data[index++] == 1;
-        interruptable = data[index++] == 1;
-        invincible = data[index++] == 1;
-        irradiated = data[index++] == 1;
-        lifted = data[index++] == 1;
-        loaded = data[index++] == 1;
-        lockedDown = data[index++] == 1;
-        maelstrommed = data[index++] == 1;
-        morphing = data[index++] == 1;
-        moving = data[index++] == 1;
-        parasited = data[index++] == 1;
-        patrolling = data[index++] == 1;
-        plagued = data[index++] == 1;
-        repairing = data[index++] == 1;
-        selected = data[index++] == 1;
-        sieged = data[index++] == 1;
-        startingAttack = data[index++] == 1;
-        stasised = data[index++] == 1;
-        stimmed = data[index++] == 1;
-        stuck = data[index++] == 1;
-        training = data[index++] == 1;
-        underAttack = data[index++] == 1;
-        underDarkSwarm = data[index++] == 1;
-        underDisruptionWeb = data[index++] == 1;
-        underStorm = data[index++] == 1;
-        unpowered = data[index++] == 1;
-        upgrading = data[index++] == 1;
-        visible = data[index++] == 1;
+        int bits = data[index++];
+        exists = (bits & 1) != 0;
+        nukeReady = (bits & (1 << 1)) != 0;
+        accelerating = (bits & (1 << 2)) != 0;
+        attacking = (bits & (1 << 3)) != 0;
+        attackFrame = (bits & (1 << 4)) != 0;
+        beingConstructed = (bits & (1 << 5)) != 0;
+        beingGathered = (bits & (1 << 6)) != 0;
+        beingHealed = (bits & (1 << 7)) != 0;
+        blind = (bits & (1 << 8)) != 0;
+        braking = (bits & (1 << 9)) != 0;
+        burrowed = (bits & (1 << 10)) != 0;
+        carryingGas = (bits & (1 << 11)) != 0;
+        carryingMinerals = (bits & (1 << 12)) != 0;
+        cloaked = (bits & (1 << 13)) != 0;
+        completed = (bits & (1 << 14)) != 0;
+        constructing = (bits & (1 << 15)) != 0;
+        defenseMatrixed = (bits & (1 << 16)) != 0;
+        detected = (bits & (1 << 17)) != 0;
+        ensnared = (bits & (1 << 18)) != 0;
+        following = (bits & (1 << 19)) != 0;
+        gatheringGas = (bits & (1 << 20)) != 0;
+        gatheringMinerals = (bits & (1 << 21)) != 0;
+        hallucination = (bits & (1 << 22)) != 0;
+        holdingPosition = (bits & (1 << 23)) != 0;
+        idle = (bits & (1 << 24)) != 0;
+        interruptable = (bits & (1 << 25)) != 0;
+        invincible = (bits & (1 << 26)) != 0;
+        irradiated = (bits & (1 << 27)) != 0;
+        lifted = (bits & (1 << 28)) != 0;
+        loaded = (bits & (1 << 29)) != 0;
+        lockedDown = (bits & (1 << 30)) != 0;
+        bits = data[index++];
+        maelstrommed = (bits & 1) != 0;
+        morphing = (bits & (1 << 1)) != 0;
+        moving = (bits & (1 << 2)) != 0;
+        parasited = (bits & (1 << 3)) != 0;
+        patrolling = (bits & (1 << 4)) != 0;
+        plagued = (bits & (1 << 5)) != 0;
+        repairing = (bits & (1 << 6)) != 0;
+        selected = (bits & (1 << 7)) != 0;
+        sieged = (bits & (1 << 8)) != 0;
+        startingAttack = (bits & (1 << 9)) != 0;
+        stasised = (bits & (1 << 10)) != 0;
+        stimmed = (bits & (1 << 11)) != 0;
+        stuck = (bits & (1 << 12)) != 0;
+        training = (bits & (1 << 13)) != 0;
+        underAttack = (bits & (1 << 14)) != 0;
+        underDarkSwarm = (bits & (1 << 15)) != 0;
+        underDisruptionWeb = (bits & (1 << 16)) != 0;
+        underStorm = (bits & (1 << 17)) != 0;
+        unpowered = (bits & (1 << 18)) != 0;
+        upgrading = (bits & (1 << 19)) != 0;
+        visible = (bits & (1 << 20)) != 0;
+        // END GENERATED unit.decode
     }
 
     @Override
@@ -385,19 +415,19 @@ public class Unit {
     }
 
     public int getLeft() {
-        return x - getType().getDimensionLeft();
+        return getX() - getType().getDimensionLeft();
     }
 
     public int getTop() {
-        return y - getType().getDimensionUp();
+        return getY() - getType().getDimensionUp();
     }
 
     public int getRight() {
-        return x + getType().getDimensionRight();
+        return getX() + getType().getDimensionRight();
     }
 
     public int getBottom() {
-        return y + getType().getDimensionDown();
+        return getY() + getType().getDimensionDown();
     }
 
     /**
@@ -421,6 +451,34 @@ public class Unit {
         return UnitType.getUnitType(typeId);
     }
 
+    /**
+     * @return the (pixel) Position of the center of this unit
+     */
+    public Position getPosition() {
+        return new Position(getX(), getY(), Resolution.PIXEL);
+    }
+
+    /**
+     * @return the (build) Position of the top-left tile of this unit
+     */
+    public Position getTilePosition() {
+        return new Position(tileX, tileY, Resolution.BUILD);
+    }
+
+    /**
+     * @return the x pixel coordinate of the center of this unit
+     */
+    public int getX() {
+        return x;
+    }
+
+    /**
+     * @return the y pixel coordinate of the center of this unit
+     */
+    public int getY() {
+        return y;
+    }
+
     public double getAngle() {
         return angle;
     }
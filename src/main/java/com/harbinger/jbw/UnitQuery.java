@@ -0,0 +1,299 @@
+package com.harbinger.jbw;
+
+import com.harbinger.jbw.Type.UnitType;
+
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.List;
+
+/**
+ * A filter over the units in the game that is evaluated by the bridge rather than in Java.
+ *
+ * <p>
+ * A query is a conjunction of conditions, each of which can be negated with {@link #not()}. For
+ * example, the visible enemy ground units that are not buildings, within 12 tiles of a base and
+ * below half of their hit points:
+ *
+ * <pre>
+ * final UnitQuery weakAttackers = new UnitQuery().enemy().not().flying().visible().not()
+ *         .building().within(base, 12 * 32).hitPointsBelow(50);
+ * broodwar.addUnitQuery(weakAttackers);
+ * </pre>
+ *
+ * <p>
+ * Once added through {@link Broodwar#addUnitQuery(UnitQuery)} the query is compiled by the bridge
+ * and can no longer be changed. All added queries are evaluated together in a single pass over the
+ * units every frame the agent is run, and only the matching units are sent to Java.
+ */
+public class UnitQuery {
+
+    // opcodes, must match UnitQueryOp in client-bridge.cpp
+    private static final int PLAYER = 0;
+    private static final int SELF = 1;
+    private static final int ALLY = 2;
+    private static final int ENEMY = 3;
+    private static final int NEUTRAL = 4;
+    private static final int TYPE = 5;
+    private static final int FLYING = 6;
+    private static final int BUILDING = 7;
+    private static final int WORKER = 8;
+    private static final int VISIBLE = 9;
+    private static final int COMPLETED = 10;
+    private static final int IDLE = 11;
+    private static final int CLOAKED = 12;
+    private static final int UNDER_ATTACK = 13;
+    private static final int WITHIN = 14;
+    private static final int HIT_POINTS_BELOW = 15;
+    private static final int TYPE_IN = 16;
+    private static final int NEGATE = 1 << 16;
+
+    private int[] code = new int[8];
+    private int length;
+    private boolean negateNext;
+
+    private int handle = -1;
+    private List<Unit> units = Collections.emptyList();
+
+    /**
+     * Negates the condition that is added next.
+     *
+     * @return this query
+     */
+    public UnitQuery not() {
+        checkModifiable();
+        negateNext = !negateNext;
+        return this;
+    }
+
+    /**
+     * Matches units owned by the given player.
+     *
+     * @param player
+     *            the owner
+     *
+     * @return this query
+     */
+    public UnitQuery ownedBy(final Player player) {
+        return add(PLAYER, player.getId());
+    }
+
+    /**
+     * Matches units owned by the agent. Never matches in replays.
+     *
+     * @return this query
+     */
+    public UnitQuery own() {
+        return add(SELF);
+    }
+
+    /**
+     * Matches units owned by allies of the agent. Never matches in replays.
+     *
+     * @return this query
+     */
+    public UnitQuery allied() {
+        return add(ALLY);
+    }
+
+    /**
+     * Matches units owned by enemies of the agent. Never matches in replays.
+     *
+     * @return this query
+     */
+    public UnitQuery enemy() {
+        return add(ENEMY);
+    }
+
+    /**
+     * Matches units owned by the neutral player, such as mineral fields and critters.
+     *
+     * @return this query
+     */
+    public UnitQuery neutral() {
+        return add(NEUTRAL);
+    }
+
+    /**
+     * Matches units of the given type.
+     *
+     * @param type
+     *            the unit type
+     *
+     * @return this query
+     */
+    public UnitQuery ofType(final UnitType type) {
+        return add(TYPE, type.getId());
+    }
+
+    /**
+     * Matches units of any of the given types.
+     *
+     * @param types
+     *            the unit types
+     *
+     * @return this query
+     */
+    public UnitQuery ofTypes(final UnitType... types) {
+        // one bit per unit type ID, which are all below 256
+        final int[] mask = new int[8];
+        for (final UnitType type : types) {
+            mask[type.getId() >>> 5] |= 1 << (type.getId() & 31);
+        }
+        return add(TYPE_IN, mask);
+    }
+
+    /**
+     * Matches air units and lifted buildings.
+     *
+     * @return this query
+     */
+    public UnitQuery flying() {
+        return add(FLYING);
+    }
+
+    /**
+     * Matches buildings.
+     *
+     * @return this query
+     */
+    public UnitQuery building() {
+        return add(BUILDING);
+    }
+
+    /**
+     * Matches workers.
+     *
+     * @return this query
+     */
+    public UnitQuery worker() {
+        return add(WORKER);
+    }
+
+    /**
+     * Matches units that are visible to the agent.
+     *
+     * @return this query
+     */
+    public UnitQuery visible() {
+        return add(VISIBLE);
+    }
+
+    /**
+     * Matches completed units.
+     *
+     * @return this query
+     */
+    public UnitQuery completed() {
+        return add(COMPLETED);
+    }
+
+    /**
+     * Matches idle units.
+     *
+     * @return this query
+     */
+    public UnitQuery idle() {
+        return add(IDLE);
+    }
+
+    /**
+     * Matches cloaked units.
+     *
+     * @return this query
+     */
+    public UnitQuery cloaked() {
+        return add(CLOAKED);
+    }
+
+    /**
+     * Matches units that are under attack.
+     *
+     * @return this query
+     */
+    public UnitQuery underAttack() {
+        return add(UNDER_ATTACK);
+    }
+
+    /**
+     * Matches units whose center is within a circular area.
+     *
+     * @param center
+     *            the center of the area
+     *
+     * @param radius
+     *            the radius of the area in pixels
+     *
+     * @return this query
+     */
+    public UnitQuery within(final Position center, final int radius) {
+        if (radius < 0) {
+            throw new IllegalArgumentException("radius cannot be negative");
+        }
+        return add(WITHIN, center.getPX(), center.getPY(), radius);
+    }
+
+    /**
+     * Matches units whose hit points are below a percentage of the maximum hit points of their
+     * type.
+     *
+     * @param percent
+     *            the percentage of the maximum hit points
+     *
+     * @return this query
+     */
+    public UnitQuery hitPointsBelow(final int percent) {
+        if ((percent < 0) || (percent > 100)) {
+            throw new IllegalArgumentException("percent must be between 0 and 100");
+        }
+        return add(HIT_POINTS_BELOW, percent);
+    }
+
+    /**
+     * @return the units that matched this query when the agent was last run; empty until the
+     *         query has been added and a frame has passed
+     */
+    public List<Unit> getUnits() {
+        return units;
+    }
+
+    private UnitQuery add(final int op, final int... operands) {
+        checkModifiable();
+        if ((length + 1 + operands.length) > code.length) {
+            code = Arrays.copyOf(code, Math.max(code.length * 2, length + 1 + operands.length));
+        }
+        code[length++] = negateNext ? (op | NEGATE) : op;
+        for (final int operand : operands) {
+            code[length++] = operand;
+        }
+        negateNext = false;
+        return this;
+    }
+
+    private void checkModifiable() {
+        if (handle >= 0) {
+            throw new IllegalStateException("query cannot be changed once added");
+        }
+    }
+
+    int[] compile() {
+        if (negateNext) {
+            throw new IllegalStateException("not() must be followed by a condition");
+        }
+        return Arrays.copyOf(code, length);
+    }
+
+    int getHandle() {
+        return handle;
+    }
+
+    void setHandle(final int handle) {
+        this.handle = handle;
+        if (handle < 0) {
+            units = Collections.emptyList();
+        }
+    }
+
+    void setUnits(final List<Unit> units) {
+        this.units = units;
+    }
+}
@@ -0,0 +1,55 @@
+package com.harbinger.jbw;
+
+/**
+ * A change in the state of a unit between two consecutive frames, detected by the bridge.
+ *
+ * <p>
+ * Agents {@link Broodwar#addUnitTransitionListener(UnitTransition, UnitTransitionListener)
+ * subscribe} to the kinds they are interested in. Only subscribed kinds are detected and sent over
+ * from the bridge.
+ */
+public enum UnitTransition {
+    /** The unit became idle. */
+    BECAME_IDLE(0),
+    /** A unit was added to the training queue. The value is the new queue size. */
+    TRAINING_STARTED(1),
+    /**
+     * The unit at the front of the training queue finished, detected once the trained unit is
+     * completed, so canceled training is not reported. The value is the queue size after it.
+     */
+    TRAINING_FINISHED(2),
+    /**
+     * The unit lost hit points or shields. The value is the total amount lost. Changes of the type
+     * of the unit, such as morphs and sieging, are not damage.
+     */
+    DAMAGED(3),
+    /** The unit started attacking. */
+    ATTACK_STARTED(4),
+    /** The unit became cloaked. */
+    CLOAKED(5),
+    /** The unit stopped being cloaked. */
+    DECLOAKED(6),
+    /** The building lifted off. */
+    LIFTED(7),
+    /** The building landed. */
+    LANDED(8);
+
+    private final int id;
+
+    private UnitTransition(final int id) {
+        this.id = id;
+    }
+
+    static UnitTransition getTransition(final int id) {
+        for (final UnitTransition transition : values()) {
+            if (transition.id == id) {
+                return transition;
+            }
+        }
+        return null;
+    }
+
+    int getMask() {
+        return 1 << id;
+    }
+}
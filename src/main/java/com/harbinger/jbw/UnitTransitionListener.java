@@ -0,0 +1,30 @@
+package com.harbinger.jbw;
+
+/**
+ * Serves as a callback interface for {@link UnitTransition unit transitions}. The implementing class
+ * is registered for each kind of transition it is interested in through
+ * {@link Broodwar#addUnitTransitionListener(UnitTransition, UnitTransitionListener)}.
+ *
+ * <p>
+ * Transitions are delivered in order with the events of the {@link BroodwarListener}: the
+ * transitions detected in a frame come after the events of earlier frames and before the events of
+ * that frame, so they always precede its {@link BroodwarListener#matchFrame()}. When the agent is
+ * not run every frame, the transitions and events of the skipped frames are delivered in the
+ * order they occurred, but a transition whose unit was destroyed in the meantime is dropped.
+ */
+public interface UnitTransitionListener {
+
+    /**
+     * Invoked when a unit has undergone a subscribed transition.
+     *
+     * @param unit
+     *            the unit that changed
+     *
+     * @param transition
+     *            the kind of change
+     *
+     * @param value
+     *            additional information dependent on the kind of transition
+     */
+    public void unitTransition(final Unit unit, final UnitTransition transition, final int value);
+}
@@ -0,0 +1,1123 @@
+package com.harbinger.jbw;
+
+import com.harbinger.jbw.Position.Resolution;
+import com.harbinger.jbw.Type.Command;
+import com.harbinger.jbw.Type.Order;
+import com.harbinger.jbw.Type.Tech;
+import com.harbinger.jbw.Type.UnitType;
+import com.harbinger.jbw.Type.Upgrade;
+
+/**
+ * A flyweight {@link Unit} that decodes its attributes from the unit data of the frame only when a
+ * getter is called, instead of copying all of them on every update.
+ *
+ * <p>
+ * A UnitView is a handle made of the unit's ID and its slot in the frame's unit data. The same
+ * UnitView is kept for a unit across frames, so it can be used as a key in maps just like an
+ * eagerly updated Unit. A destroyed UnitView keeps answering with the data of the last frame it was
+ * seen in, as that frame's data is not reused.
+ *
+ * <p>
+ * Enabled through {@link Broodwar#setFlyweightUnits(boolean)}.
+ */
+public class UnitView extends Unit {
+
+    private static final double FIXED_SCALE = 100.0;
+    private static final double TO_DEGREES = 180.0 / Math.PI;
+
+    private final GameContext broodwar;
+
+    private int[] data = new int[NUM_ATTRIBUTES];
+    private int offset;
+    private boolean destroyed;
+
+    public UnitView(final int id, final Broodwar broodwar) {
+        this(id, broodwar.getContext());
+    }
+
+    UnitView(final int id, final GameContext broodwar) {
+        super(id, broodwar);
+        this.broodwar = broodwar;
+    }
+
+    @Override
+    public void setDestroyed() {
+        destroyed = true;
+    }
+
+    @Override
+    public void update(final int[] data, final int index) {
+        this.data = data;
+        offset = index;
+    }
+
+    @Override
+    public int getReplayId() {
+        return replayId();
+    }
+
+    @Override
+    public Player getPlayer() {
+        return broodwar.getPlayer(playerId());
+    }
+
+    @Override
+    public UnitType getType() {
+        return UnitType.getUnitType(typeId());
+    }
+
+    @Override
+    public Position getTilePosition() {
+        return new Position(tileX(), tileY(), Resolution.BUILD);
+    }
+
+    @Override
+    public int getX() {
+        return x();
+    }
+
+    @Override
+    public int getY() {
+        return y();
+    }
+
+    @Override
+    public double getAngle() {
+        return angle();
+    }
+
+    @Override
+    public double getVelocityX() {
+        return velocityX();
+    }
+
+    @Override
+    public double getVelocityY() {
+        return velocityY();
+    }
+
+    @Override
+    public int getHitPoints() {
+        return hitPoints();
+    }
+
+    @Override
+    public int getShields() {
+        return shield();
+    }
+
+    @Override
+    public int getEnergy() {
+        return energy();
+    }
+
+    @Override
+    public int getResources() {
+        return resources();
+    }
+
+    @Override
+    public int getResourceGroup() {
+        return resourceGroup();
+    }
+
+    @Override
+    public int getLastCommandFrame() {
+        return lastCommandFrame();
+    }
+
+    @Override
+    public Command getLastCommand() {
+        return Command.getCommandType(lastCommandId());
+    }
+
+    @Override
+    public Player getLastAttackingPlayer() {
+        return broodwar.getPlayer(lastAttackingPlayerId());
+    }
+
+    @Override
+    public UnitType getInitialType() {
+        return UnitType.getUnitType(initialTypeId());
+    }
+
+    @Override
+    public Position getInitialPosition() {
+        return new Position(initialX(), initialY(), Resolution.PIXEL);
+    }
+
+    @Override
+    public int getInitialHitPoints() {
+        return initialHitPoints();
+    }
+
+    @Override
+    public int getInitialResources() {
+        return initialResources();
+    }
+
+    @Override
+    public int getKillCount() {
+        return killCount();
+    }
+
+    @Override
+    public int getAcidSporeCount() {
+        return acidSporeCount();
+    }
+
+    @Override
+    public int getInterceptorCount() {
+        return interceptorCount();
+    }
+
+    @Override
+    public int getScarabCount() {
+        return scarabCount();
+    }
+
+    @Override
+    public int getSpiderMineCount() {
+        return spiderMineCount();
+    }
+
+    @Override
+    public int getGroundWeaponCooldown() {
+        return groundWeaponCooldown();
+    }
+
+    @Override
+    public int getAirWeaponCooldown() {
+        return airWeaponCooldown();
+    }
+
+    @Override
+    public int getSpellCooldown() {
+        return spellCooldown();
+    }
+
+    @Override
+    public int getDefenseMatrixPoints() {
+        return defenseMatrixPoints();
+    }
+
+    @Override
+    public int getDefenseMatrixTimer() {
+        return defenseMatrixTimer();
+    }
+
+    @Override
+    public int getEnsnareTimer() {
+        return ensnareTimer();
+    }
+
+    @Override
+    public int getIrradiateTimer() {
+        return irradiateTimer();
+    }
+
+    @Override
+    public int getLockdownTimer() {
+        return lockdownTimer();
+    }
+
+    @Override
+    public int getMaelstromTimer() {
+        return maelstromTimer();
+    }
+
+    @Override
+    public int getOrderTimer() {
+        return orderTimer();
+    }
+
+    @Override
+    public int getPlagueTimer() {
+        return plagueTimer();
+    }
+
+    @Override
+    public int getRemoveTimer() {
+        return removeTimer();
+    }
+
+    @Override
+    public int getStasisTimer() {
+        return stasisTimer();
+    }
+
+    @Override
+    public int getStimTimer() {
+        return stimTimer();
+    }
+
+    @Override
+    public UnitType getBuildType() {
+        return UnitType.getUnitType(buildTypeId());
+    }
+
+    @Override
+    public int getTrainingQueueSize() {
+        return trainingQueueSize();
+    }
+
+    @Override
+    public Tech getTech() {
+        return Tech.getTechType(researchingTechId());
+    }
+
+    @Override
+    public Upgrade getUpgrade() {
+        return Upgrade.getUpgradeType(upgradingUpgradeId());
+    }
+
+    @Override
+    public int getRemainingBuildTimer() {
+        return remainingBuildTimer();
+    }
+
+    @Override
+    public int getRemainingTrainTime() {
+        return remainingTrainTime();
+    }
+
+    @Override
+    public int getRemainingResearchTime() {
+        return remainingResearchTime();
+    }
+
+    @Override
+    public int getRemainingUpgradeTime() {
+        return remainingUpgradeTime();
+    }
+
+    @Override
+    public Unit getBuildUnit() {
+        return broodwar.getUnit(buildUnitId());
+    }
+
+    @Override
+    public Unit getTarget() {
+        return broodwar.getUnit(targetUnitId());
+    }
+
+    @Override
+    public Position getTargetPosition() {
+        return new Position(targetX(), targetY(), Resolution.PIXEL);
+    }
+
+    @Override
+    public Order getOrder() {
+        return Order.getOrderType(orderId());
+    }
+
+    @Override
+    public Unit getOrderTarget() {
+        return broodwar.getUnit(orderTargetId());
+    }
+
+    @Override
+    public Order getSecondaryOrder() {
+        return Order.getOrderType(secondaryOrderId());
+    }
+
+    @Override
+    public Position getRallyPosition() {
+        return new Position(rallyX(), rallyY(), Resolution.PIXEL);
+    }
+
+    @Override
+    public Unit getRallyUnit() {
+        return broodwar.getUnit(rallyUnitId());
+    }
+
+    @Override
+    public Unit getAddon() {
+        return broodwar.getUnit(addOnId());
+    }
+
+    @Override
+    public Unit getNydusExit() {
+        return broodwar.getUnit(nydusExitUnitId());
+    }
+
+    @Override
+    public Unit getTransport() {
+        return broodwar.getUnit(transportId());
+    }
+
+    @Override
+    public int getLoadedUnitsCount() {
+        return loadedUnitsCount();
+    }
+
+    @Override
+    public Unit getCarrier() {
+        return broodwar.getUnit(carrierUnitId());
+    }
+
+    @Override
+    public Unit getHatchery() {
+        return broodwar.getUnit(hatcheryUnitId());
+    }
+
+    @Override
+    public int getLarvaCount() {
+        return larvaCount();
+    }
+
+    @Override
+    public Unit getPowerUp() {
+        return broodwar.getUnit(powerUpUnitId());
+    }
+
+    @Override
+    public boolean isExists() {
+        return !destroyed && exists();
+    }
+
+    @Override
+    public boolean isNukeReady() {
+        return nukeReady();
+    }
+
+    @Override
+    public boolean isAccelerating() {
+        return accelerating();
+    }
+
+    @Override
+    public boolean isAttacking() {
+        return attacking();
+    }
+
+    @Override
+    public boolean isAttackFrame() {
+        return attackFrame();
+    }
+
+    @Override
+    public boolean isBeingConstructed() {
+        return beingConstructed();
+    }
+
+    @Override
+    public boolean isBeingGathered() {
+        return beingGathered();
+    }
+
+    @Override
+    public boolean isBeingHealed() {
+        return beingHealed();
+    }
+
+    @Override
+    public boolean isBlind() {
+        return blind();
+    }
+
+    @Override
+    public boolean isBraking() {
+        return braking();
+    }
+
+    @Override
+    public boolean isBurrowed() {
+        return burrowed();
+    }
+
+    @Override
+    public boolean isCarryingGas() {
+        return carryingGas();
+    }
+
+    @Override
+    public boolean isCarryingMinerals() {
+        return carryingMinerals();
+    }
+
+    @Override
+    public boolean isCloaked() {
+        return cloaked();
+    }
+
+    @Override
+    public boolean isCompleted() {
+        return completed();
+    }
+
+    @Override
+    public boolean isConstructing() {
+        return constructing();
+    }
+
+    @Override
+    public boolean isDefenseMatrixed() {
+        return defenseMatrixed();
+    }
+
+    @Override
+    public boolean isDetected() {
+        return detected();
+    }
+
+    @Override
+    public boolean isEnsnared() {
+        return ensnared();
+    }
+
+    @Override
+    public boolean isFollowing() {
+        return following();
+    }
+
+    @Override
+    public boolean isGatheringGas() {
+        return gatheringGas();
+    }
+
+    @Override
+    public boolean isGatheringMinerals() {
+        return gatheringMinerals();
+    }
+
+    @Override
+    public boolean isHallucination() {
+        return hallucination();
+    }
+
+    @Override
+    public boolean isHoldingPosition() {
+        return holdingPosition();
+    }
+
+    @Override
+    public boolean isIdle() {
+        return idle();
+    }
+
+    @Override
+    public boolean isInterruptable() {
+        return interruptable();
+    }
+
+    @Override
+    public boolean isInvincible() {
+        return invincible();
+    }
+
+    @Override
+    public boolean isIrradiated() {
+        return irradiated();
+    }
+
+    @Override
+    public boolean isLifted() {
+        return lifted();
+    }
+
+    @Override
+    public boolean isLoaded() {
+        return loaded();
+    }
+
+    @Override
+    public boolean isLockedDown() {
+        return lockedDown();
+    }
+
+    @Override
+    public boolean isMaelstrommed() {
+        return maelstrommed();
+    }
+
+    @Override
+    public boolean isMorphing() {
+        return morphing();
+    }
+
+    @Override
+    public boolean isMoving() {
+        return moving();
+    }
+
+    @Override
+    public boolean isParasited() {
+        return parasited();
+    }
+
+    @Override
+    public boolean isPatrolling() {
+        return patrolling();
+    }
+
+    @Override
+    public boolean isPlagued() {
+        return plagued();
+    }
+
+    @Override
+    public boolean isRepairing() {
+        return repairing();
+    }
+
+    @Override
+    public boolean isSelected() {
+        return selected();
+    }
+
+    @Override
+    public boolean isSieged() {
+        return sieged();
+    }
+
+    @Override
+    public boolean isStartingAttack() {
+        return startingAttack();
+    }
+
+    @Override
+    public boolean isStasised() {
+        return stasised();
+    }
+
+    @Override
+    public boolean isStimmed() {
+        return stimmed();
+    }
+
+    @Override
+    public boolean isStuck() {
+        return stuck();
+    }
+
+    @Override
+    public boolean isTraining() {
+        return training();
+    }
+
+    @Override
+    public boolean isUnderAttack() {
+        return underAttack();
+    }
+
+    @Override
+    public boolean isUnderDarkSwarm() {
+        return underDarkSwarm();
+    }
+
+    @Override
+    public boolean isUnderDisruptionWeb() {
+        return underDisruptionWeb();
+    }
+
+    @Override
+    public boolean isUnderStorm() {
+        return underStorm();
+    }
+
+    @Override
+    public boolean isUnpowered() {
+        return unpowered();
+    }
+
+    @Override
+    public boolean isUpgrading() {
+        return upgrading();
+    }
+
+    @Override
+    public boolean isVisible() {
+        return visible();
+    }
+
+    // BEGIN GENERATED unit.view
+    private int replayId() {
+        return data[offset + 1];
+    }
+
+    private int playerId() {
+        return data[offset + 2];
+    }
+
+    private int typeId() {
+        return data[offset + 3];
+    }
+
+    private int x() {
+        return data[offset + 4];
+    }
+
+    private int y() {
+        return data[offset + 5];
+    }
+
+    private int tileX() {
+        return data[offset + 6];
+    }
+
+    private int tileY() {
+        return data[offset + 7];
+    }
+
+    private double angle() {
+        return data[offset + 8] / TO_DEGREES;
+    }
+
+    private double velocityX() {
+        return data[offset + 9] / FIXED_SCALE;
+    }
+
+    private double velocityY() {
+        return data[offset + 10] / FIXED_SCALE;
+    }
+
+    private int hitPoints() {
+        return data[offset + 11];
+    }
+
+    private int shield() {
+        return data[offset + 12];
+    }
+
+    private int energy() {
+        return data[offset + 13];
+    }
+
+    private int resources() {
+        return data[offset + 14];
+    }
+
+    private int resourceGroup() {
+        return data[offset + 15];
+    }
+
+    private int lastCommandFrame() {
+        return data[offset + 16];
+    }
+
+    private int lastCommandId() {
+        return data[offset + 17];
+    }
+
+    private int lastAttackingPlayerId() {
+        return data[offset + 18];
+    }
+
+    private int initialTypeId() {
+        return data[offset + 19];
+    }
+
+    private int initialX() {
+        return data[offset + 20];
+    }
+
+    private int initialY() {
+        return data[offset + 21];
+    }
+
+    private int initialTileX() {
+        return data[offset + 22];
+    }
+
+    private int initialTileY() {
+        return data[offset + 23];
+    }
+
+    private int initialHitPoints() {
+        return data[offset + 24];
+    }
+
+    private int initialResources() {
+        return data[offset + 25];
+    }
+
+    private int killCount() {
+        return data[offset + 26];
+    }
+
+    private int acidSporeCount() {
+        return data[offset + 27];
+    }
+
+    private int interceptorCount() {
+        return data[offset + 28];
+    }
+
+    private int scarabCount() {
+        return data[offset + 29];
+    }
+
+    private int spiderMineCount() {
+        return data[offset + 30];
+    }
+
+    private int groundWeaponCooldown() {
+        return data[offset + 31];
+    }
+
+    private int airWeaponCooldown() {
+        return data[offset + 32];
+    }
+
+    private int spellCooldown() {
+        return data[offset + 33];
+    }
+
+    private int defenseMatrixPoints() {
+        return data[offset + 34];
+    }
+
+    private int defenseMatrixTimer() {
+        return data[offset + 35];
+    }
+
+    private int ensnareTimer() {
+        return data[offset + 36];
+    }
+
+    private int irradiateTimer() {
+        return data[offset + 37];
+    }
+
+    private int lockdownTimer() {
+        return data[offset + 38];
+    }
+
+    private int maelstromTimer() {
+        return data[offset + 39];
+    }
+
+    private int orderTimer() {
+        return data[offset + 40];
+    }
+
+    private int plagueTimer() {
+        return data[offset + 41];
+    }
+
+    private int removeTimer() {
+        return data[offset + 42];
+    }
+
+    private int stasisTimer() {
+        return data[offset + 43];
+    }
+
+    private int stimTimer() {
+        return data[offset + 44];
+    }
+
+    private int buildTypeId() {
+        return data[offset + 45];
+    }
+
+    private int trainingQueueSize() {
+        return data[offset + 46];
+    }
+
+    private int researchingTechId() {
+        return data[offset + 47];
+    }
+
+    private int upgradingUpgradeId() {
+        return data[offset + 48];
+    }
+
+    private int remainingBuildTimer() {
+        return data[offset + 49];
+    }
+
+    private int remainingTrainTime() {
+        return data[offset + 50];
+    }
+
+    private int remainingResearchTime() {
+        return data[offset + 51];
+    }
+
+    private int remainingUpgradeTime() {
+        return data[offset + 52];
+    }
+
+    private int buildUnitId() {
+        return data[offset + 53];
+    }
+
+    private int targetUnitId() {
+        return data[offset + 54];
+    }
+
+    private int targetX() {
+        return data[offset + 55];
+    }
+
+    private int targetY() {
+        return data[offset + 56];
+    }
+
+    private int orderId() {
+        return data[offset + 57];
+    }
+
+    private int orderTargetId() {
+        return data[offset + 58];
+    }
+
+    private int secondaryOrderId() {
+        return data[offset + 59];
+    }
+
+    private int rallyX() {
+        return data[offset + 60];
+    }
+
+    private int rallyY() {
+        return data[offset + 61];
+    }
+
+    private int rallyUnitId() {
+        return data[offset + 62];
+    }
+
+    private int addOnId() {
+        return data[offset + 63];
+    }
+
+    private int nydusExitUnitId() {
+        return data[offset + 64];
+    }
+
+    private int transportId() {
+        return data[offset + 65];
+    }
+
+    private int loadedUnitsCount() {
+        return data[offset + 66];
+    }
+
+    private int carrierUnitId() {
+        return data[offset + 67];
+    }
+
+    private int hatcheryUnitId() {
+        return data[offset + 68];
+    }
+
+    private int larvaCount() {
+        return data[offset + 69];
+    }
+
+    private int powerUpUnitId() {
+        return data[offset + 70];
+    }
+
+    private boolean exists() {
+        return (data[offset + 71] & 1) != 0;
+    }
+
+    private boolean nukeReady() {
+        return (data[offset + 71] & (1 << 1)) != 0;
+    }
+
+    private boolean accelerating() {
+        return (data[offset + 71] & (1 << 2)) != 0;
+    }
+
+    private boolean attacking() {
+        return (data[offset + 71] & (1 << 3)) != 0;
+    }
+
+    private boolean attackFrame() {
+        return (data[offset + 71] & (1 << 4)) != 0;
+    }
+
+    private boolean beingConstructed() {
+        return (data[offset + 71] & (1 << 5)) != 0;
+    }
+
+    private boolean beingGathered() {
+        return (data[offset + 71] & (1 << 6)) != 0;
+    }
+
+    private boolean beingHealed() {
+        return (data[offset + 71] & (1 << 7)) != 0;
+    }
+
+    private boolean blind() {
+        return (data[offset + 71] & (1 << 8)) != 0;
+    }
+
+    private boolean braking() {
+        return (data[offset + 71] & (1 << 9)) != 0;
+    }
+
+    private boolean burrowed() {
+        return (data[offset + 71] & (1 << 10)) != 0;
+    }
+
+    private boolean carryingGas() {
+        return (data[offset + 71] & (1 << 11)) != 0;
+    }
+
+    private boolean carryingMinerals() {
+        return (data[offset + 71] & (1 << 12)) != 0;
+    }
+
+    private boolean cloaked() {
+        return (data[offset + 71] & (1 << 13)) != 0;
+    }
+
+    private boolean completed() {
+        return (data[offset + 71] & (1 << 14)) != 0;
+    }
+
+    private boolean constructing() {
+        return (data[offset + 71] & (1 << 15)) != 0;
+    }
+
+    private boolean defenseMatrixed() {
+        return (data[offset + 71] & (1 << 16)) != 0;
+    }
+
+    private boolean detected() {
+        return (data[offset + 71] & (1 << 17)) != 0;
+    }
+
+    private boolean ensnared() {
+        return (data[offset + 71] & (1 << 18)) != 0;
+    }
+
+    private boolean following() {
+        return (data[offset + 71] & (1 << 19)) != 0;
+    }
+
+    private boolean gatheringGas() {
+        return (data[offset + 71] & (1 << 20)) != 0;
+    }
+
+    private boolean gatheringMinerals() {
+        return (data[offset + 71] & (1 << 21)) != 0;
+    }
+
+    private boolean hallucination() {
+        return (data[offset + 71] & (1 << 22)) != 0;
+    }
+
+    private boolean holdingPosition() {
+        return (data[offset + 71] & (1 << 23)) != 0;
+    }
+
+    private boolean idle() {
+        return (data[offset + 71] & (1 << 24)) != 0;
+    }
+
+    private boolean interruptable() {
+        return (data[offset + 71] & (1 << 25)) != 0;
+    }
+
+    private boolean invincible() {
+        return (data[offset + 71] & (1 << 26)) != 0;
+    }
+
+    private boolean irradiated() {
+        return (data[offset + 71] & (1 << 27)) != 0;
+    }
+
+    private boolean lifted() {
+        return (data[offset + 71] & (1 << 28)) != 0;
+    }
+
+    private boolean loaded() {
+        return (data[offset + 71] & (1 << 29)) != 0;
+    }
+
+    private boolean lockedDown() {
+        return (data[offset + 71] & (1 << 30)) != 0;
+    }
+
+    private boolean maelstrommed() {
+        return (data[offset + 72] & 1) != 0;
+    }
+
+    private boolean morphing() {
+        return (data[offset + 72] & (1 << 1)) != 0;
+    }
+
+    private boolean moving() {
+        return (data[offset + 72] & (1 << 2)) != 0;
+    }
+
+    private boolean parasited() {
+        return (data[offset + 72] & (1 << 3)) != 0;
+    }
+
+    private boolean patrolling() {
+        return (data[offset + 72] & (1 << 4)) != 0;
+    }
+
+    private boolean plagued() {
+        return (data[offset + 72] & (1 << 5)) != 0;
+    }
+
+    private boolean repairing() {
+        return (data[offset + 72] & (1 << 6)) != 0;
+    }
+
+    private boolean selected() {
+        return (data[offset + 72] & (1 << 7)) != 0;
+    }
+
+    private boolean sieged() {
+        return (data[offset + 72] & (1 << 8)) != 0;
+    }
+
+    private boolean startingAttack() {
+        return (data[offset + 72] & (1 << 9)) != 0;
+    }
+
+    private boolean stasised() {
+        return (data[offset + 72] & (1 << 10)) != 0;
+    }
+
+    private boolean stimmed() {
+        return (data[offset + 72] & (1 << 11)) != 0;
+    }
+
+    private boolean stuck() {
+        return (data[offset + 72] & (1 << 12)) != 0;
+    }
+
+    private boolean training() {
+        return (data[offset + 72] & (1 << 13)) != 0;
+    }
+
+    private boolean underAttack() {
+        return (data[offset + 72] & (1 << 14)) != 0;
+    }
+
+    private boolean underDarkSwarm() {
+        return (data[offset + 72] & (1 << 15)) != 0;
+    }
+
+    private boolean underDisruptionWeb() {
+        return (data[offset + 72] & (1 << 16)) != 0;
+    }
+
+    private boolean underStorm() {
+        return (data[offset + 72] & (1 << 17)) != 0;
+    }
+
+    private boolean unpowered() {
+        return (data[offset + 72] & (1 << 18)) != 0;
+    }
+
+    private boolean upgrading() {
+        return (data[offset + 72] & (1 << 19)) != 0;
+    }
+
+    private boolean visible() {
+        return (data[offset + 72] & (1 << 20)) != 0;
+    }
+    // END GENERATED unit.view
+}
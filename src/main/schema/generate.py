@@ -0,0 +1,376 @@
+"""Generates the bridge wire format code from bridge.schema.
+
+Writes the C++ record writers to the headers in src/main/c named by the schema and rewrites the Java regions
+between "// BEGIN GENERATED <record>.<part>" and "// END GENERATED <record>.<part>" markers found
+under src/main/java. The parts are:
+
+    size     the NUM_ATTRIBUTES constant
+    decode   sequential decoding of a record starting at data[index]
+    view     private accessors decoding single fields from data[offset + ...]
+    columns  the ATTRIBUTE_NAMES of the slots, packed slots being named bits0, bits1, ...
+
+Run from anywhere: python src/main/schema/generate.py
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", ".."))
+SCHEMA = os.path.join(ROOT, "src", "main", "schema", "bridge.schema")
+NATIVE_SOURCES = os.path.join(ROOT, "src", "main", "c")
+JAVA_SOURCES = os.path.join(ROOT, "src", "main", "java")
+
+# packed fields never use the sign bit, so the Java side can treat every slot as a plain int
+BITS_PER_SLOT = 31
+
+MARKER = re.compile(r"^([ \t]*)// (BEGIN|END) GENERATED (\w+)\.(\w+)\s*$")
+
+
+class Field(object):
+
+    def __init__(self, kind, name, expr, raw, width):
+        self.kind = kind
+        self.name = name
+        self.expr = expr
+        self.raw = raw
+        self.width = width
+        self.slot = None
+        self.shift = None
+
+    def packed(self):
+        return self.kind in ("bit", "bits")
+
+    def java_type(self):
+        if self.kind in ("bit", "flag"):
+            return "boolean"
+        if self.kind in ("fixed", "angle"):
+            return "double"
+        return "int"
+
+
+class Record(object):
+
+    def __init__(self, name, param, raw_param, locals_, header):
+        self.name = name
+        self.header = header
+        self.param = param
+        self.raw_param = raw_param
+        self.locals = locals_
+        self.fields = []
+        self.size = 0
+
+    def layout(self):
+        """Assigns a slot to every field, packing consecutive bits into shared slots."""
+        slot = 0
+        used = None
+        for f in self.fields:
+            if not f.packed():
+                used = None
+                f.slot = slot
+                slot += 1
+                continue
+            if used is None or used + f.width > BITS_PER_SLOT:
+                slot += 1
+                used = 0
+            f.slot = slot - 1
+            f.shift = used
+            used += f.width
+        self.size = slot
+
+
+def parse(path):
+    records = []
+    record = None
+    header = None
+    with open(path) as source:
+        for number, line in enumerate(source, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+
+            def fail(message):
+                sys.exit("%s:%d: %s" % (path, number, message))
+
+            words = line.split()
+            if record is None and words[0] == "header":
+                if len(words) != 2:
+                    fail("expected 'header <file>'")
+                header = words[1]
+            elif record is None:
+                if header is None:
+                    fail("expected 'header <file>' before the first record")
+                if words[0] != "record" or len(words) < 3:
+                    fail("expected 'record <name> <c++ parameter> [@ <raw parameter>] [locals]'")
+                locals_ = words[-1] == "locals"
+                if locals_:
+                    words = words[:-1]
+                param, _, raw_param = " ".join(words[2:]).partition(" @ ")
+                record = Record(words[1], param, raw_param or None, locals_, header)
+            elif words[0] == "end":
+                record.layout()
+                records.append(record)
+                record = None
+            else:
+                parts = line.split(None, 2)
+                if len(parts) != 3:
+                    fail("expected '<kind> <name> <c++ expression> [@ <raw expression>]'")
+                kind, name, expr = parts
+                expr, _, raw = expr.partition(" @ ")
+                expr, raw = expr.strip(), raw.strip() or None
+                if raw is not None and record.raw_param is None:
+                    fail("raw expression in a record without a raw parameter")
+                width = 1
+                if kind.startswith("bits:"):
+                    kind, width = "bits", int(kind[5:])
+                    if not 0 < width < BITS_PER_SLOT:
+                        fail("bit width must be between 1 and %d" % (BITS_PER_SLOT - 1))
+                if kind not in ("key", "int", "ref", "fixed", "angle", "flag", "bit", "bits"):
+                    fail("unknown kind '%s'" % kind)
+                record.fields.append(Field(kind, name, expr, raw, width))
+    if record is not None:
+        sys.exit("%s: record '%s' is missing 'end'" % (path, record.name))
+    return records
+
+
+def upper_first(name):
+    return name[0].upper() + name[1:]
+
+
+# C++ ---------------------------------------------------------------------------------------------
+
+def cpp_value(field, raw=False):
+    expr = field.raw if raw and field.raw else field.expr
+    if field.kind == "ref":
+        # a raw reference already is the ID
+        return expr if raw and field.raw else "refID(%s)" % expr
+    if field.kind == "fixed":
+        return "static_cast<int>(fixedScale * %s)" % expr
+    if field.kind == "angle":
+        return "static_cast<int>(TO_DEGREES * %s)" % expr
+    if field.kind == "flag":
+        return "(%s) ? 1 : 0" % expr
+    if field.kind == "bit":
+        return "(%s ? 1 : 0)" % expr
+    if field.kind == "bits":
+        return "(static_cast<int>(%s) & 0x%x)" % (expr, (1 << field.width) - 1)
+    return expr
+
+
+def cpp_writer(record, raw=False):
+    if raw:
+        lines = [
+            "/**",
+            "* Writes the same %s record as write%s, reading the fields it can straight" % (
+                record.name, upper_first(record.name)),
+            "* from the raw data instead of through the accessors.",
+            "*/",
+            "inline int write%sRaw(jint* buf, int index, %s, %s)" % (
+                upper_first(record.name), record.param, record.raw_param),
+            "{",
+        ]
+    else:
+        lines = [
+            "const int %sRecordSize = %d;" % (record.name, record.size),
+            "",
+            "/**",
+            "* Writes a %s record of %d values to buf at index and returns the index after it." % (
+                record.name, record.size),
+            "*/",
+            "inline int write%s(jint* buf, int index, %s)" % (upper_first(record.name), record.param),
+            "{",
+        ]
+    declared = False
+    for i, f in enumerate(record.fields):
+        if f.packed():
+            if f.shift == 0:
+                lines.append("\t%sbits = 0;" % ("" if declared else "int "))
+                declared = True
+            value = cpp_value(f, raw)
+            lines.append("\tbits |= %s << %d; // %s" % (value, f.shift, f.name) if f.shift else
+                         "\tbits |= %s; // %s" % (value, f.name))
+            last = i + 1 == len(record.fields)
+            if last or not record.fields[i + 1].packed() or record.fields[i + 1].slot != f.slot:
+                lines.append("\tbuf[index++] = bits;")
+        else:
+            lines.append("\tbuf[index++] = %s; // %s" % (cpp_value(f, raw), f.name))
+    lines.append("\treturn index;")
+    lines.append("}")
+    return lines
+
+
+def generate_header(header, records):
+    guard = "_Included_" + re.sub(r"\W", "_", header[:-2])
+    lines = [
+        "/* DO NOT EDIT THIS FILE - it is generated from src/main/schema/bridge.schema */",
+        "",
+        "/**",
+        "* Writers for the fixed size records the bridge sends to Java. Expects the namespaces of the",
+        "* written types to be in scope and TO_DEGREES and fixedScale to be defined by the includer.",
+        "*/",
+        "",
+        "#ifndef " + guard,
+        "#define " + guard,
+    ]
+    if any(f.kind == "ref" for r in records for f in r.fields):
+        lines.extend([
+            "",
+            "#ifndef _Included_refID",
+            "#define _Included_refID",
+            "/**",
+            "* Returns the ID of the object, or -1 if there is none.",
+            "*/",
+            "template<class T> inline int refID(T* p)",
+            "{",
+            "\treturn (p != NULL) ? p->getID() : -1;",
+            "}",
+            "#endif",
+        ])
+    for record in records:
+        lines.append("")
+        lines.extend(cpp_writer(record))
+        if record.raw_param:
+            lines.append("")
+            lines.extend(cpp_writer(record, True))
+    lines.append("")
+    lines.append("#endif")
+    return lines
+
+
+# Java --------------------------------------------------------------------------------------------
+
+def java_decode_value(field, source):
+    if field.kind == "flag":
+        return "%s == 1" % source
+    if field.kind == "fixed":
+        return "%s / FIXED_SCALE" % source
+    if field.kind == "angle":
+        return "%s / TO_DEGREES" % source
+    return source
+
+
+def java_bits_value(field, slot):
+    if field.kind == "bit":
+        mask = "(1 << %d)" % field.shift if field.shift else "1"
+        return "(%s & %s) != 0" % (slot, mask)
+    shifted = "(%s >>> %d)" % (slot, field.shift) if field.shift else slot
+    return "%s & 0x%x" % (shifted, (1 << field.width) - 1)
+
+
+def java_size(record):
+    return ["static final int NUM_ATTRIBUTES = %d;" % record.size]
+
+
+def java_decode(record):
+    lines = []
+    declared = False
+    for f in record.fields:
+        prefix = "final %s " % f.java_type() if record.locals else ""
+        if f.kind == "key":
+            lines.append("index++; // %s" % f.name)
+        elif f.packed():
+            if f.shift == 0:
+                lines.append("%sbits = data[index++];" % ("" if declared else "int "))
+                declared = True
+            lines.append("%s%s = %s;" % (prefix, f.name, java_bits_value(f, "bits")))
+        else:
+            lines.append("%s%s = %s;" % (prefix, f.name, java_decode_value(f, "data[index++]")))
+    return lines
+
+
+def java_view(record):
+    lines = []
+    for f in record.fields:
+        if f.kind == "key":
+            continue
+        source = "data[offset + %d]" % f.slot
+        value = java_bits_value(f, source) if f.packed() else java_decode_value(f, source)
+        if lines:
+            lines.append("")
+        lines.append("private %s %s() {" % (f.java_type(), f.name))
+        lines.append("    return %s;" % value)
+        lines.append("}")
+    return lines
+
+
+def java_columns(record):
+    names = []
+    packed = 0
+    for f in record.fields:
+        if not f.packed():
+            names.append('"%s"' % f.name)
+        elif f.shift == 0:
+            names.append('"bits%d"' % packed)
+            packed += 1
+    lines = ["static final String[] ATTRIBUTE_NAMES = {"]
+    line = ""
+    for i, name in enumerate(names):
+        item = name + ("," if i + 1 < len(names) else "")
+        if line and len(line) + 1 + len(item) > 88:
+            lines.append("        " + line)
+            line = item
+        else:
+            line = (line + " " + item) if line else item
+    lines.append("        " + line)
+    lines.append("};")
+    return lines
+
+
+PARTS = {"size": java_size, "decode": java_decode, "view": java_view, "columns": java_columns}
+
+
+def rewrite_java(path, records):
+    with open(path, "rb") as source:
+        text = source.read().decode("utf-8")
+    if "// BEGIN GENERATED" not in text:
+        return False
+    newline = "\r\n" if "\r\n" in text else "\n"
+    out = []
+    region = None
+    for line in text.split(newline):
+        match = MARKER.match(line)
+        if region is None:
+            out.append(line)
+            if match and match.group(2) == "BEGIN":
+                indent, name, part = match.group(1), match.group(3), match.group(4)
+                if name not in records or part not in PARTS:
+                    sys.exit("%s: unknown generated region %s.%s" % (path, name, part))
+                region = (name, part)
+                for generated in PARTS[part](records[name]):
+                    out.append(indent + generated if generated else "")
+        elif match and match.group(2) == "END":
+            if (match.group(3), match.group(4)) != region:
+                sys.exit("%s: mismatched end of generated region %s.%s" % (path, region[0],
+                                                                           region[1]))
+            out.append(line)
+            region = None
+    if region is not None:
+        sys.exit("%s: generated region %s.%s is not closed" % (path, region[0], region[1]))
+    with open(path, "wb") as target:
+        target.write(newline.join(out).encode("utf-8"))
+    return True
+
+
+def main():
+    records = parse(SCHEMA)
+    headers = []
+    for record in records:
+        if record.header not in headers:
+            headers.append(record.header)
+    for header in headers:
+        path = os.path.join(NATIVE_SOURCES, header)
+        lines = generate_header(header, [r for r in records if r.header == header])
+        with open(path, "wb") as target:
+            target.write(("\r\n".join(lines) + "\r\n").encode("utf-8"))
+        print("wrote %s" % os.path.relpath(path, ROOT))
+
+    by_name = dict((r.name, r) for r in records)
+    for directory, _, files in os.walk(JAVA_SOURCES):
+        for name in sorted(files):
+            path = os.path.join(directory, name)
+            if name.endswith(".java") and rewrite_java(path, by_name):
+                print("wrote %s" % os.path.relpath(path, ROOT))
+
+
+if __name__ == "__main__":
+    main()
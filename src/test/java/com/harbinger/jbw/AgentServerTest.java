@@ -0,0 +1,160 @@
+package com.harbinger.jbw;
+
+import static com.harbinger.jbw.Position.Resolution.PIXEL;
+import static org.hamcrest.CoreMatchers.equalTo;
+import static org.hamcrest.CoreMatchers.is;
+import static org.hamcrest.CoreMatchers.sameInstance;
+import static org.junit.Assert.assertThat;
+
+import com.harbinger.jbw.Type.Command;
+
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.net.Socket;
+import java.util.List;
+import java.util.concurrent.CopyOnWriteArrayList;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import org.junit.Test;
+
+/**
+ * This test is responsible for ensuring that an agent in another process receives the game state
+ * and events through the agent server and that its commands are issued, without the game.
+ */
+public class AgentServerTest {
+
+    private static final int UNIT_ID = 7;
+    private static final int HIT_POINTS = 35;
+
+    private final List<int[]> issuedCommands = new CopyOnWriteArrayList<>();
+    private final List<Integer> shownUnits = new CopyOnWriteArrayList<>();
+    private final CountDownLatch frameHandled = new CountDownLatch(1);
+
+    private RemoteBroodwar remote;
+    private Unit remoteUnit;
+
+    @Test(timeout = 10000)
+    public void loopback() throws Exception {
+        final InetSocketAddress address =
+                new InetSocketAddress(InetAddress.getLoopbackAddress(), 0);
+        try (AgentServer server = new AgentServer(address, (unitId, commandId, targetId, x, y,
+                extra) -> issuedCommands.add(new int[] { unitId, commandId, targetId, x, y,
+                        extra }))) {
+            remote = new RemoteBroodwar(new RemoteAgent());
+            final Thread agentThread = new Thread(() -> {
+                try {
+                    remote.connect(server.getAddress());
+                } catch (final IOException ex) {
+                    throw new AssertionError(ex);
+                }
+            });
+            agentThread.start();
+            while (server.getClientCount() == 0) {
+                Thread.sleep(10);
+            }
+
+            final int[] unitData = getUnitData();
+            server.matchStarted("0000", getPlayerData(), new String[] { "agent", "enemy" },
+                    unitData);
+            server.beginFrame(1);
+            server.addPlayer(0, new int[11]);
+            server.addUnits(unitData);
+            server.addEvent(EventType.UNIT_SHOW.ordinal(), UNIT_ID, 0, null);
+            server.endFrame();
+            assertThat(frameHandled.await(5, TimeUnit.SECONDS), is(true));
+
+            assertThat(remote.getFrame(), is(equalTo(1)));
+            assertThat(remote.getUnits().size(), is(equalTo(1)));
+            assertThat(remoteUnit.getPlayer(), is(sameInstance(remote.getAgent())));
+            assertThat(remoteUnit.getHitPoints(), is(equalTo(HIT_POINTS)));
+            assertThat(shownUnits.get(0), is(equalTo(UNIT_ID)));
+
+            // the commands are issued on a later frame, once they have arrived
+            int frame = 2;
+            while (issuedCommands.isEmpty()) {
+                Thread.sleep(10);
+                server.beginFrame(frame++);
+            }
+            assertThat(issuedCommands.get(0),
+                    is(equalTo(new int[] { UNIT_ID, Command.MOVE.getId(), -1, 64, 96, 0 })));
+
+            remote.close();
+            agentThread.join();
+        }
+    }
+
+    @Test(timeout = 10000)
+    public void invalidMessageDisconnects() throws Exception {
+        final InetSocketAddress address =
+                new InetSocketAddress(InetAddress.getLoopbackAddress(), 0);
+        try (AgentServer server = new AgentServer(address, (unitId, commandId, targetId, x, y,
+                extra) -> issuedCommands.add(new int[] { unitId, commandId, targetId, x, y,
+                        extra }));
+                Socket socket = new Socket()) {
+            socket.connect(server.getAddress());
+            while (server.getClientCount() == 0) {
+                Thread.sleep(10);
+            }
+
+            // a command count that does not match the length of the message
+            final DataOutputStream out = new DataOutputStream(socket.getOutputStream());
+            out.writeInt(AgentServer.COMMANDS);
+            out.writeInt(4);
+            out.writeInt(Integer.MAX_VALUE);
+            out.flush();
+
+            while (server.getClientCount() > 0) {
+                Thread.sleep(10);
+            }
+            final String writerName = "jbw-agent-writer " + socket.getLocalSocketAddress();
+            while (isThreadAlive(writerName)) {
+                Thread.sleep(10);
+            }
+            assertThat(issuedCommands.isEmpty(), is(true));
+        }
+    }
+
+    private static boolean isThreadAlive(final String name) {
+        for (final Thread thread : Thread.getAllStackTraces().keySet()) {
+            if (thread.getName().equals(name) && thread.isAlive()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // the agent and an enemy
+    private static int[] getPlayerData() {
+        final int[] data = new int[Player.NUM_ATTRIBUTES * 2];
+        data[5] = 1; // self
+        data[Player.NUM_ATTRIBUTES] = 1; // id
+        data[Player.NUM_ATTRIBUTES + 7] = 1; // enemy
+        return data;
+    }
+
+    // a unit of the agent
+    private static int[] getUnitData() {
+        final int[] data = new int[Unit.NUM_ATTRIBUTES];
+        data[0] = UNIT_ID;
+        data[11] = HIT_POINTS;
+        return data;
+    }
+
+    private class RemoteAgent extends BroodwarListener.Adaptor {
+
+        @Override
+        public void unitShow(final Unit unit) {
+            shownUnits.add(unit.getId());
+        }
+
+        @Override
+        public void matchFrame() {
+            remoteUnit = remote.getUnits().get(0);
+            remote.issueCommand(remoteUnit, Command.MOVE, null, new Position(64, 96, PIXEL), 0);
+            frameHandled.countDown();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+package com.harbinger.jbw;
+
+import static com.harbinger.jbw.Position.Resolution.BUILD;
+import static com.harbinger.jbw.Position.Resolution.WALK;
+import static org.hamcrest.CoreMatchers.equalTo;
+import static org.hamcrest.CoreMatchers.is;
+import static org.junit.Assert.assertThat;
+
+import java.util.Arrays;
+
+import org.junit.Test;
+
+/**
+ * This test is responsible for ensuring that the regions found in a recorded map without the game
+ * are those the native terrain analysis finds.
+ */
+public class RegionAnalysisTest {
+
+    private static final int WIDTH = 32;
+    private static final int HEIGHT = 16;
+
+    /*
+     * Two rooms split by a wall four walk tiles thick, with a gap of six walk tiles in its middle.
+     * The expected values are those of terrain-analyzer.cpp for the same walk tiles.
+     */
+    @Test
+    public void twoRoomsAndAGap() {
+        final int walkWidth = WIDTH * 4;
+        final int walkHeight = HEIGHT * 4;
+        final int[] walkable = new int[walkWidth * walkHeight];
+        Arrays.fill(walkable, 1);
+        for (int y = 0; y < walkHeight; y++) {
+            for (int x = 62; x < 66; x++) {
+                if ((y < 29) || (y >= 35)) {
+                    walkable[x + (walkWidth * y)] = 0;
+                }
+            }
+        }
+        final int[] tiles = new int[WIDTH * HEIGHT];
+        final GameMap map =
+                new GameMap("rooms", "rooms.scm", WIDTH, HEIGHT, tiles, tiles, walkable);
+
+        map.analyzeRegions();
+
+        assertThat(map.getRegions().size(), is(equalTo(2)));
+        final Region left = map.getRegions().get(0);
+        final Region right = map.getRegions().get(1);
+        assertThat(left.getCenter(), is(equalTo(new Position(31, 31, WALK))));
+        assertThat(left.getClearance(), is(equalTo(31 * 8)));
+        assertThat(left.getArea(), is(equalTo(4055)));
+        assertThat(right.getCenter(), is(equalTo(new Position(96, 31, WALK))));
+        assertThat(right.getArea(), is(equalTo(3905)));
+
+        assertThat(map.getChokepoints().size(), is(equalTo(1)));
+        final Chokepoint gap = map.getChokepoints().get(0);
+        assertThat(gap.getFirstRegion(), is(left));
+        assertThat(gap.getSecondRegion(), is(right));
+        assertThat(gap.getCenter(), is(equalTo(new Position(65, 31, WALK))));
+        assertThat(gap.getWidth(), is(equalTo(6 * 8)));
+
+        assertThat(map.getRegion(new Position(2, 2, BUILD)), is(left));
+        assertThat(map.getRegion(new Position(29, 13, BUILD)), is(right));
+    }
+}
@@ -0,0 +1,144 @@
+package com.harbinger.jbw;
+
+import static org.hamcrest.CoreMatchers.equalTo;
+import static org.hamcrest.CoreMatchers.is;
+import static org.junit.Assert.assertThat;
+
+import java.io.File;
+import java.util.Arrays;
+import java.util.HashSet;
+
+import org.junit.Rule;
+import org.junit.Test;
+import org.junit.rules.TemporaryFolder;
+
+/**
+ * This test is responsible for ensuring that the units, players and events written by the
+ * {@link ReplayDataWriter} are read back unchanged by the {@link ReplayDataReader}, across several
+ * chunks and column by column, without the game.
+ */
+public class ReplayDataTest {
+
+    private static final int FRAMES = 600;
+    private static final int CHUNK_FRAMES = 240;
+    // added out of order, the rows of a chunk are grouped by unit
+    private static final int[] UNIT_IDS = { 5, 3, 9 };
+    private static final int PLAYER_ID = 1;
+
+    @Rule
+    public final TemporaryFolder folder = new TemporaryFolder();
+
+    @Test
+    public void roundTrip() throws Exception {
+        final File file = folder.newFile("replay.jbwr");
+        try (ReplayDataWriter writer = new ReplayDataWriter(file)) {
+            for (int frame = 0; frame < FRAMES; frame++) {
+                writer.beginFrame(frame);
+                final int[] unitData = new int[UNIT_IDS.length * Unit.NUM_ATTRIBUTES];
+                for (int u = 0; u < UNIT_IDS.length; u++) {
+                    final int index = u * Unit.NUM_ATTRIBUTES;
+                    unitData[index + column("id")] = UNIT_IDS[u];
+                    unitData[index + column("x")] = getX(UNIT_IDS[u], frame);
+                    unitData[index + column("velocityX")] = getVelocity(frame);
+                    unitData[index + column("hitPoints")] = getHitPoints(UNIT_IDS[u], frame);
+                }
+                writer.addUnits(frame, unitData);
+
+                final int[] playerData = new int[ReplayDataWriter.PLAYER_SCORES];
+                playerData[0] = getMinerals(frame);
+                writer.addPlayer(frame, PLAYER_ID, playerData);
+
+                if ((frame % 100) == 0) {
+                    writer.addEvent(frame, 12, UNIT_IDS[(frame / 100) % UNIT_IDS.length], -1);
+                }
+            }
+        }
+
+        try (ReplayDataReader reader = new ReplayDataReader(file)) {
+            assertThat(new HashSet<>(reader.getTables()), is(equalTo(new HashSet<>(Arrays.asList(
+                    ReplayDataWriter.UNITS, ReplayDataWriter.PLAYERS, ReplayDataWriter.EVENTS)))));
+            assertThat(reader.getColumns(ReplayDataWriter.UNITS).size(),
+                    is(Unit.NUM_ATTRIBUTES + 1));
+            assertThat(reader.getColumns(ReplayDataWriter.PLAYERS),
+                    is(Arrays.asList(ReplayDataWriter.PLAYER_COLUMNS)));
+
+            final int chunkCount = ((FRAMES + CHUNK_FRAMES) - 1) / CHUNK_FRAMES;
+            assertThat(reader.getChunkCount(), is(chunkCount));
+            for (int chunk = 0; chunk < chunkCount; chunk++) {
+                final int firstFrame = chunk * CHUNK_FRAMES;
+                final int lastFrame = Math.min(FRAMES, firstFrame + CHUNK_FRAMES) - 1;
+                assertThat(reader.getFirstFrame(chunk), is(firstFrame));
+                assertThat(reader.getLastFrame(chunk), is(lastFrame));
+                assertThat(reader.getChunk(firstFrame), is(chunk));
+                assertThat(reader.getChunk(lastFrame), is(chunk));
+                checkUnits(reader, chunk, firstFrame, lastFrame);
+            }
+            assertThat(reader.getChunk(-1), is(-1));
+            assertThat(reader.getChunk(FRAMES), is(-1));
+
+            // the players and events over all chunks
+            final int[] frames = reader.readColumn(ReplayDataWriter.PLAYERS, "frame");
+            final int[] minerals = reader.readColumn(ReplayDataWriter.PLAYERS, "minerals");
+            assertThat(frames.length, is(FRAMES));
+            for (int frame = 0; frame < FRAMES; frame++) {
+                assertThat(frames[frame], is(frame));
+                assertThat(minerals[frame], is(getMinerals(frame)));
+            }
+            final int[] eventFrames = reader.readColumn(ReplayDataWriter.EVENTS, "frame");
+            final int[] eventUnits = reader.readColumn(ReplayDataWriter.EVENTS, "p1");
+            final int[] eventTargets = reader.readColumn(ReplayDataWriter.EVENTS, "p2");
+            assertThat(eventFrames.length, is(FRAMES / 100));
+            for (int i = 0; i < eventFrames.length; i++) {
+                assertThat(eventFrames[i], is(i * 100));
+                assertThat(eventUnits[i], is(UNIT_IDS[i % UNIT_IDS.length]));
+                assertThat(eventTargets[i], is(-1));
+            }
+        }
+    }
+
+    // Reads single columns of a chunk, whose rows are ordered by unit and then by frame.
+    private static void checkUnits(final ReplayDataReader reader, final int chunk,
+            final int firstFrame, final int lastFrame) throws Exception {
+        final int frameCount = (lastFrame - firstFrame) + 1;
+        assertThat(reader.getRowCount(ReplayDataWriter.UNITS, chunk),
+                is(frameCount * UNIT_IDS.length));
+        final int[] ids = reader.readColumn(ReplayDataWriter.UNITS, "id", chunk);
+        final int[] frames = reader.readColumn(ReplayDataWriter.UNITS, "frame", chunk);
+        final int[] xs = reader.readColumn(ReplayDataWriter.UNITS, "x", chunk);
+        final int[] velocities = reader.readColumn(ReplayDataWriter.UNITS, "velocityX", chunk);
+        final int[] hitPoints = reader.readColumn(ReplayDataWriter.UNITS, "hitPoints", chunk);
+        final int[] sortedIds = UNIT_IDS.clone();
+        Arrays.sort(sortedIds);
+        int row = 0;
+        for (final int id : sortedIds) {
+            for (int frame = firstFrame; frame <= lastFrame; frame++, row++) {
+                assertThat(ids[row], is(id));
+                assertThat(frames[row], is(frame));
+                assertThat(xs[row], is(getX(id, frame)));
+                assertThat(velocities[row], is(getVelocity(frame)));
+                assertThat(hitPoints[row], is(getHitPoints(id, frame)));
+            }
+        }
+    }
+
+    private static int column(final String name) {
+        return Arrays.asList(Unit.ATTRIBUTE_NAMES).indexOf(name);
+    }
+
+    // moves left past the edge of the map, so the values and their deltas become negative
+    private static int getX(final int unitId, final int frame) {
+        return (unitId * 40) - frame;
+    }
+
+    private static int getVelocity(final int frame) {
+        return (frame % 7) - 3;
+    }
+
+    private static int getHitPoints(final int unitId, final int frame) {
+        return (unitId * 1000) + ((frame * 37) % 101);
+    }
+
+    private static int getMinerals(final int frame) {
+        return 50 + (frame * 8) - ((frame / 60) * 400);
+    }
+}
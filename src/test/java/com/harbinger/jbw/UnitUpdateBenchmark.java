@@ -0,0 +1,149 @@
+package com.harbinger.jbw;
+
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.util.Random;
+
+/**
+ * Compares eagerly updated {@link Unit units} with flyweight {@link UnitView unit views}. This
+ * benchmark is not automated and does not need Broodwar or the native libraries; it replays
+ * synthetic frames of unit data and prints the average time per frame as a markdown table, which
+ * it also writes to the file given as its argument. Run it with <i>gradle benchmarkUnits</i>, which
+ * writes <i>build/reports/benchmarkUnits.md</i>.
+ *
+ * <p>
+ * Each implementation is measured when the agent reads nothing, a few attributes of every unit, and
+ * a broad selection of attributes of every unit.
+ */
+public class UnitUpdateBenchmark {
+
+    private static final int NUM_ATTRIBUTES = Unit.NUM_ATTRIBUTES;
+    private static final int UNIT_COUNT = 600;
+    private static final int FRAME_COUNT = 20000;
+    private static final int WARMUP_FRAMES = 5000;
+
+    public static void main(final String[] args) throws IOException {
+        // the units are only read, so nothing they refer to has to be looked up
+        final GameContext context = new GameContext() {
+
+            @Override
+            public Unit getUnit(final int unitId) {
+                return null;
+            }
+
+            @Override
+            public Player getPlayer(final int playerId) {
+                return null;
+            }
+        };
+        final int[][] frames = createFrames(16);
+
+        final Unit[] eager = new Unit[UNIT_COUNT];
+        final Unit[] views = new Unit[UNIT_COUNT];
+        for (int i = 0; i < UNIT_COUNT; i++) {
+            eager[i] = new Unit(i, context);
+            views[i] = new UnitView(i, context);
+        }
+
+        final StringBuilder table = new StringBuilder();
+        table.append(String.format("%d units, %s %s, %s %s%n%n", UNIT_COUNT,
+                System.getProperty("java.vm.name"), System.getProperty("java.version"),
+                System.getProperty("os.name"), System.getProperty("os.arch")));
+        final String newline = System.lineSeparator();
+        table.append("| Attributes read | Unit (us/frame) | UnitView (us/frame) |" + newline);
+        table.append("|-----------------|-----------------|---------------------|" + newline);
+        for (final Access access : Access.values()) {
+            run("eager", eager, frames, access, WARMUP_FRAMES);
+            run("view", views, frames, access, WARMUP_FRAMES);
+            final double eagerTime = run("eager", eager, frames, access, FRAME_COUNT);
+            final double viewTime = run("view", views, frames, access, FRAME_COUNT);
+            table.append(String.format("| %-15s | %15.1f | %19.1f |%n", access, eagerTime,
+                    viewTime));
+        }
+        System.out.print(table);
+
+        if (args.length > 0) {
+            final Path report = Paths.get(args[0]);
+            if (report.getParent() != null) {
+                Files.createDirectories(report.getParent());
+            }
+            Files.write(report, table.toString().getBytes(StandardCharsets.UTF_8));
+            System.out.println();
+            System.out.println("Written to " + report);
+        }
+    }
+
+    private enum Access {
+        NONE,
+        FEW,
+        MANY
+    }
+
+    private static int[][] createFrames(final int count) {
+        final Random random = new Random(42);
+        final int[][] frames = new int[count][UNIT_COUNT * NUM_ATTRIBUTES];
+        for (final int[] frame : frames) {
+            for (int i = 0; i < frame.length; i++) {
+                frame[i] = random.nextInt(2);
+            }
+            for (int unit = 0; unit < UNIT_COUNT; unit++) {
+                frame[unit * NUM_ATTRIBUTES] = unit;
+                frame[(unit * NUM_ATTRIBUTES) + 3] = 0; // Terran Marine
+            }
+        }
+        return frames;
+    }
+
+    private static double run(final String name, final Unit[] units, final int[][] frames,
+            final Access access, final int frameCount) {
+        long checksum = 0;
+        final long start = System.nanoTime();
+        for (int frame = 0; frame < frameCount; frame++) {
+            final int[] data = frames[frame % frames.length];
+            for (int i = 0; i < units.length; i++) {
+                units[i].update(data, i * NUM_ATTRIBUTES);
+            }
+            switch (access) {
+                case FEW :
+                    for (final Unit unit : units) {
+                        checksum += unit.getHitPoints() + unit.getX() + (unit.isIdle() ? 1 : 0);
+                    }
+                    break;
+                case MANY :
+                    for (final Unit unit : units) {
+                        checksum += readMany(unit);
+                    }
+                    break;
+                default :
+                    break;
+            }
+        }
+        final long elapsed = System.nanoTime() - start;
+        if (checksum == 42) {
+            System.out.println(name); // keeps the reads from being optimized away
+        }
+        return elapsed / 1000.0 / frameCount;
+    }
+
+    private static long readMany(final Unit unit) {
+        long sum = unit.getReplayId() + unit.getX() + unit.getY() + unit.getHitPoints()
+                + unit.getShields() + unit.getEnergy() + unit.getResources()
+                + unit.getResourceGroup() + unit.getLastCommandFrame() + unit.getKillCount()
+                + unit.getGroundWeaponCooldown() + unit.getAirWeaponCooldown()
+                + unit.getSpellCooldown() + unit.getOrderTimer() + unit.getRemoveTimer()
+                + unit.getTrainingQueueSize() + unit.getRemainingBuildTimer()
+                + unit.getRemainingTrainTime() + unit.getLoadedUnitsCount()
+                + unit.getLarvaCount();
+        sum += (long) (unit.getAngle() + unit.getVelocityX() + unit.getVelocityY());
+        sum += (unit.isExists() ? 1 : 0) + (unit.isAttacking() ? 1 : 0)
+                + (unit.isBurrowed() ? 1 : 0) + (unit.isCloaked() ? 1 : 0)
+                + (unit.isCompleted() ? 1 : 0) + (unit.isIdle() ? 1 : 0)
+                + (unit.isMoving() ? 1 : 0) + (unit.isSieged() ? 1 : 0)
+                + (unit.isTraining() ? 1 : 0) + (unit.isUnderAttack() ? 1 : 0)
+                + (unit.isVisible() ? 1 : 0);
+        return sum;
+    }
+}
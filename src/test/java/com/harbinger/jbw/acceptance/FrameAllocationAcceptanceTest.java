@@ -0,0 +1,56 @@
+package com.harbinger.jbw.acceptance;
+
+import static org.hamcrest.CoreMatchers.equalTo;
+import static org.hamcrest.CoreMatchers.is;
+import static org.junit.Assert.assertThat;
+
+import com.harbinger.jbw.Unit;
+import com.harbinger.jbw.util.BroodwarAgentTest;
+
+import org.junit.Test;
+
+/**
+ * This test is responsible for ensuring that the native frame path does not allocate once the
+ * bridge has warmed up.
+ */
+public class FrameAllocationAcceptanceTest extends BroodwarAgentTest {
+
+    private static final boolean TERMINATE_AFTER_TEST = true;
+
+    // frames the bridge may allocate in while its buffers grow to their steady size
+    private static final int WARM_UP_FRAMES = 240;
+
+    // frames checked after the warm up
+    private static final int CHECKED_FRAMES = 480;
+
+    private boolean unitDiscovered;
+    private boolean unitDiscoveredLastFrame;
+
+    @Test
+    public void steadyStateFramesDoNotAllocate() {
+        new FrameAllocationAcceptanceTest().launchAndWait();
+    }
+
+    @Override
+    public void unitDiscover(final Unit unit) {
+        unitDiscovered = true;
+    }
+
+    @Override
+    public void matchFrame() {
+        // the count is that of the previous frame, which may allocate for the units it discovered
+        final boolean newUnits = unitDiscoveredLastFrame;
+        unitDiscoveredLastFrame = unitDiscovered;
+        unitDiscovered = false;
+
+        final int frame = broodwar.getFrame();
+        if ((frame > WARM_UP_FRAMES) && !newUnits) {
+            assertThat("allocations in frame " + (frame - 1), broodwar.getFrameAllocationCount(),
+                    is(equalTo(0)));
+        }
+
+        if (TERMINATE_AFTER_TEST && (frame > (WARM_UP_FRAMES + CHECKED_FRAMES))) {
+            terminateBroodwar();
+        }
+    }
+}
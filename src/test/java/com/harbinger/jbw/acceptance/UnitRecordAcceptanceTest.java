@@ -0,0 +1,138 @@
+package com.harbinger.jbw.acceptance;
+
+import static com.harbinger.jbw.Position.Resolution.BUILD;
+import static org.hamcrest.CoreMatchers.is;
+import static org.junit.Assert.assertThat;
+
+import com.harbinger.jbw.Position;
+import com.harbinger.jbw.Type.Race;
+import com.harbinger.jbw.Type.UnitType;
+import com.harbinger.jbw.Unit;
+import com.harbinger.jbw.util.BroodwarAgentTest;
+
+import java.util.List;
+
+import org.junit.Test;
+
+/**
+ * This test is responsible for ensuring that the unit records the bridge reads from the raw unit
+ * data match BWAPI's accessors while units are trained, morphed and built.
+ *
+ * <p>
+ * The agent trains workers, two at a time so the training queue holds more than one unit, and
+ * builds a supply provider. As Zerg it morphs larva into drones and a drone into a Spawning Pool
+ * instead.
+ */
+public class UnitRecordAcceptanceTest extends BroodwarAgentTest {
+
+    private static final boolean TERMINATE_AFTER_TEST = true;
+
+    // about four minutes of game time, enough for several trainings and a finished building
+    private static final int CHECKED_FRAMES = 24 * 60 * 4;
+
+    // tiles searched around the resource depot for a building site
+    private static final int SITE_RADIUS = 10;
+
+    private UnitType depotType;
+    private UnitType workerType;
+    private UnitType buildingType;
+
+    @Test
+    public void unitRecordsMatchAccessors() {
+        new UnitRecordAcceptanceTest().launchAndWait();
+    }
+
+    @Override
+    public void matchStart() {
+        broodwar.setFrameDelay(0);
+
+        final Race race = broodwar.getAgent().getRace();
+        if (race == Race.ZERG) {
+            depotType = UnitType.Zerg_Hatchery;
+            workerType = UnitType.Zerg_Drone;
+            buildingType = UnitType.Zerg_Spawning_Pool;
+        } else if (race == Race.TERRAN) {
+            depotType = UnitType.Terran_Command_Center;
+            workerType = UnitType.Terran_SCV;
+            buildingType = UnitType.Terran_Supply_Depot;
+        } else {
+            depotType = UnitType.Protoss_Nexus;
+            workerType = UnitType.Protoss_Probe;
+            buildingType = UnitType.Protoss_Pylon;
+        }
+    }
+
+    @Override
+    public void matchFrame() {
+        final List<String> differences = broodwar.checkUnitRecords();
+        assertThat("frame " + broodwar.getFrame() + ": " + differences, differences.isEmpty(),
+                is(true));
+
+        trainWorkers();
+        buildOnce();
+        gatherWithIdleWorkers();
+
+        if (TERMINATE_AFTER_TEST && (broodwar.getFrame() > CHECKED_FRAMES)) {
+            terminateBroodwar();
+        }
+    }
+
+    private void trainWorkers() {
+        for (final Unit unit : broodwar.getUnits()) {
+            if (unit.getType() == UnitType.Zerg_Larva) {
+                if (broodwar.canMake(unit, workerType)) {
+                    unit.morph(workerType);
+                }
+            } else if ((unit.getType() == depotType) && (unit.getTrainingQueueSize() < 2)
+                    && broodwar.canMake(unit, workerType)) {
+                unit.train(workerType);
+            }
+        }
+    }
+
+    private void buildOnce() {
+        if ((getUnit(buildingType) != null) || !broodwar.canMake(buildingType)) {
+            return;
+        }
+        final Unit depot = getUnit(depotType);
+        final Unit worker = getUnit(workerType);
+        if ((depot == null) || (worker == null)) {
+            return;
+        }
+        final int x = depot.getTilePosition().getX(BUILD);
+        final int y = depot.getTilePosition().getY(BUILD);
+        for (int radius = 2; radius <= SITE_RADIUS; radius++) {
+            for (int dx = -radius; dx <= radius; dx++) {
+                for (int dy = -radius; dy <= radius; dy++) {
+                    final Position site = new Position(x + dx, y + dy, BUILD);
+                    if (broodwar.canBuildHere(worker, site, buildingType, true)) {
+                        worker.build(buildingType, site);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    private void gatherWithIdleWorkers() {
+        for (final Unit unit : broodwar.getUnits()) {
+            if (unit.isIdle() && (unit.getType() == workerType)) {
+                for (final Unit minerals : broodwar.getNeutralUnits()) {
+                    if (minerals.getType().isMineralField() && (unit.getDistance(minerals) < 300)) {
+                        unit.gather(minerals);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    private Unit getUnit(final UnitType unitType) {
+        for (final Unit unit : broodwar.getUnits()) {
+            if (unit.getType() == unitType) {
+                return unit;
+            }
+        }
+        return null;
+    }
+}